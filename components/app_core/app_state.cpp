@@ -1,12 +1,22 @@
 #include "app_state.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 
 // FreeRTOS
 #include "freertos/task.h"
 
+#include "seqlock.h"
+
+static constexpr char kTag[] = "STATE";
+
 AppConfig app_config{
     DEFAULT_WIFI_SSID,  // wifi_ssid
     DEFAULT_WIFI_PASS,  // wifi_password
@@ -19,6 +29,10 @@ AppConfig app_config{
     1.0f,               // logging_duration_s
     100,                // logging_motor_steps
     true,               // logging_home_each_cycle
+    200,                // logging_settle_min_ms
+    1000,               // logging_settle_max_ms (the former fixed settle delay)
+    20.0f,              // logging_settle_slope_uv_s
+    20.0f,              // logging_settle_std_uv
     1500,               // stepper_speed_us
     0,                  // stepper_home_offset_steps
     0,                  // motor_hall_active_level
@@ -44,6 +58,10 @@ AppConfig app_config{
     9,                  // meteo_poll_interval_s (station updates ~8.8s; keep state.meteo fresh)
     true,               // meteo_enabled
     60,                 // meteo_file_interval_s (CSV write cadence, independent from poll)
+    DefaultAdcOsr(),    // adc_osr
+    100,                // adc_state_period_ms
+    {},                 // brightness_cals (none until pushed or set in config.txt)
+    {},                 // brightness_sensor
 };
 
 PidConfig pid_config{
@@ -81,6 +99,376 @@ FILE* log_file = nullptr;
 std::string current_log_path;
 static uint32_t boot_id = 0;
 
+// ---------- per-domain views ----------
+
+namespace {
+
+// Reader retries before falling back to state_mutex. A writer preempted mid-publish by a
+// higher-priority reader on the same core would otherwise make that reader spin forever;
+// blocking on the mutex lets priority inheritance finish the publish.
+constexpr int kViewReadAttempts = 4;
+
+SeqLock<AdcState> s_adc_view;
+SeqLock<ThermalState> s_thermal_view;
+SeqLock<MotionState> s_motion_view;
+SeqLock<NetState> s_net_view;
+SeqLock<StorageState> s_storage_view;
+SeqLock<MeteoData> s_meteo_view;
+
+// Publish scratch; writers are serialized by state_mutex, and keeping these off the
+// caller's stack matters for the 2-4 KB sensor tasks.
+AdcState s_adc_scratch;
+ThermalState s_thermal_scratch;
+MotionState s_motion_scratch;
+NetState s_net_scratch;
+StorageState s_storage_scratch;
+MeteoData s_meteo_scratch;
+
+// Each extractor clears the whole struct first so padding compares equal with memcmp
+// when nothing changed (InlineString zeroes its own tail).
+void ExtractAdc(const SharedState& s, AdcState* out) {
+  std::memset(static_cast<void*>(out), 0, sizeof(*out));
+  out->voltage = s.voltage;
+  out->voltage_cal = s.voltage_cal;
+  out->offset = s.offset;
+  out->ina_bus_voltage = s.ina_bus_voltage;
+  out->ina_current = s.ina_current;
+  out->ina_power = s.ina_power;
+  out->calibrating = s.calibrating;
+  out->last_update_ms = s.last_update_ms;
+}
+
+void ExtractThermal(const SharedState& s, ThermalState* out) {
+  std::memset(static_cast<void*>(out), 0, sizeof(*out));
+  out->temp_sensor_count = s.temp_sensor_count;
+  out->temps_c = s.temps_c;
+  out->temp_flags = s.temp_flags;
+  out->temp_cycle = s.temp_cycle;
+  for (int i = 0; i < MAX_TEMP_SENSORS; ++i) {
+    out->temp_labels[i] = s.temp_labels[i];
+    out->temp_addresses[i] = s.temp_addresses[i];
+  }
+  out->heater_power = s.heater_power;
+  out->fan_power = s.fan_power;
+  out->fan1_rpm = s.fan1_rpm;
+  out->fan2_rpm = s.fan2_rpm;
+  out->external_power_on = s.external_power_on;
+  out->pid_enabled = s.pid_enabled;
+  out->pid_kp = s.pid_kp;
+  out->pid_ki = s.pid_ki;
+  out->pid_kd = s.pid_kd;
+  out->pid_setpoint = s.pid_setpoint;
+  out->pid_sensor_index = s.pid_sensor_index;
+  out->pid_sensor_mask = s.pid_sensor_mask;
+  out->pid_output = s.pid_output;
+  out->pid_temperature = s.pid_temperature;
+  out->pid_error = s.pid_error;
+  out->pid_integral = s.pid_integral;
+  out->pid_integral_candidate = s.pid_integral_candidate;
+  out->pid_derivative = s.pid_derivative;
+  out->pid_p_term = s.pid_p_term;
+  out->pid_i_term = s.pid_i_term;
+  out->pid_d_term = s.pid_d_term;
+  out->pid_raw_output = s.pid_raw_output;
+  out->pid_dt = s.pid_dt;
+  out->pid_saturated_high = s.pid_saturated_high;
+  out->pid_saturated_low = s.pid_saturated_low;
+  out->pid_integral_held = s.pid_integral_held;
+}
+
+void ExtractMotion(const SharedState& s, MotionState* out) {
+  std::memset(static_cast<void*>(out), 0, sizeof(*out));
+  out->homing = s.homing;
+  out->stepper_enabled = s.stepper_enabled;
+  out->stepper_moving = s.stepper_moving;
+  out->stepper_direction_forward = s.stepper_direction_forward;
+  out->stepper_homed = s.stepper_homed;
+  out->stepper_abort = s.stepper_abort;
+  out->stepper_speed_us = s.stepper_speed_us;
+  out->stepper_home_offset_steps = s.stepper_home_offset_steps;
+  out->stepper_target = s.stepper_target;
+  out->motor_hall_active_level = s.motor_hall_active_level;
+  out->stepper_home_status = s.stepper_home_status;
+  out->stepper_position = s.stepper_position;
+  out->last_step_timestamp_us = s.last_step_timestamp_us;
+  out->motor_hall_raw_level = s.motor_hall_raw_level;
+  out->motor_hall_triggered = s.motor_hall_triggered;
+  out->motor_hall_edge_count = s.motor_hall_edge_count;
+  out->motor_hall_active_edge_count = s.motor_hall_active_edge_count;
+  out->motor_hall_level0_edge_count = s.motor_hall_level0_edge_count;
+  out->motor_hall_level1_edge_count = s.motor_hall_level1_edge_count;
+  out->motor_hall_last_edge_level = s.motor_hall_last_edge_level;
+  out->motor_hall_last_edge_seen_us = s.motor_hall_last_edge_seen_us;
+  out->motor_hall_width_steps = s.motor_hall_width_steps;
+  out->motor_hall_speed_sps = s.motor_hall_speed_sps;
+}
+
+void ExtractNet(const SharedState& s, NetState* out) {
+  std::memset(static_cast<void*>(out), 0, sizeof(*out));
+  out->wifi_rssi_dbm = s.wifi_rssi_dbm;
+  out->wifi_quality = s.wifi_quality;
+  out->wifi_ip = s.wifi_ip;
+  out->wifi_ip_sta = s.wifi_ip_sta;
+  out->wifi_ip_ap = s.wifi_ip_ap;
+  out->eth_ip = s.eth_ip;
+  out->eth_link_up = s.eth_link_up;
+  out->eth_ip_up = s.eth_ip_up;
+}
+
+void ExtractStorage(const SharedState& s, StorageState* out) {
+  std::memset(static_cast<void*>(out), 0, sizeof(*out));
+  out->logging = s.logging;
+  out->log_use_motor = s.log_use_motor;
+  out->log_duration_s = s.log_duration_s;
+  out->log_filename = s.log_filename;
+  out->usb_error = s.usb_error;
+  out->sd_total_bytes = s.sd_total_bytes;
+  out->sd_used_bytes = s.sd_used_bytes;
+  out->sd_data_root_files = s.sd_data_root_files;
+  out->sd_to_upload_files = s.sd_to_upload_files;
+  out->sd_uploaded_files = s.sd_uploaded_files;
+  out->heap_free_bytes = s.heap_free_bytes;
+  out->heap_min_free_bytes = s.heap_min_free_bytes;
+  out->heap_largest_free_block_bytes = s.heap_largest_free_block_bytes;
+  out->heap_internal_free_bytes = s.heap_internal_free_bytes;
+  out->heap_internal_largest_free_block_bytes = s.heap_internal_largest_free_block_bytes;
+  out->heap_psram_free_bytes = s.heap_psram_free_bytes;
+  out->heap_psram_largest_free_block_bytes = s.heap_psram_largest_free_block_bytes;
+  out->minio_upload_attempts = s.minio_upload_attempts;
+  out->minio_upload_successes = s.minio_upload_successes;
+  out->minio_upload_failures = s.minio_upload_failures;
+  out->minio_archive_failures = s.minio_archive_failures;
+  out->minio_last_attempt_ms = s.minio_last_attempt_ms;
+  out->minio_last_success_ms = s.minio_last_success_ms;
+  out->minio_last_failure_ms = s.minio_last_failure_ms;
+}
+
+void ExtractMeteo(const SharedState& s, MeteoData* out) {
+  std::memset(static_cast<void*>(out), 0, sizeof(*out));
+  out->light_lux = s.meteo.light_lux;
+  out->uvi = s.meteo.uvi;
+  out->temp_c = s.meteo.temp_c;
+  out->humidity_pct = s.meteo.humidity_pct;
+  out->wind_speed_ms = s.meteo.wind_speed_ms;
+  out->gust_speed_ms = s.meteo.gust_speed_ms;
+  out->wind_dir_deg = s.meteo.wind_dir_deg;
+  out->rainfall_mm = s.meteo.rainfall_mm;
+  out->pressure_hpa = s.meteo.pressure_hpa;
+  out->online = s.meteo.online;
+  out->timestamp_ms = s.meteo.timestamp_ms;
+}
+
+template <typename T>
+bool StoreIfChanged(SeqLock<T>* view, const T& value) {
+  if (std::memcmp(&view->UnsafePeek(), &value, sizeof(T)) == 0) return false;
+  view->Store(value);
+  return true;
+}
+
+bool RangeDiffers(const void* a, const void* b, size_t begin, size_t end) {
+  return std::memcmp(static_cast<const uint8_t*>(a) + begin, static_cast<const uint8_t*>(b) + begin, end - begin) != 0;
+}
+
+// Publishes a view whose bytes [0, split) and [split, sizeof(T)) belong to different
+// change groups; returns the bits of the groups that changed.
+template <typename T>
+uint32_t StoreSplitIfChanged(SeqLock<T>* view, const T& value, size_t split, StateGroup head, StateGroup tail) {
+  const T& prev = view->UnsafePeek();
+  uint32_t changed = 0;
+  if (RangeDiffers(&prev, &value, 0, split)) changed |= StateGroupBit(head);
+  if (RangeDiffers(&prev, &value, split, sizeof(T))) changed |= StateGroupBit(tail);
+  if (changed) view->Store(value);
+  return changed;
+}
+
+// Must run with state_mutex held (or before it exists, during single-threaded boot).
+// Republishes the views holding any of the `dirty` groups; returns the StateGroupBit mask of
+// groups whose contents changed.
+uint32_t PublishStateViewsLocked(uint32_t dirty) {
+  constexpr uint32_t kThermalGroups =
+      StateGroupBit(StateGroup::kTemps) | StateGroupBit(StateGroup::kThermalControl);
+  constexpr uint32_t kMotionGroups =
+      StateGroupBit(StateGroup::kMotion) | StateGroupBit(StateGroup::kMotionProgress);
+  constexpr uint32_t kStorageGroups =
+      StateGroupBit(StateGroup::kLogging) | StateGroupBit(StateGroup::kStorageStats);
+  uint32_t changed = 0;
+  if (dirty & StateGroupBit(StateGroup::kAdc)) {
+    ExtractAdc(state, &s_adc_scratch);
+    if (StoreIfChanged(&s_adc_view, s_adc_scratch)) changed |= StateGroupBit(StateGroup::kAdc);
+  }
+  if (dirty & kThermalGroups) {
+    ExtractThermal(state, &s_thermal_scratch);
+    changed |= StoreSplitIfChanged(&s_thermal_view, s_thermal_scratch, offsetof(ThermalState, heater_power),
+                                   StateGroup::kTemps, StateGroup::kThermalControl);
+  }
+  if (dirty & kMotionGroups) {
+    ExtractMotion(state, &s_motion_scratch);
+    changed |= StoreSplitIfChanged(&s_motion_view, s_motion_scratch, offsetof(MotionState, stepper_position),
+                                   StateGroup::kMotion, StateGroup::kMotionProgress);
+  }
+  if (dirty & StateGroupBit(StateGroup::kNet)) {
+    ExtractNet(state, &s_net_scratch);
+    if (StoreIfChanged(&s_net_view, s_net_scratch)) changed |= StateGroupBit(StateGroup::kNet);
+  }
+  if (dirty & kStorageGroups) {
+    ExtractStorage(state, &s_storage_scratch);
+    changed |= StoreSplitIfChanged(&s_storage_view, s_storage_scratch, offsetof(StorageState, sd_total_bytes),
+                                   StateGroup::kLogging, StateGroup::kStorageStats);
+  }
+  if (dirty & StateGroupBit(StateGroup::kMeteo)) {
+    ExtractMeteo(state, &s_meteo_scratch);
+    if (StoreIfChanged(&s_meteo_view, s_meteo_scratch)) changed |= StateGroupBit(StateGroup::kMeteo);
+  }
+  return changed;
+}
+
+// ---------- change subscribers ----------
+
+struct StateSubscriber {
+  TaskHandle_t task;
+  uint32_t mask;
+};
+
+portMUX_TYPE s_subscribers_lock = portMUX_INITIALIZER_UNLOCKED;
+StateSubscriber s_subscribers[STATE_MAX_SUBSCRIBERS] = {};
+
+void NotifySubscribers(uint32_t changed) {
+  if (changed == 0) return;
+  StateSubscriber targets[STATE_MAX_SUBSCRIBERS];
+  portENTER_CRITICAL(&s_subscribers_lock);
+  std::memcpy(targets, s_subscribers, sizeof(targets));
+  portEXIT_CRITICAL(&s_subscribers_lock);
+  for (const StateSubscriber& sub : targets) {
+    const uint32_t bits = changed & sub.mask;
+    if (sub.task && bits) xTaskNotify(sub.task, bits, eSetBits);
+  }
+}
+
+template <typename T>
+T ReadView(const SeqLock<T>& view, uint32_t* version) {
+  T out;
+  for (int attempt = 0; attempt < kViewReadAttempts; ++attempt) {
+    if (view.TryLoad(&out, version)) return out;
+  }
+  if (state_mutex && xSemaphoreTake(state_mutex, portMAX_DELAY) == pdTRUE) {
+    out = view.UnsafePeek();
+    if (version) *version = view.version();
+    xSemaphoreGive(state_mutex);
+    return out;
+  }
+  out = view.UnsafePeek();
+  if (version) *version = view.version();
+  return out;
+}
+
+// ---------- update contention telemetry ----------
+
+portMUX_TYPE s_contention_lock = portMUX_INITIALIZER_UNLOCKED;
+StateCallerStats s_caller_stats[STATE_CONTENTION_MAX_CALLERS];
+size_t s_caller_count = 0;
+StateContentionTotals s_contention_totals{};
+int64_t s_last_drop_log_us = 0;
+uint32_t s_drops_since_log = 0;
+
+// Call-site strings come from __builtin_FILE(); keep just the file name.
+const char* CallerBaseName(const char* file) {
+  if (!file) return "?";
+  const char* slash = std::strrchr(file, '/');
+  return slash ? slash + 1 : file;
+}
+
+// Must run inside s_contention_lock. One translation unit normally passes one pointer for
+// its file name, so the pointer compare settles almost every lookup.
+StateCallerStats* FindCallerStatsLocked(const char* caller, uint32_t line) {
+  for (size_t i = 0; i < s_caller_count; ++i) {
+    const StateCallerStats& entry = s_caller_stats[i];
+    if (entry.line == line && (entry.caller == caller || std::strcmp(entry.caller, caller) == 0)) {
+      return &s_caller_stats[i];
+    }
+  }
+  if (s_caller_count >= STATE_CONTENTION_MAX_CALLERS) return nullptr;
+  StateCallerStats* entry = &s_caller_stats[s_caller_count++];
+  *entry = {};
+  entry->caller = caller;
+  entry->line = line;
+  return entry;
+}
+
+uint32_t ClampUs(int64_t us) {
+  if (us <= 0) return 0;
+  return us > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(us);
+}
+
+// Returns, for a dropped update that is due a log line (at most one per 5 s), the number of
+// drops that line covers; 0 otherwise.
+uint32_t RecordStateUpdate(const char* caller, uint32_t line, int64_t wait_us, int64_t hold_us, bool dropped) {
+  const uint32_t wait = ClampUs(wait_us);
+  const uint32_t hold = ClampUs(hold_us);
+  const bool late = !dropped && wait > STATE_UPDATE_LATE_MS * 1000u;
+  const int64_t now_us = dropped ? esp_timer_get_time() : 0;
+  uint32_t log_drops = 0;
+  portENTER_CRITICAL(&s_contention_lock);
+  if (dropped) {
+    s_contention_totals.dropped++;
+    s_drops_since_log++;
+    if (now_us - s_last_drop_log_us > 5000000) {
+      s_last_drop_log_us = now_us;
+      log_drops = s_drops_since_log;
+      s_drops_since_log = 0;
+    }
+  } else {
+    s_contention_totals.updates++;
+    if (late) s_contention_totals.late++;
+  }
+  StateCallerStats* entry = FindCallerStatsLocked(caller, line);
+  if (!entry) {
+    s_contention_totals.untracked_callers++;
+  } else if (dropped) {
+    entry->dropped++;
+  } else {
+    entry->updates++;
+    if (late) entry->late++;
+    entry->wait_total_us += wait;
+    entry->hold_total_us += hold;
+    entry->wait_max_us = std::max(entry->wait_max_us, wait);
+    entry->hold_max_us = std::max(entry->hold_max_us, hold);
+  }
+  portEXIT_CRITICAL(&s_contention_lock);
+  return log_drops;
+}
+
+void ApplyStateUpdate(uint32_t groups, StateUpdaterRef updater, const char* caller, uint32_t line,
+                      TickType_t timeout) {
+  if (!state_mutex) {
+    // Single-threaded boot, before the mutex exists.
+    updater(state);
+    NotifySubscribers(PublishStateViewsLocked(groups));
+    return;
+  }
+  caller = CallerBaseName(caller);
+  const int64_t wait_start_us = esp_timer_get_time();
+  if (xSemaphoreTake(state_mutex, timeout) != pdTRUE) {
+    const int64_t waited_us = esp_timer_get_time() - wait_start_us;
+    const uint32_t drops = RecordStateUpdate(caller, line, waited_us, 0, true);
+    if (drops > 0) {
+      ESP_LOGW(kTag, "State update from %s:%u dropped after %lld ms waiting for state_mutex "
+               "(%u dropped since the last report)",
+               caller, static_cast<unsigned>(line), static_cast<long long>(waited_us / 1000),
+               static_cast<unsigned>(drops));
+    }
+    return;
+  }
+  const int64_t hold_start_us = esp_timer_get_time();
+  updater(state);
+  const uint32_t changed = PublishStateViewsLocked(groups);
+  const int64_t hold_end_us = esp_timer_get_time();
+  xSemaphoreGive(state_mutex);
+  NotifySubscribers(changed);
+  RecordStateUpdate(caller, line, hold_start_us - wait_start_us, hold_end_us - hold_start_us, false);
+}
+
+}  // namespace
+
 SharedState CopyState() {
   SharedState snapshot;
   if (state_mutex) {
@@ -93,22 +481,78 @@ SharedState CopyState() {
   return snapshot;
 }
 
-void UpdateState(const std::function<void(SharedState&)>& updater) {
-  if (state_mutex && xSemaphoreTake(state_mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-    updater(state);
-    xSemaphoreGive(state_mutex);
+void UpdateState(StateUpdaterRef updater, const char* caller, uint32_t line) {
+  ApplyStateUpdate(STATE_GROUP_ALL, updater, caller, line, pdMS_TO_TICKS(STATE_UPDATE_MAX_WAIT_MS));
+}
+
+void UpdateState(uint32_t groups, StateUpdaterRef updater, const char* caller, uint32_t line) {
+  ApplyStateUpdate(groups, updater, caller, line, pdMS_TO_TICKS(STATE_UPDATE_MAX_WAIT_MS));
+}
+
+void UpdateStateBlocking(StateUpdaterRef updater, const char* caller, uint32_t line) {
+  ApplyStateUpdate(STATE_GROUP_ALL, updater, caller, line, portMAX_DELAY);
+}
+
+size_t GetStateContentionStats(StateCallerStats* out, size_t max, StateContentionTotals* totals) {
+  size_t written = 0;
+  portENTER_CRITICAL(&s_contention_lock);
+  const size_t count = std::min(s_caller_count, max);
+  for (; out && written < count; ++written) {
+    out[written] = s_caller_stats[written];
   }
+  if (totals) *totals = s_contention_totals;
+  portEXIT_CRITICAL(&s_contention_lock);
+  return written;
 }
 
-void UpdateStateBlocking(const std::function<void(SharedState&)>& updater) {
-  if (!state_mutex) {
-    updater(state);
-    return;
+void ResetStateContentionStats() {
+  portENTER_CRITICAL(&s_contention_lock);
+  s_caller_count = 0;
+  s_contention_totals = {};
+  s_drops_since_log = 0;
+  portEXIT_CRITICAL(&s_contention_lock);
+}
+
+AdcState ReadAdcState(uint32_t* version) { return ReadView(s_adc_view, version); }
+
+ThermalState ReadThermalState(uint32_t* version) { return ReadView(s_thermal_view, version); }
+
+MotionState ReadMotionState(uint32_t* version) { return ReadView(s_motion_view, version); }
+
+NetState ReadNetState(uint32_t* version) { return ReadView(s_net_view, version); }
+
+StorageState ReadStorageState(uint32_t* version) { return ReadView(s_storage_view, version); }
+
+MeteoData ReadMeteoState(uint32_t* version) { return ReadView(s_meteo_view, version); }
+
+bool StateSubscribe(TaskHandle_t task, uint32_t group_mask) {
+  if (!task) return false;
+  bool ok = false;
+  portENTER_CRITICAL(&s_subscribers_lock);
+  StateSubscriber* free_slot = nullptr;
+  for (StateSubscriber& sub : s_subscribers) {
+    if (sub.task == task) {
+      sub.mask = group_mask;
+      ok = true;
+      break;
+    }
+    if (!sub.task && !free_slot) free_slot = &sub;
   }
-  if (xSemaphoreTake(state_mutex, portMAX_DELAY) == pdTRUE) {
-    updater(state);
-    xSemaphoreGive(state_mutex);
+  if (!ok && free_slot) {
+    *free_slot = {task, group_mask};
+    ok = true;
+  }
+  portEXIT_CRITICAL(&s_subscribers_lock);
+  if (!ok) ESP_LOGE(kTag, "No free state subscriber slot (max %u)", static_cast<unsigned>(STATE_MAX_SUBSCRIBERS));
+  return ok;
+}
+
+void StateUnsubscribe(TaskHandle_t task) {
+  portENTER_CRITICAL(&s_subscribers_lock);
+  for (StateSubscriber& sub : s_subscribers) {
+    if (sub.task == task) sub = {};
   }
+  portEXIT_CRITICAL(&s_subscribers_lock);
 }
 
 void ScheduleRestart() {
@@ -6,7 +6,9 @@
 #include <ctime>
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "esp_http_server.h"
@@ -14,6 +16,10 @@
 #include "freertos/semphr.h"
 #include "sdmmc_cmd.h"
 
+#include "brightness.h"
+#include "hw_pins.h"
+#include "inline_string.h"
+
 // Measured values from one WN90LP weather station poll.
 // Invalid/missing fields are NaN; online==false means no response.
 struct MeteoData {
@@ -43,6 +49,36 @@ inline constexpr size_t WIFI_SSID_MAX_LEN = 32;
 inline constexpr size_t WIFI_PASSWORD_MAX_LEN = 64;
 inline constexpr char TO_UPLOAD_DIR[] = "/sdcard/to_upload";
 inline constexpr char UPLOADED_DIR[] = "/sdcard/uploaded";
+inline constexpr size_t TEMP_ADDRESS_MAX_LEN = 18;         // "0x" + 16 hex digits
+inline constexpr size_t TEMP_LABEL_MAX_LEN = 7;
+inline constexpr size_t IPV4_STR_MAX_LEN = 15;             // "255.255.255.255"
+inline constexpr size_t LOG_FILENAME_MAX_LEN = 255;
+inline constexpr size_t USB_ERROR_MAX_LEN = 63;
+inline constexpr size_t STEPPER_HOME_STATUS_MAX_LEN = 23;
+// LTC2440 oversampling ratio: a power of two from 64 (~3.5 kHz) to 32768 (~6.9 Hz).
+inline constexpr int ADC_OSR_MIN = 64;
+inline constexpr int ADC_OSR_MAX = 32768;
+inline constexpr int ADC_OSR_DEFAULT = ADC_OSR_MAX;
+
+inline constexpr bool IsValidAdcOsr(int osr) {
+  return osr >= ADC_OSR_MIN && osr <= ADC_OSR_MAX && (osr & (osr - 1)) == 0;
+}
+
+// ADC_OSR_DEFAULT for every channel the board has.
+inline constexpr std::array<uint16_t, ADC_CHANNEL_COUNT> DefaultAdcOsr() {
+  std::array<uint16_t, ADC_CHANNEL_COUNT> osr{};
+  for (size_t i = 0; i < osr.size(); ++i) osr[i] = ADC_OSR_DEFAULT;
+  return osr;
+}
+
+using TempLabelString = InlineString<TEMP_LABEL_MAX_LEN>;
+using TempAddressString = InlineString<TEMP_ADDRESS_MAX_LEN>;
+using Ipv4String = InlineString<IPV4_STR_MAX_LEN>;
+using LogFilenameString = InlineString<LOG_FILENAME_MAX_LEN>;
+using UsbErrorString = InlineString<USB_ERROR_MAX_LEN>;
+using StepperHomeStatusString = InlineString<STEPPER_HOME_STATUS_MAX_LEN>;
+using RadiometerCalibration = BrightnessCalibration<ADC_CHANNEL_COUNT>;
+using RadiometerCalibrationTable = BrightnessTable<ADC_CHANNEL_COUNT>;
 
 enum class NetMode : uint8_t { kWifiOnly = 0, kEthOnly = 1, kWifiEth = 2 };
 enum class NetPriority : uint8_t { kWifi = 0, kEth = 1 };
@@ -60,6 +96,13 @@ struct AppConfig {
   float logging_duration_s;
   int logging_motor_steps;
   bool logging_home_each_cycle;
+  // Settle detection after each logging move: averaging starts once every ADC channel drifts
+  // less than slope and scatters less than std over the last few conversions, but not before
+  // min_ms and at the latest at max_ms. A threshold <= 0 turns it into a fixed max_ms wait.
+  int logging_settle_min_ms;
+  int logging_settle_max_ms;
+  float logging_settle_slope_uv_s;
+  float logging_settle_std_uv;
   int stepper_speed_us;
   int stepper_home_offset_steps;
   int motor_hall_active_level;
@@ -86,6 +129,12 @@ struct AppConfig {
   int meteo_poll_interval_s;  // WN90LP station poll interval; default 9 (sensor updates ~8.8s)
   bool meteo_enabled;         // set false in config.txt to skip UART init entirely
   int meteo_file_interval_s;  // CSV write interval; default 60 (independent from poll)
+  std::array<uint16_t, ADC_CHANNEL_COUNT> adc_osr;  // LTC2440 oversampling per channel
+  int adc_state_period_ms;  // shortest block-mean period of the displayed/PID voltages
+  // Radiometer calibrations for on-device brightness temperatures, and the ROM address of the
+  // 1-Wire sensor on each radiometer (the backend's temp_bindings); empty means unbound.
+  RadiometerCalibrationTable brightness_cals;
+  std::array<TempAddressString, ADC_CHANNEL_COUNT> brightness_sensor;
 };
 
 struct PidConfig {
@@ -99,15 +148,9 @@ struct PidConfig {
 };
 
 struct SharedState {
-  float voltage1;
-  float voltage2;
-  float voltage3;
-  float voltage1_cal;
-  float voltage2_cal;
-  float voltage3_cal;
-  float offset1;
-  float offset2;
-  float offset3;
+  std::array<float, ADC_CHANNEL_COUNT> voltage;
+  std::array<float, ADC_CHANNEL_COUNT> voltage_cal;
+  std::array<float, ADC_CHANNEL_COUNT> offset;
   float ina_bus_voltage;
   float ina_current;
   float ina_power;
@@ -116,12 +159,14 @@ struct SharedState {
   uint32_t fan1_rpm;
   uint32_t fan2_rpm;
   int temp_sensor_count;
-  std::array<float, MAX_TEMP_SENSORS> temps_c;
-  std::array<std::string, MAX_TEMP_SENSORS> temp_labels;
-  std::array<std::string, MAX_TEMP_SENSORS> temp_addresses;
+  std::array<float, MAX_TEMP_SENSORS> temps_c;  // outlier-filtered (see sensor_hub.h)
+  std::array<uint8_t, MAX_TEMP_SENSORS> temp_flags;
+  uint32_t temp_cycle;  // bumped with every published temperature cycle
+  std::array<TempLabelString, MAX_TEMP_SENSORS> temp_labels;
+  std::array<TempAddressString, MAX_TEMP_SENSORS> temp_addresses;
   bool homing;
   bool logging;
-  std::string log_filename;
+  LogFilenameString log_filename;
   bool log_use_motor;
   float log_duration_s;
   bool pid_enabled;
@@ -160,21 +205,23 @@ struct SharedState {
   uint32_t motor_hall_level1_edge_count;
   int motor_hall_last_edge_level;
   int64_t motor_hall_last_edge_seen_us;
+  int motor_hall_width_steps;    // steps the magnet keeps the sensor active
+  float motor_hall_speed_sps;    // step rate over the last revolution, from Hall edges
   int stepper_target;
   int stepper_position;
   int64_t last_step_timestamp_us;
   bool stepper_abort;
-  std::string stepper_home_status;
+  StepperHomeStatusString stepper_home_status;
   uint64_t last_update_ms;
   bool calibrating;
   bool external_power_on;
-  std::string usb_error;
+  UsbErrorString usb_error;
   int wifi_rssi_dbm;
   int wifi_quality;
-  std::string wifi_ip;
-  std::string wifi_ip_sta;
-  std::string wifi_ip_ap;
-  std::string eth_ip;
+  Ipv4String wifi_ip;
+  Ipv4String wifi_ip_sta;
+  Ipv4String wifi_ip_ap;
+  Ipv4String eth_ip;
   bool eth_link_up;
   bool eth_ip_up;
   uint64_t sd_total_bytes;
@@ -198,6 +245,147 @@ struct SharedState {
   uint64_t minio_last_failure_ms;
   MeteoData meteo;
 };
+// Heap-free so CopyState() is a plain memcpy with no allocator traffic.
+static_assert(std::is_trivially_copyable<SharedState>::value, "SharedState must stay trivially copyable");
+
+// ---------- Per-domain state views ----------
+//
+// Trivially copyable slices of SharedState grouped by subsystem. Every UpdateState()
+// republishes the domains it changed behind a sequence counter, so readers take a
+// consistent copy of just the domain they need without touching state_mutex and
+// without heap traffic. CopyState() remains for the rare full-state consumers.
+
+// Change-notification groups. Each maps onto one view, except ThermalState, MotionState and
+// StorageState which are split so that PID output, step/Hall counter churn or heap/SD counter
+// churn does not look like fresh temperatures, a motion state change or a logging state change.
+enum class StateGroup : uint8_t {
+  kAdc = 0,             // AdcState
+  kTemps = 1,           // ThermalState: sensor count, temps, labels, addresses
+  kThermalControl = 2,  // ThermalState: heater/fan/external power, PID config and output
+  kMotion = 3,          // MotionState: enable/homing/moving flags, target, home status
+  kNet = 4,             // NetState
+  kLogging = 5,         // StorageState: logging flags, log filename, USB error
+  kStorageStats = 6,    // StorageState: SD, heap and MinIO counters
+  kMeteo = 7,           // MeteoData
+  kMotionProgress = 8,  // MotionState: stepper position and Hall sensor readings
+  kCount
+};
+
+constexpr uint32_t StateGroupBit(StateGroup group) {
+  return 1u << static_cast<uint8_t>(group);
+}
+
+inline constexpr uint32_t STATE_GROUP_ALL = (1u << static_cast<uint8_t>(StateGroup::kCount)) - 1u;
+
+struct AdcState {
+  std::array<float, ADC_CHANNEL_COUNT> voltage;
+  std::array<float, ADC_CHANNEL_COUNT> voltage_cal;
+  std::array<float, ADC_CHANNEL_COUNT> offset;
+  float ina_bus_voltage;
+  float ina_current;
+  float ina_power;
+  bool calibrating;
+  uint64_t last_update_ms;
+};
+
+struct ThermalState {
+  int temp_sensor_count;
+  std::array<float, MAX_TEMP_SENSORS> temps_c;  // outlier-filtered (see sensor_hub.h)
+  std::array<uint8_t, MAX_TEMP_SENSORS> temp_flags;
+  uint32_t temp_cycle;  // bumped with every published temperature cycle
+  std::array<TempLabelString, MAX_TEMP_SENSORS> temp_labels;
+  std::array<TempAddressString, MAX_TEMP_SENSORS> temp_addresses;
+  float heater_power;
+  float fan_power;
+  uint32_t fan1_rpm;
+  uint32_t fan2_rpm;
+  bool external_power_on;
+  bool pid_enabled;
+  float pid_kp;
+  float pid_ki;
+  float pid_kd;
+  float pid_setpoint;
+  int pid_sensor_index;
+  uint16_t pid_sensor_mask;
+  float pid_output;
+  float pid_temperature;
+  float pid_error;
+  float pid_integral;
+  float pid_integral_candidate;
+  float pid_derivative;
+  float pid_p_term;
+  float pid_i_term;
+  float pid_d_term;
+  float pid_raw_output;
+  float pid_dt;
+  bool pid_saturated_high;
+  bool pid_saturated_low;
+  bool pid_integral_held;
+};
+
+struct MotionState {
+  bool homing;
+  bool stepper_enabled;
+  bool stepper_moving;
+  bool stepper_direction_forward;
+  bool stepper_homed;
+  bool stepper_abort;
+  int stepper_speed_us;
+  int stepper_home_offset_steps;
+  int stepper_target;
+  int motor_hall_active_level;
+  StepperHomeStatusString stepper_home_status;
+  int stepper_position;  // kMotionProgress from here on
+  int64_t last_step_timestamp_us;
+  int motor_hall_raw_level;
+  bool motor_hall_triggered;
+  uint32_t motor_hall_edge_count;
+  uint32_t motor_hall_active_edge_count;
+  uint32_t motor_hall_level0_edge_count;
+  uint32_t motor_hall_level1_edge_count;
+  int motor_hall_last_edge_level;
+  int64_t motor_hall_last_edge_seen_us;
+  int motor_hall_width_steps;    // steps the magnet keeps the sensor active
+  float motor_hall_speed_sps;    // step rate over the last revolution, from Hall edges
+};
+
+struct NetState {
+  int wifi_rssi_dbm;
+  int wifi_quality;
+  Ipv4String wifi_ip;
+  Ipv4String wifi_ip_sta;
+  Ipv4String wifi_ip_ap;
+  Ipv4String eth_ip;
+  bool eth_link_up;
+  bool eth_ip_up;
+};
+
+struct StorageState {
+  bool logging;
+  bool log_use_motor;
+  float log_duration_s;
+  LogFilenameString log_filename;
+  UsbErrorString usb_error;
+  uint64_t sd_total_bytes;
+  uint64_t sd_used_bytes;
+  int sd_data_root_files;
+  int sd_to_upload_files;
+  int sd_uploaded_files;
+  uint32_t heap_free_bytes;
+  uint32_t heap_min_free_bytes;
+  uint32_t heap_largest_free_block_bytes;
+  uint32_t heap_internal_free_bytes;
+  uint32_t heap_internal_largest_free_block_bytes;
+  uint32_t heap_psram_free_bytes;
+  uint32_t heap_psram_largest_free_block_bytes;
+  uint32_t minio_upload_attempts;
+  uint32_t minio_upload_successes;
+  uint32_t minio_upload_failures;
+  uint32_t minio_archive_failures;
+  uint64_t minio_last_attempt_ms;
+  uint64_t minio_last_success_ms;
+  uint64_t minio_last_failure_ms;
+};
 
 enum class UtcTimeSource : uint8_t {
   kNone = 0,
@@ -273,10 +461,90 @@ extern sdmmc_card_t* sd_card;
 extern FILE* log_file;
 extern std::string current_log_path;
 
+// Non-owning reference to a `void(SharedState&)` callable. Never allocates, unlike
+// std::function with a capturing lambda; only valid for the duration of the call it is
+// passed to, which is all UpdateState() needs.
+class StateUpdaterRef {
+ public:
+  template <typename F,
+            typename = std::enable_if_t<!std::is_same<std::decay_t<F>, StateUpdaterRef>::value>>
+  StateUpdaterRef(F&& fn)  // NOLINT(google-explicit-constructor)
+      : obj_(const_cast<void*>(static_cast<const void*>(std::addressof(fn)))),
+        call_([](void* obj, SharedState& s) { (*static_cast<std::remove_reference_t<F>*>(obj))(s); }) {}
+
+  void operator()(SharedState& s) const { call_(obj_, s); }
+
+ private:
+  void* obj_;
+  void (*call_)(void*, SharedState&);
+};
+
+// An update is "late" when it waited longer than this for state_mutex and "dropped" only
+// if the mutex could not be taken within STATE_UPDATE_MAX_WAIT_MS.
+inline constexpr uint32_t STATE_UPDATE_LATE_MS = 50;
+inline constexpr uint32_t STATE_UPDATE_MAX_WAIT_MS = 1000;
+inline constexpr size_t STATE_CONTENTION_MAX_CALLERS = 32;
+
+// Per call-site state_mutex telemetry. `caller` is the source file name (a static string)
+// and `line` the line of the UpdateState() call; lambdas would all report as operator().
+struct StateCallerStats {
+  const char* caller;
+  uint32_t line;
+  uint32_t updates;
+  uint32_t late;
+  uint32_t dropped;
+  uint32_t wait_max_us;
+  uint32_t hold_max_us;
+  uint64_t wait_total_us;
+  uint64_t hold_total_us;
+};
+
+struct StateContentionTotals {
+  uint32_t updates;
+  uint32_t late;
+  uint32_t dropped;
+  uint32_t untracked_callers;  // call sites beyond STATE_CONTENTION_MAX_CALLERS
+};
+
+// Full deep copy under state_mutex; prefer the per-domain Read*State() views below.
 SharedState CopyState();
-void UpdateState(const std::function<void(SharedState&)>& updater);
-// For rare diagnostic events that must not be silently dropped under contention.
-void UpdateStateBlocking(const std::function<void(SharedState&)>& updater);
+// Waits up to STATE_UPDATE_MAX_WAIT_MS for state_mutex; late and dropped updates are
+// counted per call site (see GetStateContentionStats).
+void UpdateState(StateUpdaterRef updater,
+                 const char* caller = __builtin_FILE(),
+                 uint32_t line = __builtin_LINE());
+// Same, for an updater that only writes fields of the StateGroupBit()s in `groups`: only
+// the views holding those groups are re-extracted and compared. The periodic writers use
+// it; a field written outside `groups` would not reach its view until some later update.
+void UpdateState(uint32_t groups,
+                 StateUpdaterRef updater,
+                 const char* caller = __builtin_FILE(),
+                 uint32_t line = __builtin_LINE());
+// For rare diagnostic events that must never be dropped: waits for the mutex forever.
+void UpdateStateBlocking(StateUpdaterRef updater,
+                         const char* caller = __builtin_FILE(),
+                         uint32_t line = __builtin_LINE());
+// Copies up to `max` call-site entries into `out` and returns how many were written.
+size_t GetStateContentionStats(StateCallerStats* out, size_t max, StateContentionTotals* totals);
+void ResetStateContentionStats();
+
+// Lock-free per-domain snapshots. `version` (optional) increases every time the domain
+// is republished with different contents.
+AdcState ReadAdcState(uint32_t* version = nullptr);
+ThermalState ReadThermalState(uint32_t* version = nullptr);
+MotionState ReadMotionState(uint32_t* version = nullptr);
+NetState ReadNetState(uint32_t* version = nullptr);
+StorageState ReadStorageState(uint32_t* version = nullptr);
+MeteoData ReadMeteoState(uint32_t* version = nullptr);
+
+// State change notifications. A subscribed task receives xTaskNotify(eSetBits) with the
+// StateGroupBit()s (restricted to its mask) of every group an update changed, so it can
+// block in xTaskNotifyWait(0, UINT32_MAX, &bits, timeout) instead of polling. Subscribers
+// must not use their default notification slot for anything else.
+inline constexpr size_t STATE_MAX_SUBSCRIBERS = 8;
+bool StateSubscribe(TaskHandle_t task, uint32_t group_mask);
+void StateUnsubscribe(TaskHandle_t task);
+
 void ScheduleRestart();
 uint32_t LoadAndIncrementBootId();
 uint32_t GetBootId();
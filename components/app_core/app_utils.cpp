@@ -3,9 +3,11 @@
 #include <algorithm>
 #include <cctype>
 #include <cerrno>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
+#include <strings.h>
 
 #include "esp_log.h"
 #include "esp_timer.h"
@@ -268,3 +270,22 @@ int RssiToQuality(int rssi_dbm) {
   if (q > 100) q = 100;
   return q;
 }
+
+std::array<float, ADC_CHANNEL_COUNT> RadiometerSensorTemps(
+    const std::array<TempAddressString, MAX_TEMP_SENSORS>& addresses,
+    const std::array<float, MAX_TEMP_SENSORS>& temps, int count) {
+  std::array<float, ADC_CHANNEL_COUNT> out;
+  out.fill(NAN);
+  count = std::min(count, MAX_TEMP_SENSORS);
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    const TempAddressString& bound = app_config.brightness_sensor[ch];
+    if (bound.empty()) continue;
+    for (int i = 0; i < count; ++i) {
+      if (strcasecmp(addresses[i].c_str(), bound.c_str()) == 0) {
+        out[ch] = temps[i];
+        break;
+      }
+    }
+  }
+  return out;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <string>
 
@@ -19,6 +20,11 @@ std::string StorageBackendToString(StorageBackend backend);
 uint16_t ClampSensorMask(uint16_t mask, int count);
 int FirstSetBitIndex(uint16_t mask);
 int RssiToQuality(int rssi_dbm);
+// Temperature of the sensor bound to each radiometer channel (app_config.brightness_sensor),
+// NAN when the channel is unbound or its sensor is not among the first `count`.
+std::array<float, ADC_CHANNEL_COUNT> RadiometerSensorTemps(
+    const std::array<TempAddressString, MAX_TEMP_SENSORS>& addresses,
+    const std::array<float, MAX_TEMP_SENSORS>& temps, int count);
 
 // ---------- Filename / path helpers ----------
 
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Brightness temperatures from the radiometer calibrations the backend keeps
+// (radiometer_calibrations, applied there by services/brightness.py). Per channel
+//
+//   T_b = slope * U + intercept
+//
+// with the calibration whose radiometer temperature t_adc is closest to the channel's bound
+// 1-Wire sensor (the newer one on ties), or the newest calibration with usable coefficients
+// when that sensor is unbound or has no reading. Header-only and IDF-free, so the selection
+// rules and the config.txt line format are tested on the host.
+
+inline constexpr int kBrightnessMaxCalibrations = 8;
+
+template <int Channels>
+struct BrightnessCalibration {
+  uint64_t created_ms = 0;                // backend created_at, unix ms; orders the table
+  std::array<float, Channels> t_adc;      // radiometer temperature at calibration, NAN if unknown
+  std::array<float, Channels> slope;      // K/V
+  std::array<float, Channels> intercept;  // K
+
+  BrightnessCalibration() {
+    t_adc.fill(NAN);
+    slope.fill(NAN);
+    intercept.fill(NAN);
+  }
+
+  bool Usable(int ch) const { return std::isfinite(slope[ch]) && std::isfinite(intercept[ch]); }
+  bool AnyUsable() const {
+    for (int ch = 0; ch < Channels; ++ch) {
+      if (Usable(ch)) return true;
+    }
+    return false;
+  }
+};
+
+// Fixed-capacity table, oldest first. Trivially copyable, so a consumer can take a snapshot
+// per logged row.
+template <int Channels>
+class BrightnessTable {
+ public:
+  using Calibration = BrightnessCalibration<Channels>;
+
+  int size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  const Calibration& at(int i) const { return cals_[i]; }
+  void Clear() { count_ = 0; }
+
+  // Keeps created_ms order (an equal timestamp replaces the entry); a full table drops its
+  // oldest entry, or `cal` itself if that is older still. Returns false if `cal` has no
+  // channel with usable coefficients.
+  bool Insert(const Calibration& cal) {
+    if (!cal.AnyUsable()) return false;
+    int pos = count_;
+    while (pos > 0 && cals_[pos - 1].created_ms > cal.created_ms) --pos;
+    if (pos > 0 && cals_[pos - 1].created_ms == cal.created_ms) {
+      cals_[pos - 1] = cal;
+      return true;
+    }
+    if (count_ == kBrightnessMaxCalibrations) {
+      if (pos == 0) return true;
+      for (int i = 1; i < pos; ++i) cals_[i - 1] = cals_[i];
+      cals_[pos - 1] = cal;
+      return true;
+    }
+    for (int i = count_; i > pos; --i) cals_[i] = cals_[i - 1];
+    cals_[pos] = cal;
+    ++count_;
+    return true;
+  }
+
+  // Calibration index for `channel` at radiometer temperature `temp_c` (NAN if unknown), or -1
+  // if no entry has usable coefficients for it.
+  int Select(int channel, float temp_c) const {
+    int latest = -1;
+    for (int i = count_ - 1; i >= 0; --i) {
+      if (cals_[i].Usable(channel)) {
+        latest = i;
+        break;
+      }
+    }
+    if (latest < 0 || !std::isfinite(temp_c)) return latest;
+    int best = -1;
+    float best_diff = INFINITY;
+    for (int i = 0; i < count_; ++i) {
+      const Calibration& cal = cals_[i];
+      if (!cal.Usable(channel) || !std::isfinite(cal.t_adc[channel])) continue;
+      const float diff = std::fabs(cal.t_adc[channel] - temp_c);
+      if (diff <= best_diff) {  // <= lets the newer entry win a tie
+        best = i;
+        best_diff = diff;
+      }
+    }
+    return best >= 0 ? best : latest;
+  }
+
+  // NAN when no calibration applies or `volts` is not a number.
+  float Brightness(int channel, float volts, float temp_c) const {
+    const int idx = Select(channel, temp_c);
+    if (idx < 0 || !std::isfinite(volts)) return NAN;
+    return cals_[idx].slope[channel] * volts + cals_[idx].intercept[channel];
+  }
+
+ private:
+  std::array<Calibration, kBrightnessMaxCalibrations> cals_{};
+  int count_ = 0;
+};
+
+// One calibration as the value of a config.txt `brightness_cal` line:
+// "created_ms, t_adc1, slope1, intercept1, t_adc2, ..." with one triple per channel. Unknown
+// values are written as "nan"; an empty or "nan" field reads back as unknown.
+template <int Channels>
+std::string FormatBrightnessCalibrationLine(const BrightnessCalibration<Channels>& cal) {
+  char buf[64];
+  std::snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(cal.created_ms));
+  std::string out = buf;
+  for (int ch = 0; ch < Channels; ++ch) {
+    std::snprintf(buf, sizeof(buf), ", %.9g, %.9g, %.9g", cal.t_adc[ch], cal.slope[ch], cal.intercept[ch]);
+    out += buf;
+  }
+  return out;
+}
+
+// False for a wrong field count, a field that is not a number, or no usable channel.
+template <int Channels>
+bool ParseBrightnessCalibrationLine(const std::string& value, BrightnessCalibration<Channels>* out) {
+  constexpr size_t kFields = 1 + 3 * static_cast<size_t>(Channels);
+  std::array<std::string, kFields> fields;
+  size_t count = 0;
+  size_t start = 0;
+  while (start <= value.size()) {
+    size_t end = value.find(',', start);
+    if (end == std::string::npos) end = value.size();
+    if (count == kFields) return false;
+    size_t b = start, e = end;
+    while (b < e && (value[b] == ' ' || value[b] == '\t')) ++b;
+    while (e > b && (value[e - 1] == ' ' || value[e - 1] == '\t' || value[e - 1] == '\r')) --e;
+    fields[count++] = value.substr(b, e - b);
+    start = end + 1;
+  }
+  if (count != kFields) return false;
+  char* end = nullptr;
+  BrightnessCalibration<Channels> cal;
+  cal.created_ms = std::strtoull(fields[0].c_str(), &end, 10);
+  if (fields[0].empty() || *end != '\0') return false;
+  for (int ch = 0; ch < Channels; ++ch) {
+    float* targets[3] = {&cal.t_adc[ch], &cal.slope[ch], &cal.intercept[ch]};
+    for (int k = 0; k < 3; ++k) {
+      const std::string& field = fields[1 + 3 * ch + k];
+      if (field.empty()) continue;
+      *targets[k] = std::strtof(field.c_str(), &end);
+      if (*end != '\0') return false;
+    }
+  }
+  if (!cal.AnyUsable()) return false;
+  *out = cal;
+  return true;
+}
@@ -49,6 +49,7 @@ constexpr std::array<ErrorMeta, static_cast<size_t>(ErrorCode::kMax)> kErrorMeta
     {"minio_upload", true, false, 700, 2},
     {"stepper_homing", true, false, 300, 5},
     {"gps_rtcm", true, true, 1000, 2},
+    {"fan_stall", true, false, 300, 4},
 }};
 
 static_assert(kErrorMeta.size() == static_cast<size_t>(ErrorCode::kMax), "error meta mismatch");
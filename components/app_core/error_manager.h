@@ -24,6 +24,7 @@ enum class ErrorCode : uint8_t {
   kMinioUpload = 13,
   kStepperHoming = 14,
   kGpsRtcm = 15,
+  kFanStall = 16,
   kMax
 };
 
@@ -14,6 +14,14 @@ inline constexpr gpio_num_t ADC_SCK = SPI_SCK;
 inline constexpr gpio_num_t ADC_CS1 = GPIO_NUM_16;
 inline constexpr gpio_num_t ADC_CS2 = GPIO_NUM_15;
 inline constexpr gpio_num_t ADC_CS3 = GPIO_NUM_7;
+// One LTC2440 per radiometer channel, in channel order; the channel count follows from this
+// list, so a board with more converters only extends it (up to 8, the AdcSample valid mask).
+inline constexpr gpio_num_t ADC_CS_PINS[] = {ADC_CS1, ADC_CS2, ADC_CS3};
+inline constexpr int ADC_CHANNEL_COUNT =
+    static_cast<int>(sizeof(ADC_CS_PINS) / sizeof(ADC_CS_PINS[0]));
+// Channels that may be unpopulated: their read failures are neither logged nor errors.
+inline constexpr uint32_t ADC_OPTIONAL_MASK = 1u << 0;  // ADC1
+static_assert(ADC_CHANNEL_COUNT >= 1 && ADC_CHANNEL_COUNT <= 8, "1..8 ADC channels");
 
 // Ethernet (W5500 over shared SPI)
 inline constexpr gpio_num_t ETH_CS = GPIO_NUM_1;
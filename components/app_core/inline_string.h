@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// Fixed-capacity, NUL-terminated string stored inline (no heap). Assignments longer than
+// Capacity are truncated. Trivially copyable, so structs holding it can be memcpy'd and
+// published through SeqLock.
+template <size_t Capacity>
+class InlineString {
+ public:
+  InlineString() = default;
+  InlineString(const char* s) { assign(s); }  // NOLINT(google-explicit-constructor)
+  InlineString(const std::string& s) { assign(s.data(), s.size()); }  // NOLINT
+
+  InlineString& operator=(const char* s) {
+    assign(s);
+    return *this;
+  }
+  InlineString& operator=(const std::string& s) {
+    assign(s.data(), s.size());
+    return *this;
+  }
+
+  void assign(const char* s) { assign(s, s ? std::strlen(s) : 0); }
+  void assign(const char* s, size_t len) {
+    if (len > Capacity) len = Capacity;
+    if (len > 0) std::memmove(buf_, s, len);
+    // Zero the tail so equal contents compare equal with memcmp.
+    std::memset(buf_ + len, 0, Capacity + 1 - len);
+  }
+
+  void clear() { std::memset(buf_, 0, sizeof(buf_)); }
+
+  const char* c_str() const { return buf_; }
+  bool empty() const { return buf_[0] == '\0'; }
+  size_t size() const { return std::strlen(buf_); }
+  static constexpr size_t capacity() { return Capacity; }
+  std::string str() const { return std::string(buf_); }
+
+  bool operator==(const char* other) const { return std::strcmp(buf_, other ? other : "") == 0; }
+  bool operator==(const std::string& other) const { return other == buf_; }
+  bool operator!=(const char* other) const { return !(*this == other); }
+  bool operator!=(const std::string& other) const { return !(*this == other); }
+
+ private:
+  char buf_[Capacity + 1] = {};
+};
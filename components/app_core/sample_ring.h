@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-producer, multi-reader broadcast ring of trivially copyable samples.
+//
+// The producer never blocks and never waits for readers: each reader owns a cursor (the
+// sequence number of the next sample it wants) and consumes every sample exactly once as
+// long as it keeps up. A reader that falls more than capacity() behind is moved forward
+// and told how many samples it lost. Storage is supplied by the owner so it can live in
+// PSRAM.
+template <typename T>
+class SampleRing {
+  static_assert(std::is_trivially_copyable<T>::value, "SampleRing payload must be trivially copyable");
+
+ public:
+  // `capacity` must be a power of two. Not thread-safe; call before the producer starts.
+  bool Attach(T* storage, size_t capacity) {
+    if (!storage || capacity < 2 || (capacity & (capacity - 1)) != 0) return false;
+    slots_ = storage;
+    mask_ = static_cast<uint32_t>(capacity - 1);
+    return true;
+  }
+
+  bool ready() const { return slots_ != nullptr; }
+  size_t capacity() const { return slots_ ? mask_ + 1u : 0u; }
+
+  // Sequence number the next Push() will get; a fresh cursor starts here.
+  uint32_t head() const { return head_.load(std::memory_order_acquire); }
+
+  // Producer only.
+  void Push(const T& value) {
+    if (!slots_) return;
+    const uint32_t seq = head_.load(std::memory_order_relaxed);
+    // Announce the slot being overwritten before touching it so readers can detect a lap.
+    claim_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slots_[seq & mask_], &value, sizeof(T));
+    head_.store(seq + 1, std::memory_order_release);
+  }
+
+  // Copies the sample at *cursor into *out and advances the cursor. Returns false when the
+  // reader is caught up. Samples overwritten before they could be read are skipped and
+  // added to *lost (optional).
+  bool Read(uint32_t* cursor, T* out, uint32_t* lost = nullptr) const {
+    if (!slots_ || !cursor || !out) return false;
+    const uint32_t capacity = mask_ + 1u;
+    while (true) {
+      const uint32_t head = head_.load(std::memory_order_acquire);
+      if (*cursor == head) return false;
+      if (head - *cursor >= capacity) {
+        // Lapped: the oldest slot may already be under rewrite, so resume one past it.
+        const uint32_t resume = head - capacity + 1u;
+        if (lost) *lost += resume - *cursor;
+        *cursor = resume;
+      }
+      std::memcpy(out, &slots_[*cursor & mask_], sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (claim_.load(std::memory_order_relaxed) - *cursor <= capacity) {
+        ++*cursor;
+        return true;
+      }
+      // The producer started overwriting this slot while we copied it; retry further on.
+    }
+  }
+
+ private:
+  T* slots_ = nullptr;
+  uint32_t mask_ = 0;
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> claim_{0};
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer sequence lock around a trivially copyable value.
+//
+// The writer bumps the counter to an odd value, copies the payload and bumps it back to
+// even. Readers copy the payload and retry if the counter moved or was odd meanwhile.
+// Writers must be serialized externally (app_state publishes under state_mutex).
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+
+ public:
+  void Store(const T& value) {
+    const uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&value_, &value, sizeof(T));
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // One read attempt; false means a write was in progress and the copy must be discarded.
+  bool TryLoad(T* out, uint32_t* version = nullptr) const {
+    const uint32_t before = seq_.load(std::memory_order_acquire);
+    if (before & 1u) return false;
+    std::memcpy(out, &value_, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq_.load(std::memory_order_relaxed) != before) return false;
+    if (version) *version = before >> 1;
+    return true;
+  }
+
+  // Writer-side access; only valid while holding the external writer lock.
+  const T& UnsafePeek() const { return value_; }
+
+  uint32_t version() const { return seq_.load(std::memory_order_acquire) >> 1; }
+
+ private:
+  std::atomic<uint32_t> seq_{0};
+  T value_{};
+};
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <array>
 #include <cerrno>
+#include <cmath>
 #include <cstdarg>
 #include <unistd.h>
 #include <cstdio>
@@ -111,6 +112,12 @@ bool ParseConfigText(const std::string& text, AppConfig* config) {
   int logging_motor_steps_val = config->logging_motor_steps;
   bool logging_home_each_cycle_set = false;
   bool logging_home_each_cycle_val = config->logging_home_each_cycle;
+  bool settle_min_set = false, settle_max_set = false;
+  int settle_min_val = config->logging_settle_min_ms;
+  int settle_max_val = config->logging_settle_max_ms;
+  bool settle_slope_set = false, settle_std_set = false;
+  float settle_slope_val = config->logging_settle_slope_uv_s;
+  float settle_std_val = config->logging_settle_std_uv;
   bool storage_backend_set = false;
   StorageBackend storage_backend_val = config->storage_backend;
   bool stepper_speed_set = false;
@@ -161,6 +168,14 @@ bool ParseConfigText(const std::string& text, AppConfig* config) {
   int meteo_file_interval_val = config->meteo_file_interval_s;
   bool meteo_enabled_set = false;
   bool meteo_enabled_val = config->meteo_enabled;
+  bool adc_osr_set = false;
+  std::array<uint16_t, ADC_CHANNEL_COUNT> adc_osr_val = config->adc_osr;
+  bool adc_state_period_set = false;
+  int adc_state_period_val = config->adc_state_period_ms;
+  bool brightness_cals_set = false;
+  RadiometerCalibrationTable brightness_cals_val;
+  bool brightness_sensor_set = false;
+  std::array<TempAddressString, ADC_CHANNEL_COUNT> brightness_sensor_val = config->brightness_sensor;
 
   size_t line_start = 0;
   while (line_start <= text.size()) {
@@ -213,6 +228,22 @@ bool ParseConfigText(const std::string& text, AppConfig* config) {
     } else if (key == "logging_home_each_cycle") {
       if (ParseBool(value, &logging_home_each_cycle_val)) logging_home_each_cycle_set = true;
       else ESP_LOGW(kTag, "Invalid logging_home_each_cycle in config.txt");
+    } else if (key == "logging_settle_min_ms") {
+      settle_min_val = std::atoi(value.c_str());
+      if (settle_min_val >= 0) settle_min_set = true;
+      else ESP_LOGW(kTag, "Invalid logging_settle_min_ms in config.txt");
+    } else if (key == "logging_settle_max_ms") {
+      settle_max_val = std::atoi(value.c_str());
+      if (settle_max_val >= 0) settle_max_set = true;
+      else ESP_LOGW(kTag, "Invalid logging_settle_max_ms in config.txt");
+    } else if (key == "logging_settle_slope_uv_s") {
+      const float v = std::strtof(value.c_str(), nullptr);
+      if (std::isfinite(v) && v >= 0.0f) { settle_slope_val = v; settle_slope_set = true; }
+      else ESP_LOGW(kTag, "Invalid logging_settle_slope_uv_s in config.txt");
+    } else if (key == "logging_settle_std_uv") {
+      const float v = std::strtof(value.c_str(), nullptr);
+      if (std::isfinite(v) && v >= 0.0f) { settle_std_val = v; settle_std_set = true; }
+      else ESP_LOGW(kTag, "Invalid logging_settle_std_uv in config.txt");
     } else if (key == "storage_backend") {
       if (ParseStorageBackend(value, &storage_backend_val)) storage_backend_set = true;
       else ESP_LOGW(kTag, "Invalid storage_backend in config.txt");
@@ -284,6 +315,40 @@ bool ParseConfigText(const std::string& text, AppConfig* config) {
       }
     } else if (key == "meteo_enabled") {
       if (ParseBool(value, &meteo_enabled_val)) meteo_enabled_set = true;
+    } else if (key.size() == 8 && key.compare(0, 3, "adc") == 0 && key.compare(4, 4, "_osr") == 0 &&
+               key[3] >= '1' && key[3] < '1' + ADC_CHANNEL_COUNT) {
+      const int v = std::atoi(value.c_str());
+      if (IsValidAdcOsr(v)) {
+        adc_osr_val[key[3] - '1'] = static_cast<uint16_t>(v);
+        adc_osr_set = true;
+      } else {
+        ESP_LOGW(kTag, "Invalid %s in config.txt", key.c_str());
+      }
+    } else if (key == "adc_state_period_ms") {
+      const int v = std::atoi(value.c_str());
+      if (v >= 10 && v <= 10000) {
+        adc_state_period_val = v;
+        adc_state_period_set = true;
+      } else {
+        ESP_LOGW(kTag, "Invalid adc_state_period_ms in config.txt");
+      }
+    } else if (key == "brightness_cal") {
+      // Repeated key, one line per calibration; the lines replace the whole table.
+      RadiometerCalibration cal;
+      if (ParseBrightnessCalibrationLine(value, &cal)) {
+        brightness_cals_val.Insert(cal);
+        brightness_cals_set = true;
+      } else {
+        ESP_LOGW(kTag, "Invalid brightness_cal in config.txt");
+      }
+    } else if (key.size() == 22 && key.compare(0, 21, "brightness_sensor_adc") == 0 &&
+               key[21] >= '1' && key[21] < '1' + ADC_CHANNEL_COUNT) {
+      if (value.size() <= TEMP_ADDRESS_MAX_LEN) {
+        brightness_sensor_val[key[21] - '1'] = value;
+        brightness_sensor_set = true;
+      } else {
+        ESP_LOGW(kTag, "Invalid %s in config.txt", key.c_str());
+      }
     }
   }
 
@@ -295,6 +360,10 @@ bool ParseConfigText(const std::string& text, AppConfig* config) {
   if (log_duration_set) { config->logging_duration_s = log_duration_val; log_config.duration_s = log_duration_val; }
   if (logging_motor_steps_set) config->logging_motor_steps = std::clamp(logging_motor_steps_val, 1, 20000);
   if (logging_home_each_cycle_set) config->logging_home_each_cycle = logging_home_each_cycle_val;
+  if (settle_max_set) config->logging_settle_max_ms = std::clamp(settle_max_val, 0, 60000);
+  if (settle_min_set) config->logging_settle_min_ms = std::clamp(settle_min_val, 0, 60000);
+  if (settle_slope_set) config->logging_settle_slope_uv_s = settle_slope_val;
+  if (settle_std_set) config->logging_settle_std_uv = settle_std_val;
   if (storage_backend_set) config->storage_backend = storage_backend_val;
   if (stepper_speed_set) { config->stepper_speed_us = stepper_speed_val; UpdateState([&](SharedState& s) { s.stepper_speed_us = stepper_speed_val; }); }
   if (stepper_home_offset_set) { config->stepper_home_offset_steps = stepper_home_offset_val; UpdateState([&](SharedState& s) { s.stepper_home_offset_steps = stepper_home_offset_val; }); }
@@ -321,6 +390,10 @@ bool ParseConfigText(const std::string& text, AppConfig* config) {
   if (meteo_poll_interval_set) config->meteo_poll_interval_s = meteo_poll_interval_val;
   if (meteo_file_interval_set) config->meteo_file_interval_s = meteo_file_interval_val;
   if (meteo_enabled_set) config->meteo_enabled = meteo_enabled_val;
+  if (adc_osr_set) config->adc_osr = adc_osr_val;
+  if (adc_state_period_set) config->adc_state_period_ms = adc_state_period_val;
+  if (brightness_cals_set) config->brightness_cals = brightness_cals_val;
+  if (brightness_sensor_set) config->brightness_sensor = brightness_sensor_val;
   if (pid_kp_set || pid_ki_set || pid_kd_set || pid_sp_set || pid_sensor_set || pid_mask_set) {
     pid_config.kp = pid_kp; pid_config.ki = pid_ki; pid_config.kd = pid_kd;
     pid_config.setpoint = pid_sp; pid_config.sensor_index = pid_sensor;
@@ -338,14 +411,16 @@ bool ParseConfigText(const std::string& text, AppConfig* config) {
 
   return config->wifi_from_file || log_active_set ||
          log_postfix_set || log_use_motor_set || log_duration_set || logging_motor_steps_set ||
-         logging_home_each_cycle_set || storage_backend_set || stepper_speed_set ||
+         logging_home_each_cycle_set || settle_min_set || settle_max_set || settle_slope_set ||
+         settle_std_set || storage_backend_set || stepper_speed_set ||
          stepper_home_offset_set || motor_hall_active_set || device_id_set ||
          minio_endpoint_set || minio_access_set || minio_secret_set || minio_bucket_set ||
          minio_enabled_set || mqtt_uri_set || mqtt_user_set || mqtt_password_set ||
          mqtt_enabled_set || net_mode_set || net_priority_set || eth_dhcp_set ||
          eth_static_ip_set || eth_static_netmask_set || eth_static_gateway_set || eth_static_dns_set || gps_rtcm_types_set ||
          gps_mode_set || meteo_poll_interval_set || meteo_file_interval_set ||
-         meteo_enabled_set || pid_config.from_file;
+         meteo_enabled_set || adc_osr_set || adc_state_period_set || brightness_cals_set || brightness_sensor_set ||
+         pid_config.from_file;
 }
 
 bool ParseConfigFile(FILE* file, AppConfig* config) {
@@ -561,6 +636,10 @@ std::string BuildConfigText(const AppConfig& cfg, const PidConfig& pid) {
   AppendConfigLine(&text, "logging_duration_s = %.3f\n", cfg.logging_duration_s);
   AppendConfigLine(&text, "logging_motor_steps = %d\n", cfg.logging_motor_steps);
   AppendConfigLine(&text, "logging_home_each_cycle = %s\n", cfg.logging_home_each_cycle ? "true" : "false");
+  AppendConfigLine(&text, "logging_settle_min_ms = %d\n", cfg.logging_settle_min_ms);
+  AppendConfigLine(&text, "logging_settle_max_ms = %d\n", cfg.logging_settle_max_ms);
+  AppendConfigLine(&text, "logging_settle_slope_uv_s = %.3f\n", cfg.logging_settle_slope_uv_s);
+  AppendConfigLine(&text, "logging_settle_std_uv = %.3f\n", cfg.logging_settle_std_uv);
   AppendConfigLine(&text, "stepper_speed_us = %d\n", cfg.stepper_speed_us);
   AppendConfigLine(&text, "stepper_home_offset_steps = %d\n", cfg.stepper_home_offset_steps);
   AppendConfigLine(&text, "motor_hall_active_level = %d\n", cfg.motor_hall_active_level);
@@ -570,7 +649,7 @@ std::string BuildConfigText(const AppConfig& cfg, const PidConfig& pid) {
   AppendConfigLine(&text, "pid_setpoint = %.6f\n", pid.setpoint);
   AppendConfigLine(&text, "pid_sensor = %d\n", pid.sensor_index);
   AppendConfigLine(&text, "pid_sensor_mask = %u\n", static_cast<unsigned int>(pid.sensor_mask));
-  AppendConfigLine(&text, "pid_enabled = %s\n", CopyState().pid_enabled ? "true" : "false");
+  AppendConfigLine(&text, "pid_enabled = %s\n", ReadThermalState().pid_enabled ? "true" : "false");
   if (!cfg.device_id.empty()) AppendConfigLine(&text, "device_id = %s\n", cfg.device_id.c_str());
   if (!cfg.minio_endpoint.empty()) AppendConfigLine(&text, "minio_endpoint = %s\n", cfg.minio_endpoint.c_str());
   if (!cfg.minio_access_key.empty()) AppendConfigLine(&text, "minio_access_key = %s\n", cfg.minio_access_key.c_str());
@@ -584,5 +663,16 @@ std::string BuildConfigText(const AppConfig& cfg, const PidConfig& pid) {
   AppendConfigLine(&text, "meteo_poll_interval_s = %d\n", cfg.meteo_poll_interval_s);
   AppendConfigLine(&text, "meteo_file_interval_s = %d\n", cfg.meteo_file_interval_s);
   AppendConfigLine(&text, "meteo_enabled = %s\n", cfg.meteo_enabled ? "true" : "false");
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    AppendConfigLine(&text, "adc%d_osr = %u\n", i + 1, static_cast<unsigned>(cfg.adc_osr[i]));
+  }
+  AppendConfigLine(&text, "adc_state_period_ms = %d\n", cfg.adc_state_period_ms);
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    if (cfg.brightness_sensor[ch].empty()) continue;
+    AppendConfigLine(&text, "brightness_sensor_adc%d = %s\n", ch + 1, cfg.brightness_sensor[ch].c_str());
+  }
+  for (int i = 0; i < cfg.brightness_cals.size(); ++i) {
+    text += "brightness_cal = " + FormatBrightnessCalibrationLine(cfg.brightness_cals.at(i)) + "\n";
+  }
   return text;
 }
@@ -86,13 +86,14 @@ bool OpenLogFileWithPostfix(const std::string& postfix) {
     return false;
   }
 
-  SharedState snapshot = CopyState();
+  const ThermalState snapshot = ReadThermalState();
   const int temp_count = std::min(snapshot.temp_sensor_count, MAX_TEMP_SENSORS);
   log_config.temp_sensor_count = temp_count;
   log_config.file_start_us = esp_timer_get_time();
-  fprintf(log_file, "timestamp_iso,timestamp_ms,adc1,adc2,adc3");
+  fprintf(log_file, "timestamp_iso,timestamp_ms");
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) fprintf(log_file, ",adc%d", ch + 1);
   for (int i = 0; i < temp_count; ++i) {
-    const std::string& label = snapshot.temp_labels[i];
+    const TempLabelString& label = snapshot.temp_labels[i];
     if (!label.empty()) {
       fprintf(log_file, ",%s", label.c_str());
     } else {
@@ -101,9 +102,26 @@ bool OpenLogFileWithPostfix(const std::string& postfix) {
   }
   fprintf(log_file, ",bus_v,bus_i,bus_p");
   if (log_config.use_motor) {
-    fprintf(log_file, ",adc1_cal,adc2_cal,adc3_cal");
+    for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) fprintf(log_file, ",adc%d_cal", ch + 1);
   }
   fprintf(log_file, ",gps_lat,gps_lon,gps_alt,gps_fix_quality,gps_satellites,gps_fix_age_ms");
+  // Clipped-mean report per ADC channel: std, accepted, rejected, quality (0 good .. 3 empty).
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    fprintf(log_file, ",adc%d_std,adc%d_n,adc%d_rej,adc%d_q", ch + 1, ch + 1, ch + 1, ch + 1);
+  }
+  if (log_config.use_motor) {
+    for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+      fprintf(log_file, ",adc%d_cal_std,adc%d_cal_n,adc%d_cal_rej,adc%d_cal_q", ch + 1, ch + 1, ch + 1,
+              ch + 1);
+    }
+    fprintf(log_file, ",settle_ms,settle_cal_ms");
+  }
+  fprintf(log_file, ",temp_flagged");
+  // On-device brightness temperatures (K); empty where no calibration is stored.
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) fprintf(log_file, ",brightness_temp%d", ch + 1);
+  if (log_config.use_motor) {
+    for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) fprintf(log_file, ",cal_brightness_temp%d", ch + 1);
+  }
   fprintf(log_file, "\n");
   FlushLogFile();
 
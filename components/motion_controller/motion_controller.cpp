@@ -2,27 +2,34 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <new>
 #include <string>
 
 #include "cJSON.h"
 #include "driver/gpio.h"
 #include "driver/ledc.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_rom_sys.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/task.h"
 
 #include "app_state.h"
+#include "adc_stats.h"
 #include "app_utils.h"
 #include "data_logger.h"
 #include "error_manager.h"
 #include "hw_pins.h"
 #include "gps_module.h"
+#include "onewire_m1820.h"
+#include "sample_ring.h"
 #include "sensor_hub.h"
 #include "storage_manager.h"
 #include "upload_pipeline.h"
@@ -42,10 +49,36 @@ static bool s_hall_isr_registered = false;
 static uint32_t s_hall_last_reported_edge_count = 0;
 static int64_t s_hall_last_edge_seen_us = 0;
 
+// Signed count of every step pulse issued since boot; HallSensorIsr stamps edges with it.
+static int32_t s_step_count = 0;
+
+// Every Hall edge, written only by HallSensorIsr; consumers keep their own cursors.
+static constexpr size_t kHallEdgeRingCapacity = 64;
+static HallEdge             s_hall_edge_storage[kHallEdgeRingCapacity];
+static SampleRing<HallEdge> s_hall_edges;
+
+// Magnet width and rotor speed derived from the edge ring by RefreshHallDebugState(), which
+// several tasks call; the tracker is copied in and out under the mux.
+struct HallEdgeTracker {
+  HallEdgeCursor cursor;
+  bool     have_enter = false;
+  HallEdge last_enter{};
+  int64_t  last_edge_us = 0;
+  int32_t  width_steps = 0;
+  float    speed_sps = 0.0f;
+};
+static HallEdgeTracker s_hall_tracker;
+static portMUX_TYPE    s_hall_tracker_mux = portMUX_INITIALIZER_UNLOCKED;
+
 // ---------- GPIO helpers ----------
 
 static void IRAM_ATTR HallSensorIsr(void*) {
   const int raw = gpio_get_level(MT_HALL_SEN);
+  HallEdge edge;
+  edge.timestamp_us = esp_timer_get_time();
+  edge.step         = __atomic_load_n(&s_step_count, __ATOMIC_RELAXED);
+  edge.level        = static_cast<uint8_t>(raw);
+  s_hall_edges.Push(edge);
   s_hall_last_raw_level = raw;
   s_hall_edge_count = s_hall_edge_count + 1;
   if (raw == 0) {
@@ -67,6 +100,39 @@ uint32_t HallActiveEdgeCount() {
 
 int HallLastRawLevel() { return s_hall_last_raw_level; }
 
+int32_t StepperStepCount() { return __atomic_load_n(&s_step_count, __ATOMIC_RELAXED); }
+
+HallEdgeCursor HallEdgesOpenCursor() {
+  HallEdgeCursor cursor;
+  cursor.next_seq = s_hall_edges.head();
+  return cursor;
+}
+
+bool HallEdgesRead(HallEdgeCursor* cursor, HallEdge* out) {
+  if (!cursor || !out) return false;
+  return s_hall_edges.Read(&cursor->next_seq, out, &cursor->lost);
+}
+
+// Width: steps from entering the active level to leaving it. Speed: steps per second between
+// consecutive active-level entries, i.e. averaged over one revolution.
+static void UpdateHallTracker(HallEdgeTracker* t) {
+  HallEdge edge{};
+  while (HallEdgesRead(&t->cursor, &edge)) {
+    const bool active = edge.level == app_config.motor_hall_active_level;
+    t->last_edge_us = edge.timestamp_us;
+    if (active) {
+      if (t->have_enter && edge.timestamp_us > t->last_enter.timestamp_us) {
+        const float dt_s = static_cast<float>(edge.timestamp_us - t->last_enter.timestamp_us) * 1e-6f;
+        t->speed_sps = static_cast<float>(std::abs(edge.step - t->last_enter.step)) / dt_s;
+      }
+      t->last_enter = edge;
+      t->have_enter = true;
+    } else if (t->have_enter) {
+      t->width_steps = std::abs(edge.step - t->last_enter.step);
+    }
+  }
+}
+
 void RefreshHallDebugState() {
   const int raw = gpio_get_level(MT_HALL_SEN);
   const bool triggered = raw == app_config.motor_hall_active_level;
@@ -76,11 +142,20 @@ void RefreshHallDebugState() {
   const uint32_t level1_edges = HallLevel1EdgeCount();
   const int last_edge_level = HallLastRawLevel();
   const int64_t now_us = esp_timer_get_time();
+  HallEdgeTracker tracker;
+  portENTER_CRITICAL(&s_hall_tracker_mux);
+  tracker = s_hall_tracker;
+  portEXIT_CRITICAL(&s_hall_tracker_mux);
+  UpdateHallTracker(&tracker);
+  portENTER_CRITICAL(&s_hall_tracker_mux);
+  s_hall_tracker = tracker;
+  portEXIT_CRITICAL(&s_hall_tracker_mux);
   if (edge_count != s_hall_last_reported_edge_count) {
     s_hall_last_reported_edge_count = edge_count;
-    s_hall_last_edge_seen_us = now_us;
+    // ISR time of the newest edge; the poll time only if the ring has none yet.
+    s_hall_last_edge_seen_us = tracker.last_edge_us > 0 ? tracker.last_edge_us : now_us;
   }
-  UpdateState([&](SharedState& s) {
+  UpdateState(StateGroupBit(StateGroup::kMotionProgress), [&](SharedState& s) {
     s.motor_hall_raw_level = raw;
     s.motor_hall_triggered = triggered;
     s.motor_hall_edge_count = edge_count;
@@ -89,6 +164,8 @@ void RefreshHallDebugState() {
     s.motor_hall_level1_edge_count = level1_edges;
     s.motor_hall_last_edge_level = last_edge_level;
     s.motor_hall_last_edge_seen_us = s_hall_last_edge_seen_us;
+    s.motor_hall_width_steps = tracker.width_steps;
+    s.motor_hall_speed_sps = tracker.speed_sps;
   });
 }
 
@@ -135,6 +212,7 @@ void MotionControllerSetPublisher(MeasurementPublishFn fn) { s_publish_fn = fn;
 
 void MotionControllerInit() {
   if (MT_HALL_SEN != GPIO_NUM_NC && !s_hall_isr_registered) {
+    s_hall_edges.Attach(s_hall_edge_storage, kHallEdgeRingCapacity);
     s_hall_last_raw_level = gpio_get_level(MT_HALL_SEN);
     EnsureGpioIsrServiceInstalled();
     ESP_ERROR_CHECK(gpio_set_intr_type(MT_HALL_SEN, GPIO_INTR_ANYEDGE));
@@ -194,7 +272,7 @@ void HeaterSetPowerPercent(float p) {
   const uint32_t duty = static_cast<uint32_t>(p * 1023.0f / 100.0f);
   ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, duty);
   ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0);
-  UpdateState([&](SharedState& s) { s.heater_power = p; });
+  UpdateState(StateGroupBit(StateGroup::kThermalControl), [&](SharedState& s) { s.heater_power = p; });
 }
 
 void FanSetPowerPercent(float p) {
@@ -207,11 +285,89 @@ void FanSetPowerPercent(float p) {
   const uint32_t duty = static_cast<uint32_t>(p * 1023.0f / 100.0f);
   ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1, duty);
   ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_1);
-  UpdateState([&](SharedState& s) { s.fan_power = p; });
+  UpdateState(StateGroupBit(StateGroup::kThermalControl), [&](SharedState& s) { s.fan_power = p; });
 }
 
+// ---------- motion command channel ----------
+//
+// Motor loops check abort through an atomic and receive work through a queue instead of
+// polling SharedState; SharedState only mirrors position/abort for display and is updated
+// at kMotionPublishIntervalUs while moving.
+
+enum class MotionCommandType : uint8_t { kMove, kStop };
+
+struct MotionCommand {
+  MotionCommandType type;
+  int  steps;
+  bool forward;
+  int  speed_us;
+};
+
+static constexpr int64_t kMotionPublishIntervalUs = 100'000;
+static constexpr UBaseType_t kMotionQueueDepth    = 4;
+static QueueHandle_t s_motion_queue = nullptr;
+static std::atomic<bool> s_stepper_abort{false};
+
+static bool StepperAbortRequested() {
+  return s_stepper_abort.load(std::memory_order_acquire);
+}
+
+static void SetStepperAbort(bool abort) {
+  s_stepper_abort.store(abort, std::memory_order_release);
+}
+
+static void PostMotionCommand(const MotionCommand& cmd) {
+  if (!s_motion_queue) return;
+  if (xQueueSend(s_motion_queue, &cmd, 0) != pdTRUE) {
+    // Queue full of stale commands: the newest one wins.
+    xQueueReset(s_motion_queue);
+    xQueueSend(s_motion_queue, &cmd, 0);
+  }
+}
+
+// Folds per-step position changes into coarse SharedState updates.
+class StepPositionPublisher {
+ public:
+  StepPositionPublisher() : last_publish_us_(esp_timer_get_time()) {}
+  ~StepPositionPublisher() { Flush(); }
+
+  void Step(int delta) {
+    pending_ += delta;
+    const int64_t now = esp_timer_get_time();
+    if (now - last_publish_us_ >= kMotionPublishIntervalUs) Publish(now);
+  }
+
+  void Flush() {
+    if (pending_ != 0) Publish(esp_timer_get_time());
+  }
+
+ private:
+  void Publish(int64_t now) {
+    const int delta = pending_;
+    pending_ = 0;
+    last_publish_us_ = now;
+    if (delta == 0) return;
+    UpdateState(StateGroupBit(StateGroup::kMotionProgress), [&](SharedState& s) {
+      s.stepper_position += delta;
+      s.last_step_timestamp_us = now;
+    });
+  }
+
+  int pending_ = 0;
+  int64_t last_publish_us_;
+};
+
 // ---------- stepper primitives ----------
 
+// `direction` is +1 forward, -1 backward; every pulse must go through here so Hall edges can
+// be placed on the step count.
+static void StepperPulseOnce(int direction) {
+  gpio_set_level(STEPPER_STEP, 1);
+  esp_rom_delay_us(4);
+  gpio_set_level(STEPPER_STEP, 0);
+  __atomic_fetch_add(&s_step_count, direction, __ATOMIC_RELAXED);
+}
+
 void EnableStepper() {
   gpio_set_level(STEPPER_EN, 0);
   UpdateState([](SharedState& s) { s.stepper_enabled = true; });
@@ -219,6 +375,7 @@ void EnableStepper() {
 
 void DisableStepper() {
   gpio_set_level(STEPPER_EN, 1);
+  PostMotionCommand({MotionCommandType::kStop, 0, true, 1});
   UpdateState([](SharedState& s) {
     s.stepper_enabled = false;
     s.stepper_moving  = false;
@@ -226,6 +383,8 @@ void DisableStepper() {
 }
 
 void StopStepper() {
+  SetStepperAbort(true);
+  PostMotionCommand({MotionCommandType::kStop, 0, true, 1});
   UpdateState([](SharedState& s) {
     s.stepper_moving = false;
     s.stepper_abort  = true;
@@ -234,101 +393,118 @@ void StopStepper() {
 }
 
 void StartStepperMove(int steps, bool forward, int speed_us) {
-  const int clamped = std::max(speed_us, 1);
-  UpdateState([=](SharedState& s) {
-    if (!s.stepper_enabled) return;
-    s.stepper_abort              = false;
-    s.stepper_direction_forward  = forward;
-    s.stepper_speed_us           = clamped;
-    s.stepper_target             = s.stepper_position + (forward ? steps : -steps);
-    s.stepper_moving             = true;
-    s.last_step_timestamp_us     = esp_timer_get_time();
-  });
-  gpio_set_level(STEPPER_DIR, forward ? 1 : 0);
+  const MotionState motion = ReadMotionState();
+  if (!motion.stepper_enabled) return;
+  if (motion.homing) {
+    ESP_LOGW(kTag, "Stepper move ignored: homing in progress");
+    return;
+  }
+  SetStepperAbort(false);
+  PostMotionCommand({MotionCommandType::kMove, steps, forward, std::max(speed_us, 1)});
 }
 
 // ---------- StepperTask ----------
 
-struct StepperTaskSnapshot {
-  bool    homing                  = false;
-  bool    stepper_abort           = false;
-  bool    stepper_enabled         = false;
-  bool    stepper_moving          = false;
-  bool    stepper_direction_forward = true;
-  int     stepper_speed_us        = 1;
-  int64_t last_step_timestamp_us  = 0;
-};
-
-static StepperTaskSnapshot ReadStepperTaskSnapshot() {
-  StepperTaskSnapshot out{};
-  if (state_mutex && xSemaphoreTake(state_mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-    out.homing                   = state.homing;
-    out.stepper_abort            = state.stepper_abort;
-    out.stepper_enabled          = state.stepper_enabled;
-    out.stepper_moving           = state.stepper_moving;
-    out.stepper_direction_forward = state.stepper_direction_forward;
-    out.stepper_speed_us         = state.stepper_speed_us;
-    out.last_step_timestamp_us   = state.last_step_timestamp_us;
-    xSemaphoreGive(state_mutex);
+// Runs one StartStepperMove() request. Returns early on abort, stop, or when a newer
+// command arrives (stored in *next).
+static bool RunStepperMove(const MotionCommand& cmd, MotionCommand* next) {
+  const int steps = std::max(cmd.steps, 0);
+  const int64_t start_us = esp_timer_get_time();
+  UpdateState([&](SharedState& s) {
+    s.stepper_abort             = false;
+    s.stepper_direction_forward = cmd.forward;
+    s.stepper_speed_us          = cmd.speed_us;
+    s.stepper_target            = s.stepper_position + (cmd.forward ? steps : -steps);
+    s.stepper_moving            = steps > 0;
+    s.last_step_timestamp_us    = start_us;
+  });
+  gpio_set_level(STEPPER_DIR, cmd.forward ? 1 : 0);
+
+  const int64_t tick_us = static_cast<int64_t>(portTICK_PERIOD_MS) * 1000;
+  bool preempted = false;
+  int done = 0;
+  {
+    StepPositionPublisher publisher;
+    int64_t last_step_us = start_us;
+    while (done < steps) {
+      if (StepperAbortRequested()) break;
+      if (xQueueReceive(s_motion_queue, next, 0) == pdTRUE) {
+        preempted = true;
+        break;
+      }
+      const int64_t wait_us = cmd.speed_us - (esp_timer_get_time() - last_step_us);
+      if (wait_us >= tick_us) {
+        // Long step periods block on the queue so stop/new commands land immediately.
+        if (xQueueReceive(s_motion_queue, next, pdMS_TO_TICKS(wait_us / 1000)) == pdTRUE) {
+          preempted = true;
+          break;
+        }
+        continue;
+      }
+      if (wait_us > 0) esp_rom_delay_us(static_cast<uint32_t>(wait_us));
+      StepperPulseOnce(cmd.forward ? 1 : -1);
+      last_step_us = esp_timer_get_time();
+      publisher.Step(cmd.forward ? 1 : -1);
+      done++;
+      taskYIELD();
+    }
   }
-  out.stepper_speed_us = std::max(out.stepper_speed_us, 1);
-  return out;
+  UpdateState([](SharedState& s) {
+    s.stepper_moving = false;
+    s.stepper_target = s.stepper_position;
+  });
+  return preempted;
 }
 
 static void StepperTask(void*) {
-  const TickType_t idle_active = pdMS_TO_TICKS(1);
-  const TickType_t idle_idle   = pdMS_TO_TICKS(5);
+  MotionCommand cmd{};
+  bool have_cmd = false;
   while (true) {
-    StepperTaskSnapshot snap = ReadStepperTaskSnapshot();
-    if (snap.homing && !snap.stepper_abort) {
-      vTaskDelay(idle_idle);
-      continue;
+    if (!have_cmd && xQueueReceive(s_motion_queue, &cmd, portMAX_DELAY) != pdTRUE) continue;
+    have_cmd = false;
+    if (cmd.type != MotionCommandType::kMove) continue;
+    if (!ReadMotionState().stepper_enabled || StepperAbortRequested()) continue;
+    MotionCommand next{};
+    if (RunStepperMove(cmd, &next)) {
+      cmd      = next;
+      have_cmd = true;
     }
-    if (snap.stepper_enabled && snap.stepper_moving && !snap.stepper_abort) {
-      gpio_set_level(STEPPER_DIR, snap.stepper_direction_forward ? 1 : 0);
-      const int64_t now = esp_timer_get_time();
-      if (now - snap.last_step_timestamp_us >= snap.stepper_speed_us) {
-        gpio_set_level(STEPPER_STEP, 1);
-        esp_rom_delay_us(4);
-        gpio_set_level(STEPPER_STEP, 0);
-        UpdateState([&](SharedState& s) {
-          if (!s.stepper_moving || !s.stepper_enabled) return;
-          s.stepper_position += s.stepper_direction_forward ? 1 : -1;
-          s.last_step_timestamp_us = now;
-          if ((s.stepper_direction_forward  && s.stepper_position >= s.stepper_target) ||
-              (!s.stepper_direction_forward && s.stepper_position <= s.stepper_target)) {
-            s.stepper_moving = false;
-          }
-        });
-        vTaskDelay(idle_active);
-      }
-    } else if (snap.stepper_abort) {
-      UpdateState([](SharedState& s) { s.stepper_moving = false; });
-    }
-    vTaskDelay(snap.stepper_moving ? idle_active : idle_idle);
   }
 }
 
 // ---------- PidTask ----------
 
+// PidTask waits this long for fresh temperatures before re-checking while idle, and before
+// running on the last reading while active.
+static constexpr uint32_t kPidIdleWaitMs  = 1000;
+static constexpr uint32_t kPidStaleWaitMs = 3000;
+
 static void PidTask(void*) {
   float  integral        = 0.0f;
   float  prev_error      = 0.0f;
   int64_t prev_update_us = 0;
   bool   have_prev_error = false;
 
-  SharedState initial = CopyState();
+  // Woken by the temperature job publishing fresh temperatures; the timeouts keep enable/disable
+  // responsive and let the loop run on stale data if the sensors stall.
+  StateSubscribe(xTaskGetCurrentTaskHandle(), StateGroupBit(StateGroup::kTemps));
+  auto wait_for_temps = [](uint32_t timeout_ms) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &bits, pdMS_TO_TICKS(timeout_ms));
+  };
+
+  const ThermalState initial = ReadThermalState();
   if (pid_config.from_file && initial.pid_enabled) {
     UpdateState([](SharedState& s) { s.pid_enabled = true; });
   }
 
   while (true) {
-    SharedState snap = CopyState();
+    const ThermalState snap = ReadThermalState();
     if (!snap.pid_enabled) {
       integral = prev_error = 0.0f;
       prev_update_us  = 0;
       have_prev_error = false;
-      UpdateState([](SharedState& s) {
+      UpdateState(StateGroupBit(StateGroup::kThermalControl), [](SharedState& s) {
         s.pid_temperature         = 0.0f;
         s.pid_error               = 0.0f;
         s.pid_integral            = 0.0f;
@@ -343,11 +519,11 @@ static void PidTask(void*) {
         s.pid_saturated_low       = false;
         s.pid_integral_held       = false;
       });
-      vTaskDelay(pdMS_TO_TICKS(1000));
+      wait_for_temps(kPidIdleWaitMs);
       continue;
     }
     if (snap.temp_sensor_count <= 0) {
-      vTaskDelay(pdMS_TO_TICKS(1000));
+      wait_for_temps(kPidIdleWaitMs);
       continue;
     }
 
@@ -366,7 +542,7 @@ static void PidTask(void*) {
       temp_count++;
     }
     if (temp_count == 0) {
-      vTaskDelay(pdMS_TO_TICKS(1000));
+      wait_for_temps(kPidIdleWaitMs);
       continue;
     }
 
@@ -392,7 +568,7 @@ static void PidTask(void*) {
     }
 
     HeaterSetPowerPercent(std::clamp(output, 0.0f, 100.0f));
-    UpdateState([&](SharedState& s) {
+    UpdateState(StateGroupBit(StateGroup::kThermalControl), [&](SharedState& s) {
       s.pid_output             = output;
       s.pid_temperature        = temp;
       s.pid_error              = error;
@@ -411,13 +587,16 @@ static void PidTask(void*) {
     prev_error      = error;
     prev_update_us  = now_us;
     have_prev_error = true;
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    wait_for_temps(kPidStaleWaitMs);
   }
 }
 
 // ---------- MotionControllerStartTasks ----------
 
 void MotionControllerStartTasks() {
+  if (!s_motion_queue) {
+    s_motion_queue = xQueueCreate(kMotionQueueDepth, sizeof(MotionCommand));
+  }
   xTaskCreatePinnedToCore(&StepperTask, "stepper_task", 4096, nullptr, 3, nullptr, 1);
   xTaskCreatePinnedToCore(&PidTask,     "pid_task",     8192, nullptr, 2, nullptr, 0);
 }
@@ -438,30 +617,52 @@ void CalibrateZero() {
   gpio_set_level(RELAY_PIN, 1);
   vTaskDelay(pdMS_TO_TICKS(1000));
 
+  // Consume the ADC job's conversions instead of reading the ADCs ourselves, so calibration
+  // neither competes for the SPI bus nor sees a conversion twice.
   constexpr int kSamples       = 100;
   constexpr int kIgnoreSamples = 10;
-  float sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+  constexpr TickType_t kSampleTimeout = pdMS_TO_TICKS(2000);
+  AdcSampleCursor cursor = AdcSamplesOpenCursor();
+  std::array<float, ADC_CHANNEL_COUNT> sum{};
+  std::array<int, ADC_CHANNEL_COUNT>   count{};
   int   valid = 0;
   for (int i = 0; i < kSamples; ++i) {
-    float v1 = 0.0f, v2 = 0.0f, v3 = 0.0f;
-    if (ReadAllAdc(&v1, &v2, &v3) == ESP_OK && i >= kIgnoreSamples) {
-      sum1 += v1;
-      sum2 += v2;
-      sum3 += v3;
+    AdcSample sample{};
+    if (!AdcSamplesRead(&cursor, &sample, kSampleTimeout)) {
+      ESP_LOGW(kTag, "Calibration: no ADC conversion within %u ms", static_cast<unsigned>(pdTICKS_TO_MS(kSampleTimeout)));
+      break;
+    }
+    if (i >= kIgnoreSamples) {
+      // A channel that failed this conversion has raw=0, which would drag its offset to zero.
+      for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+        if (!(sample.valid_mask & (1u << ch))) continue;
+        sum[ch] += AdcCodeToVolts(sample.raw[ch]);
+        count[ch]++;
+      }
       valid++;
     }
-    vTaskDelay(pdMS_TO_TICKS(200));
+  }
+  if (cursor.lost > 0) {
+    ESP_LOGW(kTag, "Calibration: %u ADC conversions overwritten before read", static_cast<unsigned>(cursor.lost));
   }
 
   if (valid > 0) {
-    const float o1 = sum1 / valid, o2 = sum2 / valid, o3 = sum3 / valid;
+    // Channels with no valid conversion keep their previous offset.
+    std::array<float, ADC_CHANNEL_COUNT> offsets{};
     UpdateState([&](SharedState& s) {
-      s.offset1     = o1;
-      s.offset2     = o2;
-      s.offset3     = o3;
+      for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+        if (count[ch] > 0) s.offset[ch] = sum[ch] / count[ch];
+        offsets[ch] = s.offset[ch];
+      }
       s.calibrating = false;
     });
-    ESP_LOGI(kTag, "Calibration done: offsets %.6f, %.6f, %.6f", o1, o2, o3);
+    std::string text;
+    for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+      char buf[32];
+      std::snprintf(buf, sizeof(buf), "%s%.6f%s", ch ? ", " : "", offsets[ch], count[ch] > 0 ? "" : " (kept)");
+      text += buf;
+    }
+    ESP_LOGI(kTag, "Calibration done: offsets %s", text.c_str());
   } else {
     UpdateState([](SharedState& s) { s.calibrating = false; });
     ESP_LOGW(kTag, "Calibration collected no samples");
@@ -503,12 +704,6 @@ static std::string StepperHomeFailureMessage(const char* phase, const StepperHom
   return std::string(buf);
 }
 
-static void StepperPulseOnce() {
-  gpio_set_level(STEPPER_STEP, 1);
-  esp_rom_delay_us(4);
-  gpio_set_level(STEPPER_STEP, 0);
-}
-
 static bool MoveStepperBlockingSigned(int signed_steps, int step_delay_us, const char* log_context) {
   if (signed_steps == 0) return true;
   const bool forward = signed_steps > 0;
@@ -519,15 +714,17 @@ static bool MoveStepperBlockingSigned(int signed_steps, int step_delay_us, const
     s.stepper_moving            = true;
     s.stepper_target            = s.stepper_position + signed_steps;
   });
+  StepPositionPublisher publisher;
   for (int i = 0; i < steps; ++i) {
-    if (CopyState().stepper_abort) {
+    if (StepperAbortRequested()) {
       ESP_LOGW(kTag, "%s offset aborted after %d/%d steps", log_context, i, steps);
       return false;
     }
-    StepperPulseOnce();
-    UpdateState([&](SharedState& s) { s.stepper_position += forward ? 1 : -1; });
+    StepperPulseOnce(forward ? 1 : -1);
+    publisher.Step(forward ? 1 : -1);
     esp_rom_delay_us(step_delay_us);
   }
+  publisher.Flush();
   UpdateState([](SharedState& s) { s.stepper_moving = false; });
   return true;
 }
@@ -536,6 +733,7 @@ static StepperHomeResult HomeStepperToUserZeroBlocking(bool enable_motor, const
   StepperHomeResult result{};
   if (enable_motor) EnableStepper();
 
+  SetStepperAbort(false);
   UpdateState([](SharedState& s) {
     s.stepper_abort       = false;
     s.homing              = true;
@@ -544,10 +742,11 @@ static StepperHomeResult HomeStepperToUserZeroBlocking(bool enable_motor, const
     s.stepper_home_status = "seeking_hall";
   });
 
-  const int step_delay_us     = std::max(CopyState().stepper_speed_us, 1);
+  const int step_delay_us     = std::max(ReadMotionState().stepper_speed_us, 1);
   const uint32_t start_active_edges = HallActiveEdgeCount();
   const uint32_t start_total_edges = HallEdgeCount();
   uint32_t last_logged_edges = start_total_edges;
+  HallEdgeCursor edge_cursor = HallEdgesOpenCursor();
   RefreshHallDebugState();
   ESP_LOGI(kTag,
            "%s start: raw=%d active=%d triggered=%s speed_us=%d active_edges=%u total_edges=%u",
@@ -559,14 +758,15 @@ static StepperHomeResult HomeStepperToUserZeroBlocking(bool enable_motor, const
   gpio_set_level(STEPPER_DIR, kHomeFwd ? 1 : 0);
   UpdateState([](SharedState& s) { s.stepper_direction_forward = kHomeFwd; });
 
+  StepPositionPublisher publisher;
   while (!IsHallTriggered() && HallActiveEdgeCount() == start_active_edges && result.hall_steps < kMaxSteps) {
-    if (CopyState().stepper_abort) {
+    if (StepperAbortRequested()) {
       ESP_LOGW(kTag, "%s aborted before Hall after %d steps", log_context, result.hall_steps);
       result.aborted = true;
       break;
     }
-    StepperPulseOnce();
-    UpdateState([](SharedState& s) { s.stepper_position += kHomeFwd ? 1 : -1; });
+    StepperPulseOnce(kHomeFwd ? 1 : -1);
+    publisher.Step(kHomeFwd ? 1 : -1);
     esp_rom_delay_us(step_delay_us);
     result.hall_steps++;
     const uint32_t current_edges = HallEdgeCount();
@@ -578,6 +778,8 @@ static StepperHomeResult HomeStepperToUserZeroBlocking(bool enable_motor, const
                static_cast<unsigned>(HallActiveEdgeCount()), static_cast<unsigned>(current_edges));
     }
   }
+  // Must land before the Hall zeroing below resets the position.
+  publisher.Flush();
 
   if (!result.aborted) {
     const bool found_by_level = IsHallTriggered();
@@ -591,17 +793,26 @@ static StepperHomeResult HomeStepperToUserZeroBlocking(bool enable_motor, const
                static_cast<unsigned>(start_total_edges), static_cast<unsigned>(HallEdgeCount()));
     } else {
       result.hall_found = true;
-      ESP_LOGI(kTag, "%s Hall found by %s after %d steps: raw=%d active_edges=%u->%u",
-               log_context, found_by_level ? "level" : "edge", result.hall_steps,
+      // Zero is the step at which the active edge fired, not where the loop noticed it, so
+      // the home position does not depend on polling latency or step speed.
+      int overshoot = 0;
+      HallEdge edge{};
+      while (HallEdgesRead(&edge_cursor, &edge)) {
+        if (edge.level != app_config.motor_hall_active_level) continue;
+        overshoot = StepperStepCount() - edge.step;
+        break;
+      }
+      ESP_LOGI(kTag, "%s Hall found by %s after %d steps (overshoot %d): raw=%d active_edges=%u->%u",
+               log_context, found_by_level ? "level" : "edge", result.hall_steps, overshoot,
                gpio_get_level(MT_HALL_SEN), static_cast<unsigned>(start_active_edges),
                static_cast<unsigned>(HallActiveEdgeCount()));
-      UpdateState([](SharedState& s) {
+      UpdateState([&](SharedState& s) {
         s.stepper_home_status = "hall_found";
         s.stepper_homed       = true;
-        s.stepper_position    = 0;
-        s.stepper_target      = 0;
+        s.stepper_position    = overshoot;
+        s.stepper_target      = overshoot;
       });
-      const int offset = app_config.stepper_home_offset_steps;
+      const int offset = app_config.stepper_home_offset_steps - overshoot;
       if (offset != 0) {
         UpdateState([](SharedState& s) { s.stepper_home_status = "applying_offset"; });
         const bool ok = MoveStepperBlockingSigned(offset, step_delay_us, log_context);
@@ -618,11 +829,16 @@ static StepperHomeResult HomeStepperToUserZeroBlocking(bool enable_motor, const
         }
       } else {
         result.offset_done = true;
-        UpdateState([](SharedState& s) { s.stepper_home_status = "at_user_zero"; });
+        UpdateState([](SharedState& s) {
+          s.stepper_home_status = "at_user_zero";
+          s.stepper_position    = 0;
+          s.stepper_target      = 0;
+        });
       }
     }
   }
 
+  if (result.aborted) SetStepperAbort(true);
   UpdateState([&](SharedState& s) {
     s.homing         = false;
     s.stepper_moving = false;
@@ -664,13 +880,14 @@ bool StartFindZeroTask(std::string* out_message) {
     if (out_message) *out_message = "homing already running";
     return false;
   }
+  SetStepperAbort(false);
   UpdateState([](SharedState& s) {
     s.stepper_abort       = false;
     s.stepper_home_status = "running";
     s.stepper_homed       = false;
     s.homing              = true;
   });
-  // 8192: homing does printf-heavy logging + nested std::function state updates + offset
+  // 8192: homing does printf-heavy logging + nested state updates + offset
   // moves; 4096 overflowed right after Hall detection once edge-latch debug logs were added.
   xTaskCreatePinnedToCore(&FindZeroTask, "find_zero", 8192, nullptr, 4, &find_zero_task, 1);
   if (out_message) *out_message = "homing_started";
@@ -679,6 +896,107 @@ bool StartFindZeroTask(std::string* out_message) {
 
 // ---------- Logging helpers ----------
 
+// Clipped-mean accumulators for one averaging window. ~5 KB, so allocated once (PSRAM first)
+// instead of living on the log task stack.
+struct LogWindowAccumulators {
+  std::array<ClippedMean<128>, ADC_CHANNEL_COUNT> adc;
+  ClippedMean<64> bus_v, bus_i, bus_p;
+  std::array<ClippedMean<32>, MAX_TEMP_SENSORS> temps;
+
+  void Reset() {
+    for (auto& a : adc) a.Reset();
+    bus_v.Reset();
+    bus_i.Reset();
+    bus_p.Reset();
+    for (auto& t : temps) t.Reset();
+  }
+};
+
+// Per-row robustness report: ADC channels in full, temperatures and INA219 as totals.
+struct LogWindowStats {
+  std::array<ClipStats, ADC_CHANNEL_COUNT> adc;
+  uint32_t temp_rejected = 0;
+  uint32_t bus_rejected  = 0;
+  // Readings the sensor hub's filter replaced or held during the window (new cycles only).
+  uint32_t temp_flagged  = 0;
+  std::array<uint8_t, MAX_TEMP_SENSORS> temp_flags{};  // OR of kTempFlag* per sensor
+  uint32_t settle_ms     = 0;  // wait after the preceding move
+  bool settle_timed_out  = false;
+};
+
+static LogWindowAccumulators* s_log_window = nullptr;
+
+static LogWindowAccumulators* LogWindow() {
+  if (s_log_window) return s_log_window;
+  void* mem = heap_caps_malloc(sizeof(LogWindowAccumulators), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!mem) mem = heap_caps_malloc(sizeof(LogWindowAccumulators), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!mem) {
+    ESP_LOGE(kTag, "Logging window accumulators allocation failed");
+    return nullptr;
+  }
+  s_log_window = new (mem) LogWindowAccumulators();
+  return s_log_window;
+}
+
+static void AppendAdcClipCsvFields(FILE* file, const std::array<ClipStats, ADC_CHANNEL_COUNT>& stats) {
+  if (!file) return;
+  for (const ClipStats& st : stats) {
+    fprintf(file, ",%.3e,%u,%u,%u", st.stddev, static_cast<unsigned>(st.accepted),
+            static_cast<unsigned>(st.rejected), static_cast<unsigned>(st.quality));
+  }
+}
+
+static cJSON* AdcClipStatsJson(const std::array<ClipStats, ADC_CHANNEL_COUNT>& stats) {
+  cJSON* arr = cJSON_CreateArray();
+  for (const ClipStats& st : stats) {
+    cJSON* entry = cJSON_CreateObject();
+    cJSON_AddNumberToObject(entry, "mean", st.mean);
+    cJSON_AddNumberToObject(entry, "std", st.stddev);
+    cJSON_AddNumberToObject(entry, "accepted", st.accepted);
+    cJSON_AddNumberToObject(entry, "rejected", st.rejected);
+    cJSON_AddStringToObject(entry, "quality", ClipQualityName(st.quality));
+    cJSON_AddItemToArray(arr, entry);
+  }
+  return arr;
+}
+
+// Brightness temperatures of one row from the stored radiometer calibrations, NAN where no
+// calibration applies. Both positions use the base window's temperature of each radiometer's
+// bound sensor, matched by the addresses captured with that window, as the backend does for
+// a row.
+struct RowBrightness {
+  std::array<float, ADC_CHANNEL_COUNT> tb;
+  std::array<float, ADC_CHANNEL_COUNT> tb_cal;  // motor mode only
+};
+
+static RowBrightness ComputeRowBrightness(const SharedState& base, const SharedState* cal) {
+  const RadiometerCalibrationTable cals = app_config.brightness_cals;  // one snapshot per row
+  RowBrightness out;
+  out.tb.fill(NAN);
+  out.tb_cal.fill(NAN);
+  if (cals.empty()) return out;
+  const std::array<float, ADC_CHANNEL_COUNT> sensor_temps =
+      RadiometerSensorTemps(base.temp_addresses, base.temps_c, base.temp_sensor_count);
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    out.tb[ch] = cals.Brightness(ch, base.voltage[ch], sensor_temps[ch]);
+    if (cal) out.tb_cal[ch] = cals.Brightness(ch, cal->voltage[ch], sensor_temps[ch]);
+  }
+  return out;
+}
+
+static void AppendBrightnessCsvFields(FILE* file, const std::array<float, ADC_CHANNEL_COUNT>& tb) {
+  if (!file) return;
+  for (float t : tb) {
+    if (std::isfinite(t)) fprintf(file, ",%.3f", t);
+    else fputc(',', file);
+  }
+}
+
+static void AppendAdcCsvFields(FILE* file, const std::array<float, ADC_CHANNEL_COUNT>& volts) {
+  if (!file) return;
+  for (float v : volts) fprintf(file, ",%.6f", v);
+}
+
 static void AppendGpsCsvFields(FILE* file, const GpsPositionSnapshot& gps) {
   if (!file) return;
   if (gps.valid) {
@@ -691,15 +1009,17 @@ static void AppendGpsCsvFields(FILE* file, const GpsPositionSnapshot& gps) {
 }
 
 static void PublishLogMeasurement(const std::string& iso, uint64_t ts_ms, const SharedState& base,
-                                  const SharedState* cal, UtcTimeSource time_source,
-                                  const GpsPositionSnapshot& gps) {
+                                  const LogWindowStats& base_stats, const SharedState* cal,
+                                  const LogWindowStats* cal_stats, const RowBrightness& brightness,
+                                  UtcTimeSource time_source, const GpsPositionSnapshot& gps) {
   cJSON* root = cJSON_CreateObject();
   cJSON_AddStringToObject(root, "timestampIso", iso.c_str());
   cJSON_AddNumberToObject(root, "timestampMs", static_cast<double>(ts_ms));
   cJSON_AddStringToObject(root, "timeSource", UtcTimeSourceName(time_source));
-  cJSON_AddNumberToObject(root, "adc1", base.voltage1);
-  cJSON_AddNumberToObject(root, "adc2", base.voltage2);
-  cJSON_AddNumberToObject(root, "adc3", base.voltage3);
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    const std::string key = "adc" + std::to_string(ch + 1);
+    cJSON_AddNumberToObject(root, key.c_str(), base.voltage[ch]);
+  }
   cJSON* temps    = cJSON_CreateArray();
   cJSON* temp_obj = cJSON_CreateObject();
   for (int i = 0; i < base.temp_sensor_count && i < MAX_TEMP_SENSORS; ++i) {
@@ -709,6 +1029,7 @@ static void PublishLogMeasurement(const std::string& iso, uint64_t ts_ms, const
     cJSON_AddNumberToObject(entry, "value", base.temps_c[i]);
     cJSON_AddStringToObject(entry, "address", base.temp_addresses[i].c_str());
     cJSON_AddStringToObject(entry, "label", key.c_str());
+    cJSON_AddNumberToObject(entry, "flags", base_stats.temp_flags[i]);
     cJSON_AddItemToObject(temp_obj, key.c_str(), entry);
   }
   cJSON_AddItemToObject(root, "temps", temps);
@@ -718,14 +1039,33 @@ static void PublishLogMeasurement(const std::string& iso, uint64_t ts_ms, const
   cJSON_AddNumberToObject(root, "busP", base.ina_power);
   cJSON_AddBoolToObject(root, "logUseMotor", log_config.use_motor);
   cJSON_AddNumberToObject(root, "logDuration", log_config.duration_s);
-  SharedState cur = CopyState();
-  if (!cur.log_filename.empty()) {
-    cJSON_AddStringToObject(root, "logFilename", cur.log_filename.c_str());
+  const StorageState storage = ReadStorageState();
+  if (!storage.log_filename.empty()) {
+    cJSON_AddStringToObject(root, "logFilename", storage.log_filename.c_str());
   }
   if (cal) {
-    cJSON_AddNumberToObject(root, "adc1Cal", cal->voltage1);
-    cJSON_AddNumberToObject(root, "adc2Cal", cal->voltage2);
-    cJSON_AddNumberToObject(root, "adc3Cal", cal->voltage3);
+    for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+      const std::string key = "adc" + std::to_string(ch + 1) + "Cal";
+      cJSON_AddNumberToObject(root, key.c_str(), cal->voltage[ch]);
+    }
+  }
+  // Only channels with a calibration; the backend keeps computing the rest.
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    const std::string key = "brightnessTemp" + std::to_string(ch + 1);
+    if (std::isfinite(brightness.tb[ch])) cJSON_AddNumberToObject(root, key.c_str(), brightness.tb[ch]);
+    if (cal && std::isfinite(brightness.tb_cal[ch])) {
+      cJSON_AddNumberToObject(root, (key + "Cal").c_str(), brightness.tb_cal[ch]);
+    }
+  }
+  cJSON_AddItemToObject(root, "adcStats", AdcClipStatsJson(base_stats.adc));
+  if (cal_stats) cJSON_AddItemToObject(root, "adcCalStats", AdcClipStatsJson(cal_stats->adc));
+  cJSON_AddNumberToObject(root, "tempsRejected", base_stats.temp_rejected);
+  cJSON_AddNumberToObject(root, "busRejected", base_stats.bus_rejected);
+  cJSON_AddNumberToObject(root, "tempsFlagged", base_stats.temp_flagged);
+  if (cal_stats) {
+    cJSON_AddNumberToObject(root, "settleMs", base_stats.settle_ms);
+    cJSON_AddNumberToObject(root, "settleCalMs", cal_stats->settle_ms);
+    cJSON_AddBoolToObject(root, "settleTimedOut", base_stats.settle_timed_out || cal_stats->settle_timed_out);
   }
   // GPS fields
   cJSON_AddBoolToObject(root, "gpsPositionValid", gps.valid);
@@ -740,30 +1080,31 @@ static void PublishLogMeasurement(const std::string& iso, uint64_t ts_ms, const
   // Meteo snapshot (cached in state.meteo, refreshed by the wn90lp task). Attach only
   // when the station is online; skip NaN fields so the backend stores them as NULL.
   // meteoTimestampMs is the station reading's own time, used for dedup / FK linking.
-  if (cur.meteo.online) {
+  const MeteoData meteo_now = ReadMeteoState();
+  if (meteo_now.online) {
     cJSON* meteo = cJSON_CreateObject();
     bool meteo_ok = meteo != nullptr;
     if (meteo_ok) meteo_ok = cJSON_AddBoolToObject(meteo, "online", true) != nullptr;
     if (meteo_ok) {
       meteo_ok = cJSON_AddNumberToObject(
-          meteo, "timestampMs", static_cast<double>(cur.meteo.timestamp_ms)) != nullptr;
+          meteo, "timestampMs", static_cast<double>(meteo_now.timestamp_ms)) != nullptr;
     }
     auto add_if = [&](const char* key, float v) {
       if (meteo_ok && !std::isnan(v)) {
         meteo_ok = cJSON_AddNumberToObject(meteo, key, v) != nullptr;
       }
     };
-    add_if("tempC",       cur.meteo.temp_c);
-    add_if("humidityPct", cur.meteo.humidity_pct);
-    add_if("windSpeedMs", cur.meteo.wind_speed_ms);
-    add_if("gustSpeedMs", cur.meteo.gust_speed_ms);
-    if (meteo_ok && cur.meteo.wind_dir_deg >= 0) {
-      meteo_ok = cJSON_AddNumberToObject(meteo, "windDirDeg", cur.meteo.wind_dir_deg) != nullptr;
+    add_if("tempC",       meteo_now.temp_c);
+    add_if("humidityPct", meteo_now.humidity_pct);
+    add_if("windSpeedMs", meteo_now.wind_speed_ms);
+    add_if("gustSpeedMs", meteo_now.gust_speed_ms);
+    if (meteo_ok && meteo_now.wind_dir_deg >= 0) {
+      meteo_ok = cJSON_AddNumberToObject(meteo, "windDirDeg", meteo_now.wind_dir_deg) != nullptr;
     }
-    add_if("pressureHpa", cur.meteo.pressure_hpa);
-    add_if("rainfallMm",  cur.meteo.rainfall_mm);
-    add_if("lightLux",    cur.meteo.light_lux);
-    add_if("uvi",         cur.meteo.uvi);
+    add_if("pressureHpa", meteo_now.pressure_hpa);
+    add_if("rainfallMm",  meteo_now.rainfall_mm);
+    add_if("lightLux",    meteo_now.light_lux);
+    add_if("uvi",         meteo_now.uvi);
     if (!meteo_ok || !cJSON_AddItemToObject(root, "meteo", meteo)) {
       cJSON_Delete(meteo);  // root owns the subtree only after a successful add
     }
@@ -789,6 +1130,7 @@ void StopLogging() {
     }
   }
   UnmountLogSd();
+  SetStepperAbort(true);
   UpdateState([](SharedState& s) {
     s.logging        = false;
     s.log_filename.clear();
@@ -811,7 +1153,8 @@ void StopLogging() {
 
 static void LoggingTask(void*) {
   constexpr int kGpsPositionTimeoutMs  = 1500;
-  const TickType_t settle_delay        = pdMS_TO_TICKS(1000);
+  constexpr size_t kSettleBins         = 8;     // settle fit resolution, span / 8 per bin
+  constexpr float kSettleSpanS         = 0.2f;  // settle fit covers at least this much signal
   constexpr UBaseType_t kLogStackLow   = 512;
 
   auto home_blocking = [&]() {
@@ -820,6 +1163,7 @@ static void LoggingTask(void*) {
 
   auto move_blocking = [&](int steps, bool forward) -> bool {
     int done = 0;
+    SetStepperAbort(false);
     UpdateState([&](SharedState& s) {
       s.homing                    = true;
       s.stepper_abort             = false;
@@ -829,64 +1173,177 @@ static void LoggingTask(void*) {
     });
     EnableStepper();
     gpio_set_level(STEPPER_DIR, forward ? 1 : 0);
-    const int step_delay_us = std::max(CopyState().stepper_speed_us, 1);
-    for (int i = 0; i < steps; ++i) {
-      if (CopyState().stepper_abort) {
-        ESP_LOGW(kTag, "Logging move aborted after %d/%d steps", i, steps);
-        break;
+    const int step_delay_us = std::max(ReadMotionState().stepper_speed_us, 1);
+    {
+      StepPositionPublisher publisher;
+      for (int i = 0; i < steps; ++i) {
+        if (StepperAbortRequested()) {
+          ESP_LOGW(kTag, "Logging move aborted after %d/%d steps", i, steps);
+          break;
+        }
+        StepperPulseOnce(forward ? 1 : -1);
+        esp_rom_delay_us(step_delay_us);
+        publisher.Step(forward ? 1 : -1);
+        done++;
       }
-      gpio_set_level(STEPPER_STEP, 1);
-      esp_rom_delay_us(4);
-      gpio_set_level(STEPPER_STEP, 0);
-      esp_rom_delay_us(step_delay_us);
-      done++;
     }
     UpdateState([&](SharedState& s) {
       s.homing         = false;
       s.stepper_moving = false;
-      s.stepper_position += forward ? done : -done;
-      s.stepper_target   = s.stepper_position;
+      s.stepper_target = s.stepper_position;
     });
-    return done == steps && !CopyState().stepper_abort;
+    return done == steps && !StepperAbortRequested();
+  };
+
+  // Waits after a move until the ADC stream has settled (see SettleWindow), from
+  // logging_settle_min_ms up to logging_settle_max_ms. Returns the time waited.
+  auto wait_settled = [&](bool* timed_out) -> uint32_t {
+    const int64_t t0_us  = esp_timer_get_time();
+    const int64_t min_us = std::max(app_config.logging_settle_min_ms, 0) * 1000LL;
+    const int64_t max_us = std::max<int64_t>(std::max(app_config.logging_settle_max_ms, 0) * 1000LL, min_us);
+    const float max_slope = app_config.logging_settle_slope_uv_s * 1e-6f;
+    const float max_std   = app_config.logging_settle_std_uv * 1e-6f;
+    *timed_out = false;
+    if (max_slope <= 0.0f || max_std <= 0.0f) {
+      vTaskDelay(pdMS_TO_TICKS(max_us / 1000));
+      return static_cast<uint32_t>((esp_timer_get_time() - t0_us) / 1000);
+    }
+    std::array<SettleWindow<kSettleBins>, ADC_CHANNEL_COUNT> windows;
+    windows.fill(SettleWindow<kSettleBins>(kSettleSpanS));
+    uint32_t seen_mask = 0;
+    AdcSampleCursor cursor = AdcSamplesOpenCursor();
+    AdcSample sample{};
+    while (true) {
+      const int64_t left_us = max_us - (esp_timer_get_time() - t0_us);
+      if (left_us <= 0) {
+        *timed_out = true;
+        break;
+      }
+      const TickType_t wait = std::max<TickType_t>(1, pdMS_TO_TICKS((left_us + 999) / 1000));
+      if (!AdcSamplesRead(&cursor, &sample, wait)) continue;
+      for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+        if (!(sample.valid_mask & (1u << ch))) continue;
+        seen_mask |= 1u << ch;
+        windows[ch].Push(static_cast<float>(sample.timestamp_us - t0_us) * 1e-6f,
+                         AdcCodeToVolts(sample.raw[ch]));
+      }
+      if (seen_mask == 0 || esp_timer_get_time() - t0_us < min_us) continue;
+      bool settled = true;
+      for (int ch = 0; ch < ADC_CHANNEL_COUNT && settled; ++ch) {
+        if (seen_mask & (1u << ch)) settled = windows[ch].Settled(max_slope, max_std);
+      }
+      if (settled) break;
+    }
+    return static_cast<uint32_t>((esp_timer_get_time() - t0_us) / 1000);
   };
 
-  auto collect_avg = [&](float duration_s, int temp_count, SharedState* out) -> bool {
-    if (!out) return false;
+  // Sigma-clipped means over the window (see ClippedMean): a glitch frame or a bad 1-Wire read
+  // is dropped instead of biasing the row, and `stats` reports what was dropped. The sensor
+  // addresses are taken with the first temperatures; a slot that changes sensor mid-window
+  // keeps only the readings of the sensor it started with.
+  auto collect_avg = [&](float duration_s, int temp_count, SharedState* out,
+                         LogWindowStats* stats) -> bool {
+    if (!out || !stats) return false;
+    LogWindowAccumulators* acc = LogWindow();
+    if (!acc) return false;
+    acc->Reset();
+    temp_count = std::min(temp_count, MAX_TEMP_SENSORS);
     const TickType_t interval   = pdMS_TO_TICKS(200);
     const uint64_t duration_ms  = static_cast<uint64_t>(duration_s * 1000.0f);
     const uint64_t start        = esp_timer_get_time() / 1000ULL;
+    // ADC voltages and INA219 readings average every sample in the window exactly once (from
+    // the sample rings); temperatures are still sampled at `interval`.
+    AdcSampleCursor cursor = AdcSamplesOpenCursor();
+    InaSampleCursor ina_cursor = InaSamplesOpenCursor();
+    const AdcState offsets = ReadAdcState();
     int samples = 0;
-    double sv1 = 0, sv2 = 0, sv3 = 0;
-    std::array<double, MAX_TEMP_SENSORS> temp_sum{};
-    double s_bus_v = 0, s_bus_i = 0, s_bus_p = 0;
+    int adc_samples = 0;
+    uint32_t temp_cycle = ReadThermalState().temp_cycle;
+    bool have_addresses = false;
+    uint32_t temp_flagged = 0;
+    std::array<uint8_t, MAX_TEMP_SENSORS> temp_flags{};
+    InaSample ina{};
+    auto add_conversion = [&](const AdcSample& sample) {
+      for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+        // Channels that failed soft read back raw=0; leave them out instead of averaging zeros.
+        if (!(sample.valid_mask & (1u << ch))) continue;
+        acc->adc[ch].Push(AdcCodeToVolts(sample.raw[ch]) - offsets.offset[ch]);
+      }
+      adc_samples++;
+    };
+    AdcSample sample{};
     while ((esp_timer_get_time() / 1000ULL - start) < duration_ms) {
-      SharedState snap = CopyState();
-      if (log_config.use_motor && (snap.stepper_moving || snap.homing)) {
+      const MotionState motion = ReadMotionState();
+      if (log_config.use_motor && (motion.stepper_moving || motion.homing)) {
         ESP_LOGW(kTag, "Logging: stepper moved during averaging, discarding samples");
         return false;
       }
-      sv1 += snap.voltage1; sv2 += snap.voltage2; sv3 += snap.voltage3;
-      for (int i = 0; i < temp_count && i < MAX_TEMP_SENSORS; ++i) temp_sum[i] += snap.temps_c[i];
-      s_bus_v += snap.ina_bus_voltage;
-      s_bus_i += snap.ina_current;
-      s_bus_p += snap.ina_power;
+      while (AdcSamplesRead(&cursor, &sample, 0)) add_conversion(sample);
+      while (InaSamplesRead(&ina_cursor, &ina, 0)) {
+        acc->bus_v.Push(ina.bus_v);
+        acc->bus_i.Push(ina.current_a);
+        acc->bus_p.Push(ina.power_w);
+      }
+      const ThermalState thermal = ReadThermalState();
+      if (!have_addresses) {
+        out->temp_addresses = thermal.temp_addresses;
+        out->temp_labels    = thermal.temp_labels;
+        have_addresses      = true;
+      }
+      for (int i = 0; i < temp_count; ++i) {
+        if (thermal.temp_addresses[i] != out->temp_addresses[i].c_str()) continue;
+        if (std::isfinite(thermal.temps_c[i])) acc->temps[i].Push(thermal.temps_c[i]);
+      }
+      if (thermal.temp_cycle != temp_cycle) {
+        temp_cycle = thermal.temp_cycle;
+        for (int i = 0; i < temp_count; ++i) {
+          temp_flags[i] |= thermal.temp_flags[i];
+          if (thermal.temp_flags[i] & (kTempFlagRejected | kTempFlagHeld)) ++temp_flagged;
+        }
+      }
       samples++;
       vTaskDelay(interval);
     }
-    if (samples == 0) return false;
-    out->voltage1        = sv1 / samples;
-    out->voltage2        = sv2 / samples;
-    out->voltage3        = sv3 / samples;
-    out->ina_bus_voltage = s_bus_v / samples;
-    out->ina_current     = s_bus_i / samples;
-    out->ina_power       = s_bus_p / samples;
+    // Windows shorter than one conversion still need one.
+    if (adc_samples == 0 && AdcSamplesRead(&cursor, &sample, pdMS_TO_TICKS(1000))) add_conversion(sample);
+    if (cursor.lost > 0) {
+      ESP_LOGW(kTag, "Logging: %u ADC conversions overwritten before averaging", static_cast<unsigned>(cursor.lost));
+    }
+    if (samples == 0 || adc_samples == 0) return false;
+    *stats = LogWindowStats{};
+    stats->temp_flagged = temp_flagged;
+    stats->temp_flags   = temp_flags;
+    for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+      stats->adc[ch] = acc->adc[ch].Finish();
+      out->voltage[ch] = stats->adc[ch].mean;
+    }
+    if (acc->bus_v.samples() > 0) {
+      const ClipStats v = acc->bus_v.Finish(kInaBusVoltageLsb);
+      const ClipStats i = acc->bus_i.Finish(kInaCurrentLsb);
+      const ClipStats p = acc->bus_p.Finish(kInaPowerLsb);
+      out->ina_bus_voltage = v.mean;
+      out->ina_current     = i.mean;
+      out->ina_power       = p.mean;
+      stats->bus_rejected  = v.rejected + i.rejected + p.rejected;
+    } else {
+      // No INA219 (or it is failing): keep the last state values, as before.
+      const AdcState adc = ReadAdcState();
+      out->ina_bus_voltage = adc.ina_bus_voltage;
+      out->ina_current     = adc.ina_current;
+      out->ina_power       = adc.ina_power;
+    }
     out->temp_sensor_count = temp_count;
-    for (int i = 0; i < temp_count && i < MAX_TEMP_SENSORS; ++i)
-      out->temps_c[i] = static_cast<float>(temp_sum[i] / samples);
+    for (int i = 0; i < temp_count; ++i) {
+      const ClipStats t = acc->temps[i].Finish(kM1820LsbCelsius);
+      // A sensor that failed the whole window is reported as NAN, as the state does.
+      out->temps_c[i] = t.quality == ClipQuality::kEmpty ? NAN : t.mean;
+      stats->temp_rejected += t.rejected;
+    }
     return true;
   };
 
   SharedState pending_base{};
+  LogWindowStats pending_base_stats;
   bool has_pending_base  = false;
   bool at_zero           = true;
   int  pending_steps     = 0;
@@ -913,8 +1370,7 @@ static void LoggingTask(void*) {
       ErrorManagerClear(ErrorCode::kLogTaskStack);
     }
 
-    SharedState current = CopyState();
-    if (!current.logging || !log_file) {
+    if (!ReadStorageState().logging || !log_file) {
       StopLogging();
       vTaskDelete(nullptr);
     }
@@ -932,13 +1388,18 @@ static void LoggingTask(void*) {
 
     if (log_config.use_motor) {
       if (at_zero) {
-        vTaskDelay(settle_delay);
+        bool settle_timed_out = false;
+        const uint32_t settle_ms = wait_settled(&settle_timed_out);
         SharedState avg{};
-        if (!collect_avg(log_config.duration_s, log_config.temp_sensor_count, &avg)) {
+        LogWindowStats avg_stats;
+        if (!collect_avg(log_config.duration_s, log_config.temp_sensor_count, &avg, &avg_stats)) {
           vTaskDelay(pdMS_TO_TICKS(500));
           continue;
         }
+        avg_stats.settle_ms        = settle_ms;
+        avg_stats.settle_timed_out = settle_timed_out;
         pending_base   = avg;
+        pending_base_stats = avg_stats;
         has_pending_base = true;
         pending_steps  = std::clamp(app_config.logging_motor_steps, 1, 20000);
         if (!move_blocking(pending_steps, true)) {
@@ -950,12 +1411,16 @@ static void LoggingTask(void*) {
         continue;
       }
 
-      vTaskDelay(settle_delay);
+      bool settle_timed_out = false;
+      const uint32_t settle_ms = wait_settled(&settle_timed_out);
       SharedState avg{};
-      if (!collect_avg(log_config.duration_s, log_config.temp_sensor_count, &avg)) {
+      LogWindowStats avg_stats;
+      if (!collect_avg(log_config.duration_s, log_config.temp_sensor_count, &avg, &avg_stats)) {
         vTaskDelay(pdMS_TO_TICKS(500));
         continue;
       }
+      avg_stats.settle_ms        = settle_ms;
+      avg_stats.settle_timed_out = settle_timed_out;
       if (has_pending_base) {
         GpsPositionSnapshot gps{};
         (void)RequestGpsPositionOnce(kGpsPositionTimeoutMs, &gps);
@@ -967,22 +1432,31 @@ static void LoggingTask(void*) {
         const UtcTimeSnapshot row_time = GetBestUtcTimeForData();
         const uint64_t ts_ms           = UtcTimeToUnixMs(row_time);
         const std::string iso          = FormatUtcIso(row_time);
-        fprintf(log_file, "%s,%llu,%.6f,%.6f,%.6f", iso.c_str(), (unsigned long long)ts_ms,
-                pending_base.voltage1, pending_base.voltage2, pending_base.voltage3);
+        fprintf(log_file, "%s,%llu", iso.c_str(), (unsigned long long)ts_ms);
+        AppendAdcCsvFields(log_file, pending_base.voltage);
         for (int i = 0; i < pending_base.temp_sensor_count && i < MAX_TEMP_SENSORS; ++i)
           fprintf(log_file, ",%.2f", pending_base.temps_c[i]);
         fprintf(log_file, ",%.3f,%.3f,%.3f", pending_base.ina_bus_voltage, pending_base.ina_current, pending_base.ina_power);
-        fprintf(log_file, ",%.6f,%.6f,%.6f", avg.voltage1, avg.voltage2, avg.voltage3);
+        AppendAdcCsvFields(log_file, avg.voltage);
         AppendGpsCsvFields(log_file, gps);
+        AppendAdcClipCsvFields(log_file, pending_base_stats.adc);
+        AppendAdcClipCsvFields(log_file, avg_stats.adc);
+        fprintf(log_file, ",%u,%u", static_cast<unsigned>(pending_base_stats.settle_ms),
+                static_cast<unsigned>(avg_stats.settle_ms));
+        fprintf(log_file, ",%u", static_cast<unsigned>(pending_base_stats.temp_flagged));
+        const RowBrightness brightness = ComputeRowBrightness(pending_base, &avg);
+        AppendBrightnessCsvFields(log_file, brightness.tb);
+        AppendBrightnessCsvFields(log_file, brightness.tb_cal);
         fprintf(log_file, "\n");
         FlushLogFile();
         ESP_LOGD(kTag, "Logging: wrote row ts=%llu iso=%s", (unsigned long long)ts_ms, iso.c_str());
-        PublishLogMeasurement(iso, ts_ms, pending_base, &avg, row_time.source, gps);
-        UpdateState([&](SharedState& s) {
-          s.voltage1_cal = avg.voltage1;
-          s.voltage2_cal = avg.voltage2;
-          s.voltage3_cal = avg.voltage3;
-        });
+        ESP_LOGI(kTag, "Logging: settled in %u ms (zero%s) / %u ms (load%s)",
+                 static_cast<unsigned>(pending_base_stats.settle_ms),
+                 pending_base_stats.settle_timed_out ? ", timeout" : "",
+                 static_cast<unsigned>(avg_stats.settle_ms), avg_stats.settle_timed_out ? ", timeout" : "");
+        PublishLogMeasurement(iso, ts_ms, pending_base, pending_base_stats, &avg, &avg_stats,
+                              brightness, row_time.source, gps);
+        UpdateState([&](SharedState& s) { s.voltage_cal = avg.voltage; });
       }
 
       if (app_config.logging_home_each_cycle) {
@@ -1019,7 +1493,8 @@ static void LoggingTask(void*) {
 
     // No motor — plain measurement
     SharedState avg1{};
-    if (!collect_avg(log_config.duration_s, log_config.temp_sensor_count, &avg1)) {
+    LogWindowStats avg1_stats;
+    if (!collect_avg(log_config.duration_s, log_config.temp_sensor_count, &avg1, &avg1_stats)) {
       vTaskDelay(pdMS_TO_TICKS(500));
       continue;
     }
@@ -1034,21 +1509,22 @@ static void LoggingTask(void*) {
     const UtcTimeSnapshot row_time = GetBestUtcTimeForData();
     const uint64_t ts_ms           = UtcTimeToUnixMs(row_time);
     const std::string iso          = FormatUtcIso(row_time);
-    fprintf(log_file, "%s,%llu,%.6f,%.6f,%.6f", iso.c_str(), (unsigned long long)ts_ms,
-            avg1.voltage1, avg1.voltage2, avg1.voltage3);
+    fprintf(log_file, "%s,%llu", iso.c_str(), (unsigned long long)ts_ms);
+    AppendAdcCsvFields(log_file, avg1.voltage);
     for (int i = 0; i < avg1.temp_sensor_count && i < MAX_TEMP_SENSORS; ++i)
       fprintf(log_file, ",%.2f", avg1.temps_c[i]);
     fprintf(log_file, ",%.3f,%.3f,%.3f", avg1.ina_bus_voltage, avg1.ina_current, avg1.ina_power);
     AppendGpsCsvFields(log_file, gps);
+    AppendAdcClipCsvFields(log_file, avg1_stats.adc);
+    fprintf(log_file, ",%u", static_cast<unsigned>(avg1_stats.temp_flagged));
+    const RowBrightness brightness = ComputeRowBrightness(avg1, nullptr);
+    AppendBrightnessCsvFields(log_file, brightness.tb);
     fprintf(log_file, "\n");
     FlushLogFile();
     ESP_LOGD(kTag, "Logging: wrote row ts=%llu iso=%s", (unsigned long long)ts_ms, iso.c_str());
-    PublishLogMeasurement(iso, ts_ms, avg1, nullptr, row_time.source, gps);
-    UpdateState([&](SharedState& s) {
-      s.voltage1_cal = avg1.voltage1;
-      s.voltage2_cal = avg1.voltage2;
-      s.voltage3_cal = avg1.voltage3;
-    });
+    PublishLogMeasurement(iso, ts_ms, avg1, avg1_stats, nullptr, nullptr, brightness, row_time.source,
+                          gps);
+    UpdateState([&](SharedState& s) { s.voltage_cal = avg1.voltage; });
   }
 }
 
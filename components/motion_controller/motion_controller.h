@@ -20,6 +20,25 @@ uint32_t HallLevel1EdgeCount();
 int HallLastRawLevel();
 void RefreshHallDebugState();
 
+// One Hall sensor edge, captured in the ISR.
+struct HallEdge {
+  int64_t timestamp_us;  // esp_timer time of the edge
+  int32_t step;          // StepperStepCount() at the edge
+  uint8_t level;         // sensor level after the edge
+};
+
+struct HallEdgeCursor {
+  uint32_t next_seq = 0;
+  uint32_t lost = 0;  // edges overwritten before this consumer read them
+};
+
+// Signed count of all step pulses issued since boot (forward +1, backward -1). Unlike
+// stepper_position it is never re-zeroed, so edge steps can be compared across homing.
+int32_t StepperStepCount();
+// Cursor positioned at the next edge; HallEdgesRead() returns false when caught up.
+HallEdgeCursor HallEdgesOpenCursor();
+bool HallEdgesRead(HallEdgeCursor* cursor, HallEdge* out);
+
 // External module power switch
 void SetExternalPower(bool enabled);
 bool CycleExternalPower(uint32_t off_ms);
@@ -32,6 +32,7 @@
 static constexpr char kTag[] = "NET";
 
 #include "sensor_hub.h"
+#include "spi_arbiter.h"
 
 // ---------- module constants ----------
 
@@ -121,18 +122,9 @@ static void EnsureNetifInit() {
 }
 
 static void ReadNetworkUpFlags(bool* wifi_up, bool* eth_up) {
-  bool wifi = false;
-  bool eth = false;
-  if (state_mutex && xSemaphoreTake(state_mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-    wifi = !state.wifi_ip_sta.empty();
-    eth = state.eth_ip_up || !state.eth_ip.empty();
-    xSemaphoreGive(state_mutex);
-  } else {
-    wifi = !state.wifi_ip_sta.empty();
-    eth = state.eth_ip_up || !state.eth_ip.empty();
-  }
-  if (wifi_up) *wifi_up = wifi;
-  if (eth_up)  *eth_up  = eth;
+  const NetState net = ReadNetState();
+  if (wifi_up) *wifi_up = !net.wifi_ip_sta.empty();
+  if (eth_up)  *eth_up  = net.eth_ip_up || !net.eth_ip.empty();
 }
 
 static bool AnyNetworkHasIp() {
@@ -242,7 +234,7 @@ static void NetworkMonitorTask(void*) {
   const int interval_ms      = 15000;
   const int check_timeout_ms = 1500;
   while (true) {
-    UpdateState([](SharedState& s) {
+    UpdateState(StateGroupBit(StateGroup::kStorageStats), [](SharedState& s) {
       s.heap_free_bytes = static_cast<uint32_t>(heap_caps_get_free_size(MALLOC_CAP_8BIT));
       s.heap_min_free_bytes = static_cast<uint32_t>(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
       s.heap_largest_free_block_bytes = static_cast<uint32_t>(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
@@ -334,6 +326,66 @@ void EthEventHandler(void* arg, esp_event_base_t event_base, int32_t event_id, v
   }
 }
 
+#if CONFIG_ETH_SPI_ETHERNET_W5500
+// W5500 register access through the SPI arbiter, so Ethernet transactions are accounted
+// for and kept out of the LTC2440 windows on the shared bus. Same framing as the stock
+// driver: 16-bit address phase, 8-bit control phase, polling transfers.
+static constexpr TickType_t kEthSpiTimeout = pdMS_TO_TICKS(50);
+static spi_device_handle_t  s_eth_spi_dev  = nullptr;
+
+static uint32_t EthSpiHoldEstimateUs(uint32_t len) {
+  return static_cast<uint32_t>((uint64_t{len} + 3) * 8 * 1'000'000 / ETH_SPI_FREQ_HZ) + 20;
+}
+
+static void* EthSpiInit(const void* config) {
+  spi_device_interface_config_t devcfg = *static_cast<const spi_device_interface_config_t*>(config);
+  devcfg.command_bits = 16;
+  devcfg.address_bits = 8;
+  if (spi_bus_add_device(SPI2_HOST, &devcfg, &s_eth_spi_dev) != ESP_OK) return nullptr;
+  return &s_eth_spi_dev;
+}
+
+static esp_err_t EthSpiDeinit(void* ctx) {
+  auto* dev = static_cast<spi_device_handle_t*>(ctx);
+  esp_err_t ret = spi_bus_remove_device(*dev);
+  *dev = nullptr;
+  return ret;
+}
+
+static esp_err_t EthSpiTransfer(spi_device_handle_t dev, spi_transaction_t* trans, uint32_t len) {
+  esp_err_t ret = SpiArbiterAcquire(SpiClient::kEthernet, dev, EthSpiHoldEstimateUs(len),
+                                    kEthSpiTimeout);
+  if (ret != ESP_OK) return ret;
+  ret = spi_device_polling_transmit(dev, trans);
+  SpiArbiterRelease(SpiClient::kEthernet, dev);
+  return ret == ESP_OK ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t EthSpiRead(void* ctx, uint32_t cmd, uint32_t addr, void* data, uint32_t len) {
+  spi_transaction_t trans = {};
+  trans.cmd    = static_cast<uint16_t>(cmd);
+  trans.addr   = addr;
+  trans.length = 8 * len;
+  if (len <= 4) {
+    trans.flags = SPI_TRANS_USE_RXDATA;
+  } else {
+    trans.rx_buffer = data;
+  }
+  esp_err_t ret = EthSpiTransfer(*static_cast<spi_device_handle_t*>(ctx), &trans, len);
+  if (ret == ESP_OK && len <= 4) memcpy(data, trans.rx_data, len);
+  return ret;
+}
+
+static esp_err_t EthSpiWrite(void* ctx, uint32_t cmd, uint32_t addr, const void* data, uint32_t len) {
+  spi_transaction_t trans = {};
+  trans.cmd       = static_cast<uint16_t>(cmd);
+  trans.addr      = addr;
+  trans.length    = 8 * len;
+  trans.tx_buffer = data;
+  return EthSpiTransfer(*static_cast<spi_device_handle_t*>(ctx), &trans, len);
+}
+#endif
+
 static esp_err_t InitEthernet() {
 #if !CONFIG_ETH_SPI_ETHERNET_W5500
   ESP_LOGE(kTag, "W5500 support not enabled in sdkconfig");
@@ -364,6 +416,11 @@ static esp_err_t InitEthernet() {
   eth_w5500_config_t w5500_config = ETH_W5500_DEFAULT_CONFIG(SPI2_HOST, &s_eth_devcfg);
   w5500_config.int_gpio_num  = ETH_INT;
   w5500_config.poll_period_ms = 0;
+  w5500_config.custom_spi_driver.config = &s_eth_devcfg;
+  w5500_config.custom_spi_driver.init   = EthSpiInit;
+  w5500_config.custom_spi_driver.deinit = EthSpiDeinit;
+  w5500_config.custom_spi_driver.read   = EthSpiRead;
+  w5500_config.custom_spi_driver.write  = EthSpiWrite;
 
   s_eth_mac = esp_eth_mac_new_w5500(&w5500_config, &mac_config);
   s_eth_phy = esp_eth_phy_new_w5500(&phy_config);
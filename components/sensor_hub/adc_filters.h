@@ -0,0 +1,410 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+// Streaming filter stages for the LTC2440 sample stream. Header-only and free of ESP-IDF so
+// the same kernels build on the host, where tests/firmware checks and benchmarks them.
+//
+// Every stage exposes `bool Push(x, float* y)`: it consumes one input and returns true when
+// it produced an output. Decimating stages return true once per decimation period; a
+// rejecting stage returns false for samples it drops. Reset() returns a stage to its
+// power-on state. Arithmetic stays in integers or single precision because the ESP32-S3
+// FPU has no double support.
+
+// Order-N CIC (Hogenauer) decimator over raw integer codes. Integrators and combs use
+// unsigned 64-bit wrap-around arithmetic, which is exact while the input width plus
+// Order * log2(Decimation) fits in 64 bits. The output is normalised by the DC gain, and
+// the first Order outputs (comb start-up transient) are suppressed.
+template <int Order, uint32_t Decimation>
+class CicDecimator {
+  static_assert(Order >= 1 && Order <= 6, "CIC order must be 1..6");
+  static_assert(Decimation >= 1, "CIC decimation must be >= 1");
+
+  static constexpr uint64_t Gain() {
+    uint64_t gain = 1;
+    for (int i = 0; i < Order; ++i) gain *= Decimation;
+    return gain;
+  }
+  static constexpr int BitGrowth() {
+    int bits = 0;
+    while ((uint64_t{1} << bits) < Gain()) ++bits;
+    return bits;
+  }
+  static_assert(32 + BitGrowth() <= 64, "CIC register would overflow 64 bits");
+
+ public:
+  bool Push(int32_t x, float* y) {
+    uint64_t acc = static_cast<uint64_t>(static_cast<int64_t>(x));
+    for (int i = 0; i < Order; ++i) {
+      integ_[i] += acc;
+      acc = integ_[i];
+    }
+    if (++phase_ < Decimation) return false;
+    phase_ = 0;
+    for (int i = 0; i < Order; ++i) {
+      const uint64_t delayed = comb_[i];
+      comb_[i] = acc;
+      acc -= delayed;
+    }
+    if (warmup_ < Order) {
+      ++warmup_;
+      return false;
+    }
+    *y = static_cast<float>(static_cast<int64_t>(acc)) * kInvGain;
+    return true;
+  }
+
+  void Reset() { *this = CicDecimator(); }
+
+  static constexpr uint32_t decimation() { return Decimation; }
+
+ private:
+  static constexpr float kInvGain = 1.0f / static_cast<float>(Gain());
+
+  std::array<uint64_t, Order> integ_{};
+  std::array<uint64_t, Order> comb_{};
+  uint32_t phase_ = 0;
+  int warmup_ = 0;
+};
+
+// Block mean with a decimation factor chosen at run time (for example from the current OSR).
+// Integer inputs are summed exactly in 64 bits; float inputs in single precision as offsets
+// from the block's first float input, so code-sized values keep their low digits.
+class BoxcarDecimator {
+ public:
+  explicit BoxcarDecimator(uint32_t decimation = 1) { SetDecimation(decimation); }
+
+  // Changing the factor drops the partially filled block.
+  void SetDecimation(uint32_t decimation) {
+    decimation_ = decimation > 0 ? decimation : 1;
+    Reset();
+  }
+  uint32_t decimation() const { return decimation_; }
+
+  bool Push(int32_t x, float* y) {
+    isum_ += x;
+    return Emit(y);
+  }
+  bool Push(float x, float* y) {
+    if (fcount_++ == 0) fref_ = x;
+    fsum_ += x - fref_;
+    return Emit(y);
+  }
+
+  void Reset() {
+    isum_ = 0;
+    fsum_ = 0.0f;
+    fref_ = 0.0f;
+    fcount_ = 0;
+    count_ = 0;
+  }
+
+ private:
+  bool Emit(float* y) {
+    if (++count_ < decimation_) return false;
+    const float n = static_cast<float>(count_);
+    *y = (static_cast<float>(isum_) + fsum_) / n + fref_ * (static_cast<float>(fcount_) / n);
+    Reset();
+    return true;
+  }
+
+  uint32_t decimation_ = 1;
+  int64_t isum_ = 0;
+  float fsum_ = 0.0f;
+  float fref_ = 0.0f;
+  uint32_t fcount_ = 0;
+  uint32_t count_ = 0;
+};
+
+// N-point moving average, one output per input (the mean of what is available until the
+// window fills). The running sum is rebuilt once per window so float drift stays bounded.
+template <size_t N>
+class Boxcar {
+  static_assert(N >= 1, "Boxcar length must be >= 1");
+
+ public:
+  bool Push(float x, float* y) {
+    sum_ += x - window_[pos_];
+    window_[pos_] = x;
+    if (++pos_ == N) {
+      pos_ = 0;
+      sum_ = 0.0f;
+      for (float v : window_) sum_ += v;
+    }
+    if (filled_ < N) ++filled_;
+    *y = sum_ / static_cast<float>(filled_);
+    return true;
+  }
+
+  void Reset() { *this = Boxcar(); }
+
+ private:
+  std::array<float, N> window_{};
+  float sum_ = 0.0f;
+  size_t pos_ = 0;
+  size_t filled_ = 0;
+};
+
+// N-tap FIR with optional integer decimation; the dot product is only evaluated for the
+// samples that are output. The delay line is stored twice so each output reads one
+// contiguous span.
+template <size_t N, uint32_t Decimation = 1>
+class FirFilter {
+  static_assert(N >= 1, "FIR needs at least one tap");
+  static_assert(Decimation >= 1, "FIR decimation must be >= 1");
+
+ public:
+  // Defaults to an N-point boxcar.
+  FirFilter() { taps_.fill(1.0f / static_cast<float>(N)); }
+  explicit FirFilter(const std::array<float, N>& taps) : taps_(taps) {}
+
+  bool Push(float x, float* y) {
+    pos_ = (pos_ == 0) ? N - 1 : pos_ - 1;
+    line_[pos_] = x;
+    line_[pos_ + N] = x;
+    if (++phase_ < Decimation) return false;
+    phase_ = 0;
+    // line_[pos_ + k] is x[n - k].
+    float acc = 0.0f;
+    for (size_t k = 0; k < N; ++k) acc += taps_[k] * line_[pos_ + k];
+    *y = acc;
+    return true;
+  }
+
+  void Reset() {
+    line_.fill(0.0f);
+    pos_ = 0;
+    phase_ = 0;
+  }
+
+  const std::array<float, N>& taps() const { return taps_; }
+
+ private:
+  std::array<float, N> taps_{};
+  std::array<float, 2 * N> line_{};
+  size_t pos_ = 0;
+  uint32_t phase_ = 0;
+};
+
+// Median of the last N inputs (N odd), one output per input. Keeps a sorted copy of the
+// window, so each push is O(N); meant for short windows that knock out single-frame glitches.
+template <size_t N>
+class RunningMedian {
+  static_assert(N >= 1 && (N % 2) == 1, "median window must be odd");
+
+ public:
+  bool Push(float x, float* y) {
+    if (filled_ == N) {
+      // Drop the oldest value from the sorted copy.
+      const float old = window_[pos_];
+      float* it = std::lower_bound(sorted_.begin(), sorted_.begin() + filled_, old);
+      std::copy(it + 1, sorted_.begin() + filled_, it);
+      --filled_;
+    }
+    window_[pos_] = x;
+    pos_ = (pos_ + 1) % N;
+    float* at = std::upper_bound(sorted_.begin(), sorted_.begin() + filled_, x);
+    std::copy_backward(at, sorted_.begin() + filled_, sorted_.begin() + filled_ + 1);
+    *at = x;
+    ++filled_;
+    *y = (filled_ % 2) ? sorted_[filled_ / 2]
+                       : 0.5f * (sorted_[filled_ / 2 - 1] + sorted_[filled_ / 2]);
+    return true;
+  }
+
+  void Reset() { *this = RunningMedian(); }
+
+ private:
+  std::array<float, N> window_{};
+  std::array<float, N> sorted_{};
+  size_t pos_ = 0;
+  size_t filled_ = 0;
+};
+
+// Drops samples further than k standard deviations from the mean of the last N accepted
+// samples. Judging starts once half the window is filled; after N consecutive rejections
+// the window is restarted so a genuine step is followed rather than rejected forever. The
+// window holds offsets from the first sample accepted into it, so a microvolt spread on a
+// volt-level DC does not vanish in the float rounding of sumsq / n - mean^2.
+template <size_t N>
+class SigmaClip {
+  static_assert(N >= 4, "sigma-clip window must be >= 4");
+
+ public:
+  explicit SigmaClip(float k = 3.0f) : k_(k) {}
+
+  bool Push(float x, float* y) {
+    if (filled_ >= N / 2) {
+      const float n = static_cast<float>(filled_);
+      const float mean = sum_ / n;
+      const float var = std::max(sumsq_ / n - mean * mean, 0.0f);
+      const float dev = (x - ref_) - mean;
+      if (dev * dev > k_ * k_ * var && var > 0.0f) {
+        ++rejected_;
+        if (++streak_ < N) return false;
+        Restart();
+      }
+    }
+    streak_ = 0;
+    Accept(x);
+    ++accepted_;
+    *y = x;
+    return true;
+  }
+
+  void Reset() { *this = SigmaClip(k_); }
+
+  uint32_t accepted() const { return accepted_; }
+  uint32_t rejected() const { return rejected_; }
+
+ private:
+  void Restart() {
+    window_.fill(0.0f);
+    sum_ = sumsq_ = 0.0f;
+    pos_ = filled_ = 0;
+  }
+
+  void Accept(float x) {
+    if (filled_ == 0 && pos_ == 0) ref_ = x;
+    x -= ref_;
+    if (filled_ == N) {
+      const float old = window_[pos_];
+      sum_ -= old;
+      sumsq_ -= old * old;
+    } else {
+      ++filled_;
+    }
+    window_[pos_] = x;
+    sum_ += x;
+    sumsq_ += x * x;
+    if (++pos_ == N) {
+      pos_ = 0;
+      // Rebuild once per window to keep float drift bounded.
+      sum_ = sumsq_ = 0.0f;
+      for (size_t i = 0; i < filled_; ++i) {
+        sum_ += window_[i];
+        sumsq_ += window_[i] * window_[i];
+      }
+    }
+  }
+
+  float k_;
+  float ref_ = 0.0f;
+  std::array<float, N> window_{};  // offsets from ref_
+  float sum_ = 0.0f;
+  float sumsq_ = 0.0f;
+  size_t pos_ = 0;
+  size_t filled_ = 0;
+  size_t streak_ = 0;
+  uint32_t accepted_ = 0;
+  uint32_t rejected_ = 0;
+};
+
+// Hampel identifier: a sample further than k robust sigmas (1.4826 * MAD of the last N
+// samples, floored at min_sigma) from their median is rejected. Push() then returns false but
+// still writes the median to *y, so a consumer that needs a value every time can take it. The
+// window keeps rejected samples too, so a genuine step is followed once it fills half the
+// window. Judging starts at min_count samples. With k = 3.5 and N = 9 this is the test the
+// backend's services/temp_outliers.py applies, run causally.
+template <size_t N>
+class HampelFilter {
+  static_assert(N >= 3, "Hampel window must be >= 3");
+
+ public:
+  explicit HampelFilter(float k = 3.5f, float min_sigma = 0.0f, size_t min_count = 5)
+      : k_(k), min_sigma_(min_sigma), min_count_(std::clamp<size_t>(min_count, 2, N)) {}
+
+  bool Push(float x, float* y) {
+    bool ok = true;
+    float out = x;
+    if (filled_ >= min_count_) {
+      std::array<float, N> tmp;
+      std::copy(window_.begin(), window_.begin() + filled_, tmp.begin());
+      const float med = Median(tmp.data(), filled_);
+      for (size_t i = 0; i < filled_; ++i) tmp[i] = std::fabs(tmp[i] - med);
+      const float sigma = std::max(1.4826f * Median(tmp.data(), filled_), min_sigma_);
+      if (std::fabs(x - med) > k_ * sigma) {
+        ok = false;
+        out = med;
+      }
+    }
+    window_[pos_] = x;
+    pos_ = (pos_ + 1) % N;
+    if (filled_ < N) ++filled_;
+    if (ok) {
+      ++accepted_;
+    } else {
+      ++rejected_;
+    }
+    *y = out;
+    return ok;
+  }
+
+  void Reset() { *this = HampelFilter(k_, min_sigma_, min_count_); }
+
+  uint32_t accepted() const { return accepted_; }
+  uint32_t rejected() const { return rejected_; }
+
+ private:
+  static float Median(float* v, size_t n) {
+    float* mid = v + n / 2;
+    std::nth_element(v, mid, v + n);
+    if (n % 2) return *mid;
+    return 0.5f * (*std::max_element(v, mid) + *mid);
+  }
+
+  float k_;
+  float min_sigma_;
+  size_t min_count_;
+  std::array<float, N> window_{};
+  size_t pos_ = 0;
+  size_t filled_ = 0;
+  uint32_t accepted_ = 0;
+  uint32_t rejected_ = 0;
+};
+
+// Stages run left to right; a stage that produces no output ends the push. The first stage
+// sees the raw input type (int32_t codes or float), later stages see float.
+template <typename... Stages>
+class FilterChain {
+  static_assert(sizeof...(Stages) >= 1, "FilterChain needs at least one stage");
+
+ public:
+  FilterChain() = default;
+  explicit FilterChain(Stages... stages) : stages_(std::move(stages)...) {}
+
+  template <typename In>
+  bool Push(In x, float* y) {
+    return PushFrom<0>(x, y);
+  }
+
+  void Reset() {
+    std::apply([](auto&... stage) { (stage.Reset(), ...); }, stages_);
+  }
+
+  template <size_t I>
+  auto& stage() {
+    return std::get<I>(stages_);
+  }
+
+ private:
+  template <size_t I, typename In>
+  bool PushFrom(In x, float* y) {
+    float out = 0.0f;
+    if (!std::get<I>(stages_).Push(x, &out)) return false;
+    if constexpr (I + 1 == sizeof...(Stages)) {
+      *y = out;
+      return true;
+    } else {
+      return PushFrom<I + 1>(out, y);
+    }
+  }
+
+  std::tuple<Stages...> stages_;
+};
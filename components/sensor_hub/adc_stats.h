@@ -0,0 +1,515 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Incremental per-channel statistics for the LTC2440 sample stream. Header-only and free of
+// ESP-IDF so tests/firmware can check it against brute-force estimators on the host.
+
+// Welford running mean/variance plus extrema in double. Every double operation is a library
+// call on the ESP32-S3, so per-sample paths use IntegerStats or CompensatedSum instead; this
+// stays as the reference they are tested against.
+class RunningStats {
+ public:
+  void Push(double x) {
+    ++count_;
+    const double delta = x - mean_;
+    mean_ += delta / static_cast<double>(count_);
+    m2_ += delta * (x - mean_);
+    min_ = std::min(min_, x);
+    max_ = std::max(max_, x);
+  }
+
+  void Reset() { *this = RunningStats(); }
+
+  uint32_t count() const { return count_; }
+  double mean() const { return mean_; }
+  // Sample (n-1) variance; 0 until there are two samples.
+  double variance() const { return count_ > 1 ? m2_ / static_cast<double>(count_ - 1) : 0.0; }
+  double stddev() const { return std::sqrt(variance()); }
+  double min() const { return count_ ? min_ : 0.0; }
+  double max() const { return count_ ? max_ : 0.0; }
+
+ private:
+  uint32_t count_ = 0;
+  double mean_ = 0.0;
+  double m2_ = 0.0;
+  double min_ = std::numeric_limits<double>::infinity();
+  double max_ = -std::numeric_limits<double>::infinity();
+};
+
+// Running mean/variance plus extrema of integer samples (LTC2440 codes, microsecond timings)
+// with no floating point per sample. Deviations from the first sample of each block are
+// summed exactly in int64; every kBlock samples the block is merged into double moments
+// (Chan et al.), so the double work is amortized over the block. Deviations are clamped to
+// +-2^25 inside a block, which keeps the sum of squares below 2^62.
+class IntegerStats {
+ public:
+  static constexpr uint32_t kBlock = 4096;
+
+  void Push(int32_t x) {
+    if (block_n_ == 0) block_ref_ = x;
+    const int64_t d = std::clamp<int64_t>(int64_t{x} - block_ref_, -kMaxDeviation, kMaxDeviation);
+    block_sum_ += d;
+    block_sq_ += d * d;
+    min_ = std::min(min_, x);
+    max_ = std::max(max_, x);
+    if (++block_n_ == kBlock) {
+      Merge(&n_, &mean_, &m2_);
+      block_n_ = 0;
+      block_sum_ = 0;
+      block_sq_ = 0;
+    }
+  }
+
+  void Reset() { *this = IntegerStats(); }
+
+  uint32_t count() const { return n_ + block_n_; }
+  double mean() const {
+    uint32_t n = n_;
+    double mean = mean_, m2 = m2_;
+    Merge(&n, &mean, &m2);
+    return mean;
+  }
+  // Sample (n-1) variance; 0 until there are two samples.
+  double variance() const {
+    uint32_t n = n_;
+    double mean = mean_, m2 = m2_;
+    Merge(&n, &mean, &m2);
+    return n > 1 ? m2 / static_cast<double>(n - 1) : 0.0;
+  }
+  double stddev() const { return std::sqrt(variance()); }
+  double min() const { return count() ? static_cast<double>(min_) : 0.0; }
+  double max() const { return count() ? static_cast<double>(max_) : 0.0; }
+
+ private:
+  static constexpr int64_t kMaxDeviation = int64_t{1} << 25;
+
+  // Folds the open block into (n, mean, m2).
+  void Merge(uint32_t* n, double* mean, double* m2) const {
+    if (block_n_ == 0) return;
+    const double nb = static_cast<double>(block_n_);
+    const double sum = static_cast<double>(block_sum_);
+    const double mean_b = static_cast<double>(block_ref_) + sum / nb;
+    const double m2_b = std::max(0.0, static_cast<double>(block_sq_) - sum * sum / nb);
+    const double na = static_cast<double>(*n);
+    const double total = na + nb;
+    const double delta = mean_b - *mean;
+    *mean += delta * nb / total;
+    *m2 += m2_b + delta * delta * na * nb / total;
+    *n += block_n_;
+  }
+
+  uint32_t n_ = 0;  // merged samples
+  double mean_ = 0.0;
+  double m2_ = 0.0;
+  int32_t block_ref_ = 0;
+  uint32_t block_n_ = 0;
+  int64_t block_sum_ = 0;
+  int64_t block_sq_ = 0;
+  int32_t min_ = std::numeric_limits<int32_t>::max();
+  int32_t max_ = std::numeric_limits<int32_t>::min();
+};
+
+// Neumaier-compensated float sum: the rounding error stays at a few ulp of the result however
+// many terms are added, at four float adds per term instead of soft-float double.
+class CompensatedSum {
+ public:
+  void Add(float x) {
+    const float t = sum_ + x;
+    if (std::fabs(sum_) >= std::fabs(x)) {
+      comp_ += (sum_ - t) + x;
+    } else {
+      comp_ += (x - t) + sum_;
+    }
+    sum_ = t;
+  }
+
+  void Reset() {
+    sum_ = 0.0f;
+    comp_ = 0.0f;
+  }
+
+  float value() const { return sum_ + comp_; }
+
+ private:
+  float sum_ = 0.0f;
+  float comp_ = 0.0f;
+};
+
+// Fully overlapping Allan variance at averaging factors m = 1, 2, 4 ... 2^(Levels-1), updated
+// as each sample arrives. With x_j the running sum of the first j codes, the newest sample
+// closes one term per level:
+//
+//   AVAR(m) = sum (x_j - 2 x_{j-m} + x_{j-2m})^2 / (2 m^2 * terms)
+//
+// The running sums are exact int64. The squared second differences are accumulated in float
+// (the ESP32-S3 FPU is single precision) and flushed into a double every kFlushTerms terms.
+// Storage for the sum history is supplied by the owner so it can live in PSRAM.
+template <int Levels>
+class AllanAccumulator {
+  static_assert(Levels >= 1 && Levels <= 20, "Allan levels must be 1..20");
+
+ public:
+  // Sums needed to span the widest term: x_j back to x_{j - 2^Levels}.
+  static constexpr size_t kHistory = size_t{2} << Levels;
+  static constexpr int kLevels = Levels;
+
+  // `storage` must hold kHistory values. Not thread-safe; call before Push().
+  bool Attach(int64_t* storage) {
+    if (!storage) return false;
+    history_ = storage;
+    Reset();
+    return true;
+  }
+
+  bool ready() const { return history_ != nullptr; }
+
+  void Reset() {
+    for (int k = 0; k < Levels; ++k) {
+      sum_sq_[k] = 0.0;
+      partial_[k] = 0.0f;
+      terms_[k] = 0;
+    }
+    phase_ = 0;
+    count_ = 0;
+    if (history_) history_[0] = 0;
+  }
+
+  void Push(int32_t code) {
+    if (!history_) return;
+    phase_ += code;
+    ++count_;
+    history_[count_ & kMask] = phase_;
+    for (int k = 0; k < Levels; ++k) {
+      const uint64_t m = uint64_t{1} << k;
+      if (count_ < 2 * m) break;
+      const int64_t d =
+          phase_ - 2 * history_[(count_ - m) & kMask] + history_[(count_ - 2 * m) & kMask];
+      const float df = static_cast<float>(d);
+      partial_[k] += df * df;
+      if ((++terms_[k] % kFlushTerms) == 0) {
+        sum_sq_[k] += partial_[k];
+        partial_[k] = 0.0f;
+      }
+    }
+  }
+
+  uint64_t samples() const { return count_; }
+  uint32_t terms(int level) const { return level >= 0 && level < Levels ? terms_[level] : 0; }
+
+  // Allan deviation at m = 2^level samples, in code units; 0 until the level has a term.
+  double deviation(int level) const {
+    if (level < 0 || level >= Levels || terms_[level] == 0) return 0.0;
+    const double m = static_cast<double>(uint64_t{1} << level);
+    const double sum = sum_sq_[level] + static_cast<double>(partial_[level]);
+    return std::sqrt(sum / (2.0 * m * m * static_cast<double>(terms_[level])));
+  }
+
+ private:
+  static constexpr uint64_t kMask = kHistory - 1;
+  static constexpr uint32_t kFlushTerms = 1024;
+
+  int64_t* history_ = nullptr;
+  int64_t phase_ = 0;
+  uint64_t count_ = 0;
+  double sum_sq_[Levels] = {};
+  float partial_[Levels] = {};
+  uint32_t terms_[Levels] = {};
+};
+
+// ---------- clipped mean ----------
+
+// kGood: under 5 % rejected. kClipped: some rejected, the mean is still trustworthy.
+// kPoor: over 25 % rejected or fewer than 3 samples to judge by. kEmpty: nothing pushed.
+enum class ClipQuality : uint8_t { kGood = 0, kClipped = 1, kPoor = 2, kEmpty = 3 };
+
+struct ClipStats {
+  float mean = 0.0f;
+  float stddev = 0.0f;     // per-sample, over the accepted samples
+  uint32_t accepted = 0;
+  uint32_t rejected = 0;
+  ClipQuality quality = ClipQuality::kEmpty;
+};
+
+inline const char* ClipQualityName(ClipQuality q) {
+  switch (q) {
+    case ClipQuality::kGood:    return "good";
+    case ClipQuality::kClipped: return "clipped";
+    case ClipQuality::kPoor:    return "poor";
+    case ClipQuality::kEmpty:   return "empty";
+  }
+  return "?";
+}
+
+// Streaming sigma-clipped mean over one averaging window, in fixed storage. Samples are kept
+// as float offsets from the first one. When all Capacity entries are used, neighbouring
+// entries are merged pairwise and each entry from then on holds a block of 2, 4 ... samples,
+// so in long windows the clip works on block means. A glitch diluted into a large block shifts the window mean
+// exactly as little as it shifts the block, so nothing is lost where clipping matters.
+//
+// Finish() clips around the median with a MAD scale (k = 3 by default), re-centres on the
+// survivors and repeats until nothing more is rejected. It reorders the entries; Reset()
+// before the next window.
+template <size_t Capacity>
+class ClippedMean {
+  static_assert(Capacity >= 4 && Capacity % 2 == 0, "ClippedMean capacity must be even, >= 4");
+
+ public:
+  void Reset() {
+    ref_ = 0.0f;
+    block_ = 1;
+    count_ = 0;
+    samples_ = 0;
+    pending_sum_.Reset();
+    pending_n_ = 0;
+  }
+
+  void Push(float x) {
+    if (samples_ == 0) ref_ = x;
+    // Compact before a new block starts filling, so every block holds block_ samples.
+    if (pending_n_ == 0 && count_ == Capacity) Compact();
+    ++samples_;
+    pending_sum_.Add(x - ref_);
+    if (++pending_n_ < block_) return;
+    entries_[count_++] = pending_sum_.value() / static_cast<float>(block_);
+    pending_sum_.Reset();
+    pending_n_ = 0;
+  }
+
+  uint32_t samples() const { return samples_; }
+
+  // `resolution` floors the clip scale so a quantized input (1-Wire LSB, INA219 LSB) is not
+  // clipped for sitting one step away from a median it mostly equals.
+  ClipStats Finish(float resolution = 0.0f, float k = 3.0f, int max_iter = 5) {
+    ClipStats out;
+    if (samples_ == 0) return out;
+
+    size_t n = count_;
+    float shift = 0.0f;  // subtracted from every entry so far
+    float scale = 0.0f;
+    for (int iter = 0; iter < max_iter && n >= 3; ++iter) {
+      const float center = Median(n, [](float a, float b) { return a < b; });
+      for (size_t i = 0; i < n; ++i) entries_[i] -= center;
+      shift += center;
+      scale = 1.4826f * Median(n, [](float a, float b) { return std::fabs(a) < std::fabs(b); },
+                               true);
+      if (scale <= 0.0f) {
+        float abs_sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) abs_sum += std::fabs(entries_[i]);
+        scale = 1.2533f * abs_sum / static_cast<float>(n);
+      }
+      const float limit = k * std::max(scale, resolution);
+      float* kept_end = std::partition(entries_, entries_ + n,
+                                       [limit](float e) { return std::fabs(e) <= limit; });
+      const size_t kept = static_cast<size_t>(kept_end - entries_);
+      if (kept == n) break;
+      n = kept;
+    }
+
+    // The partial block at the end is judged against the final clip, widened for its smaller
+    // sample count.
+    const uint32_t block_n = static_cast<uint32_t>(n) * block_;
+    bool pending_ok = false;
+    float pending_mean = 0.0f;
+    if (pending_n_ > 0) {
+      pending_mean = pending_sum_.value() / static_cast<float>(pending_n_) - shift;
+      const float pending_scale =
+          scale * std::sqrt(static_cast<float>(block_) / static_cast<float>(pending_n_));
+      pending_ok = count_ < 3 || std::fabs(pending_mean) <= k * std::max(pending_scale, resolution);
+    }
+
+    CompensatedSum sum;
+    for (size_t i = 0; i < n; ++i) sum.Add(entries_[i] * static_cast<float>(block_));
+    if (pending_ok) sum.Add(pending_mean * static_cast<float>(pending_n_));
+    out.accepted = block_n + (pending_ok ? pending_n_ : 0);
+    out.rejected = samples_ - out.accepted;
+    if (out.accepted == 0) {
+      out.quality = ClipQuality::kPoor;
+      return out;
+    }
+    const float local_mean = sum.value() / static_cast<float>(out.accepted);
+    out.mean = ref_ + shift + local_mean;
+
+    // Spread of block means scaled back to a per-sample deviation (exact for white noise).
+    if (n > 1) {
+      float ss = 0.0f;
+      for (size_t i = 0; i < n; ++i) {
+        const float d = entries_[i] - local_mean;
+        ss += d * d;
+      }
+      out.stddev = std::sqrt(ss * static_cast<float>(block_) / static_cast<float>(n - 1));
+    }
+
+    const float rejected_frac = static_cast<float>(out.rejected) / static_cast<float>(samples_);
+    if (n < 3 || rejected_frac > 0.25f) {
+      out.quality = ClipQuality::kPoor;
+    } else if (rejected_frac > 0.05f) {
+      out.quality = ClipQuality::kClipped;
+    } else {
+      out.quality = ClipQuality::kGood;
+    }
+    return out;
+  }
+
+ private:
+  void Compact() {
+    for (size_t i = 0; i < Capacity / 2; ++i) {
+      entries_[i] = 0.5f * (entries_[2 * i] + entries_[2 * i + 1]);
+    }
+    count_ = Capacity / 2;
+    block_ *= 2;
+  }
+
+  // Median of entries_[0, n) under `less`, partially reordering them. With `magnitude` the
+  // result is the median absolute value.
+  template <typename Less>
+  float Median(size_t n, Less less, bool magnitude = false) {
+    float* mid = entries_ + n / 2;
+    std::nth_element(entries_, mid, entries_ + n, less);
+    const float hi = magnitude ? std::fabs(*mid) : *mid;
+    if (n % 2 != 0) return hi;
+    const float lo_raw = *std::max_element(entries_, mid, less);
+    const float lo = magnitude ? std::fabs(lo_raw) : lo_raw;
+    return 0.5f * (lo + hi);
+  }
+
+  float ref_ = 0.0f;
+  uint32_t block_ = 1;
+  size_t count_ = 0;
+  uint32_t samples_ = 0;
+  CompensatedSum pending_sum_;
+  uint32_t pending_n_ = 0;
+  float entries_[Capacity] = {};
+};
+
+// ---------- settle window ----------
+
+// Least-squares line through the last `span_s` seconds of one channel, used after a stepper
+// move to decide that the signal has stopped moving: the slope is the remaining drift and
+// the residual spread the noise around it. The window is sized by time, not samples, so the
+// decision means the same at every OSR: samples are averaged into bins of span_s / Bins and
+// the fit runs over the newest bins that cover span_s with at least kMinPoints points. The
+// open bin takes part once it holds half as many samples as the last closed one. At slow OSR
+// each bin is one conversion, counted as soon as it arrives; at fast OSR a bin averages many,
+// so the thresholds apply to the signal averaged over span_s / Bins rather than to the raw
+// per-conversion noise. Times and values are kept relative to the first sample so float
+// keeps the microvolt digits.
+template <size_t Bins>
+class SettleWindow {
+  static_assert(Bins >= 4, "a settle fit needs at least 4 bins");
+
+ public:
+  static constexpr size_t kMinPoints = 4;
+
+  explicit SettleWindow(float span_s = 0.2f)
+      : span_(span_s > 0.0f ? span_s : 0.2f), width_(span_ / static_cast<float>(Bins)) {}
+
+  void Reset() {
+    started_ = false;
+    closed_ = 0;
+    head_ = 0;
+    open_ = Bin{};
+  }
+
+  void Push(float t_s, float v) {
+    if (!started_) {
+      started_ = true;
+      t0_ = t_s;
+      v0_ = v;
+    }
+    const float t = t_s - t0_;
+    if (open_.n > 0 && t >= open_.t_first + width_) {
+      bins_[head_] = open_;
+      head_ = (head_ + 1) % Bins;
+      if (closed_ < Bins) ++closed_;
+      open_ = Bin{};
+    }
+    if (open_.n == 0) open_.t_first = t;
+    open_.t_last = t;
+    open_.t_sum += t;
+    open_.v_sum += v - v0_;
+    ++open_.n;
+  }
+
+  // Slope in value units per second and residual standard deviation of the bin means about
+  // the line (n - 2 degrees of freedom). False until span_s is covered by kMinPoints bins, or
+  // if they all share one time.
+  bool Fit(float* slope, float* residual_std) const {
+    if (open_.n == 0) return false;
+    float t[Bins + 1], v[Bins + 1];
+    size_t n = 0;
+    float t_first = 0.0f, t_last = 0.0f;
+    auto add = [&](const Bin& b) {
+      if (n == 0) t_last = b.t_last;
+      t_first = b.t_first;
+      Mean(b, &t[n], &v[n]);
+      ++n;
+    };
+    if (closed_ == 0 || 2 * open_.n >= Newest().n) add(open_);
+    for (size_t k = 0; k < closed_; ++k) {
+      if (n >= kMinPoints && t_last - t_first + width_ >= span_) break;
+      add(bins_[(head_ + Bins - 1 - k) % Bins]);
+    }
+    if (n < kMinPoints || t_last - t_first + width_ < span_) return false;
+
+    float tm = 0.0f, vm = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+      tm += t[i];
+      vm += v[i];
+    }
+    tm /= static_cast<float>(n);
+    vm /= static_cast<float>(n);
+    float sxx = 0.0f, sxy = 0.0f, syy = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+      const float dt = t[i] - tm;
+      const float dv = v[i] - vm;
+      sxx += dt * dt;
+      sxy += dt * dv;
+      syy += dv * dv;
+    }
+    if (sxx <= 0.0f) return false;
+    const float b = sxy / sxx;
+    const float ss_res = std::max(0.0f, syy - b * sxy);
+    if (slope) *slope = b;
+    if (residual_std) *residual_std = std::sqrt(ss_res / static_cast<float>(n - 2));
+    return true;
+  }
+
+  // Settled once the covered span drifts at most `max_slope` per second with at most
+  // `max_std` residual noise.
+  bool Settled(float max_slope, float max_std) const {
+    float b = 0.0f, s = 0.0f;
+    return Fit(&b, &s) && std::fabs(b) <= max_slope && s <= max_std;
+  }
+
+ private:
+  struct Bin {
+    float t_first = 0.0f;
+    float t_last = 0.0f;
+    float t_sum = 0.0f;
+    float v_sum = 0.0f;
+    uint32_t n = 0;
+  };
+
+  const Bin& Newest() const { return bins_[(head_ + Bins - 1) % Bins]; }
+
+  static void Mean(const Bin& b, float* t, float* v) {
+    const float n = static_cast<float>(b.n);
+    *t = b.t_sum / n;
+    *v = b.v_sum / n;
+  }
+
+  float span_;
+  float width_;
+  bool started_ = false;
+  float t0_ = 0.0f;
+  float v0_ = 0.0f;
+  Bin bins_[Bins] = {};
+  size_t head_ = 0;
+  size_t closed_ = 0;
+  Bin open_;
+};
@@ -2,16 +2,63 @@
 
 #include <inttypes.h>
 
+#include <algorithm>
+
+#include "esp_check.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "driver/gpio.h"
+#include "spi_arbiter.h"
 
 namespace {
 constexpr char TAG[] = "LTC2440";
+
+// DRDY mode: open the CS-low window this long before the learned end of conversion, keep it
+// open at most kDrdyWindowUs, and give up after kDrdyMaxWindows late windows.
+constexpr int64_t kDrdyWindowLeadUs = 2'000;
+constexpr int64_t kDrdyWindowUs     = 5'000;
+constexpr int     kDrdyMaxWindows   = 3;
+
+// ReadPipelined(): a converter that misses this many windows in a row is left out of the
+// set, so an absent ADC stops costing a full DRDY wait every round, and probed again once
+// per kReprobeIntervalUs.
+constexpr uint8_t kDropAfterMissedWindows = 5;
+constexpr int64_t kReprobeIntervalUs      = 1'000'000;
+
+// Bus acquisition is bounded so a stuck Ethernet transfer cannot stall the acquisition scheduler indefinitely.
+constexpr TickType_t kBusAcquireTimeout = pdMS_TO_TICKS(100);
+
+// All converters share one SDO/MISO line and only the one holding the bus arms the
+// interrupt, so one waiter slot serves every instance. The ISR stores the edge time, then
+// clears the slot to hand it over; whoever clears the slot first owns the outcome.
+TaskHandle_t s_drdy_waiter = nullptr;
+volatile int64_t s_drdy_edge_us = 0;
+gpio_num_t s_drdy_isr_pin = GPIO_NUM_NC;
+
+void IRAM_ATTR DrdyIsr(void*) {
+  TaskHandle_t waiter = __atomic_load_n(&s_drdy_waiter, __ATOMIC_ACQUIRE);
+  if (!waiter) return;
+  s_drdy_edge_us = esp_timer_get_time();
+  if (!__atomic_compare_exchange_n(&s_drdy_waiter, &waiter, nullptr, false,
+                                   __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+    return;
+  }
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(waiter, &woken);
+  if (woken == pdTRUE) portYIELD_FROM_ISR();
+}
+
+TickType_t TicksCeil(int64_t us) {
+  const int64_t tick_us = 1000LL * portTICK_PERIOD_MS;
+  return static_cast<TickType_t>((us + tick_us - 1) / tick_us);
 }
+}  // namespace
 
 LTC2440::LTC2440(gpio_num_t chip_select_pin, gpio_num_t drdy_pin, bool log_errors)
-    : chip_select_pin_(chip_select_pin), drdy_pin_(drdy_pin), log_errors_(log_errors) {}
+    : chip_select_pin_(chip_select_pin),
+      drdy_pin_(drdy_pin),
+      log_errors_(log_errors),
+      conv_estimate_us_(kLtc2440SpeedModes[kLtc2440DefaultSpeedMode].conversion_us) {}
 
 esp_err_t LTC2440::Init(spi_host_device_t host, int clock_hz) {
   // Manual CS control so we can hold it low while monitoring DRDY on SDO.
@@ -65,22 +112,103 @@ esp_err_t LTC2440::WaitReady_(TickType_t timeout_ticks) {
   return ESP_OK;
 }
 
-esp_err_t LTC2440::ReadRaw_(int32_t* value) {
-  if (!initialized_) {
+esp_err_t LTC2440::EnableDrdyInterrupt() {
+  if (!initialized_) return ESP_ERR_INVALID_STATE;
+  if (drdy_pin_ == GPIO_NUM_NC) return ESP_ERR_NOT_SUPPORTED;
+  if (drdy_irq_) return ESP_OK;
+
+  if (s_drdy_isr_pin == GPIO_NUM_NC) {
+    // MISO toggles with every transfer on the bus, so the interrupt stays disabled except
+    // inside our own CS-low window.
+    ESP_RETURN_ON_ERROR(gpio_set_intr_type(drdy_pin_, GPIO_INTR_NEGEDGE), TAG, "DRDY intr type");
+    ESP_RETURN_ON_ERROR(gpio_isr_handler_add(drdy_pin_, DrdyIsr, nullptr), TAG, "DRDY isr add");
+    gpio_intr_disable(drdy_pin_);
+    s_drdy_isr_pin = drdy_pin_;
+  } else if (s_drdy_isr_pin != drdy_pin_) {
+    // One waiter slot only works for converters sharing a single DRDY line.
     return ESP_ERR_INVALID_STATE;
   }
-  // Enforce minimum conversion time before polling DRDY; LTC2440 full conversion
-  // can take up to ~150 ms depending on OSR. Guard with a fixed delay since we
-  // don't always trust DRDY on a shared MISO line.
+
+  if (!wake_timer_) {
+    esp_timer_create_args_t args = {};
+    args.callback        = &LTC2440::WakeTimerCallback;
+    args.arg             = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name            = "ltc2440";
+    ESP_RETURN_ON_ERROR(esp_timer_create(&args, &wake_timer_), TAG, "wake timer");
+  }
+  drdy_irq_ = true;
+  return ESP_OK;
+}
+
+void LTC2440::WakeTimerCallback(void* arg) {
+  auto* self = static_cast<LTC2440*>(arg);
+  TaskHandle_t task = self->wake_task_;
+  if (task) xTaskNotifyGive(task);
+}
+
+// Sleeps with microsecond resolution (tick sleeps are 10 ms here) once the wake timer exists.
+// Stray notifications only cause an extra loop iteration.
+void LTC2440::SleepUntil_(int64_t target_us) {
+  int64_t remaining = target_us - esp_timer_get_time();
+  if (remaining <= 0) return;
+  if (!wake_timer_) {
+    vTaskDelay(TicksCeil(remaining));
+    return;
+  }
+  wake_task_ = xTaskGetCurrentTaskHandle();
+  esp_timer_start_once(wake_timer_, static_cast<uint64_t>(remaining));
+  while ((remaining = target_us - esp_timer_get_time()) > 0) {
+    ulTaskNotifyTake(pdTRUE, TicksCeil(remaining) + 1);
+  }
+  esp_timer_stop(wake_timer_);
+}
+
+// Called with the bus held and CS low. Returns true once EOC is low; *edge_us is the edge
+// time, or 0 if the conversion had already finished when the window opened.
+bool LTC2440::WaitDrdyEdge_(int64_t deadline_us, int64_t* edge_us) {
+  *edge_us = 0;
+  ulTaskNotifyTake(pdTRUE, 0);
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  __atomic_store_n(&s_drdy_waiter, self, __ATOMIC_RELEASE);
+  gpio_intr_enable(drdy_pin_);
+
+  if (gpio_get_level(drdy_pin_) != 0) {
+    int64_t remaining = deadline_us - esp_timer_get_time();
+    if (remaining > 0) {
+      wake_task_ = self;
+      esp_timer_start_once(wake_timer_, static_cast<uint64_t>(remaining));
+    }
+    while (__atomic_load_n(&s_drdy_waiter, __ATOMIC_ACQUIRE) != nullptr &&
+           (remaining = deadline_us - esp_timer_get_time()) > 0) {
+      ulTaskNotifyTake(pdTRUE, TicksCeil(remaining) + 1);
+    }
+    esp_timer_stop(wake_timer_);
+  }
+
+  gpio_intr_disable(drdy_pin_);
+  const bool fired = __atomic_exchange_n(&s_drdy_waiter, nullptr, __ATOMIC_ACQ_REL) == nullptr;
+  if (fired) {
+    *edge_us = s_drdy_edge_us;
+    return true;
+  }
+  return gpio_get_level(drdy_pin_) == 0;
+}
+
+// Fallback pacing: fixed guard since the last read, then a short DRDY poll.
+esp_err_t LTC2440::AwaitReadyGuarded_() {
+  // Guard with a fixed delay since we don't always trust DRDY on a shared MISO line.
+  const int64_t guard_us = mode_().guard_us;
   const int64_t now_us = esp_timer_get_time();
   const int64_t since_last = now_us - last_conv_start_us_;
-  if (last_conv_start_us_ > 0 && since_last < 180'000) {
-    const int64_t wait_us = 180'000 - since_last;
+  if (last_conv_start_us_ > 0 && since_last < guard_us) {
+    const int64_t wait_us = guard_us - since_last;
     vTaskDelay(pdMS_TO_TICKS((wait_us + 999) / 1000));  // ceil to ms ticks
   }
 
   // Lock the bus while we manually drive CS for DRDY and the transfer.
-  esp_err_t lock = spi_device_acquire_bus(spi_handle_, portMAX_DELAY);
+  esp_err_t lock = SpiArbiterAcquire(SpiClient::kAdc, spi_handle_, kSpiAdcHoldBudgetUs,
+                                     kBusAcquireTimeout);
   if (lock != ESP_OK) {
     return lock;
   }
@@ -94,13 +222,70 @@ esp_err_t LTC2440::ReadRaw_(int32_t* value) {
   esp_err_t ready = WaitReady_(pdMS_TO_TICKS(3));
   if (ready != ESP_OK) {
     gpio_set_level(chip_select_pin_, 1);
-    spi_device_release_bus(spi_handle_);
+    SpiArbiterRelease(SpiClient::kAdc, spi_handle_);
     return ready;
   }
+  last_ready_us_ = esp_timer_get_time();
   // Give a short guard time after ready before clocking out bits.
   vTaskDelay(pdMS_TO_TICKS(2));
+  return ESP_OK;
+}
+
+// Interrupt pacing: sleep until just before the learned end of conversion, then hold CS low
+// for at most one short window while the DRDY edge is awaited.
+esp_err_t LTC2440::AwaitReadyIrq_() {
+  for (int window = 0; window < kDrdyMaxWindows; ++window) {
+    const bool tracking = last_conv_start_us_ > 0;
+    const int64_t target_us = last_conv_start_us_ + conv_estimate_us_ - kDrdyWindowLeadUs;
+    if (tracking) {
+      SpiArbiterReserve(SpiClient::kAdc, target_us);
+      SleepUntil_(target_us);
+    }
+
+    esp_err_t lock = SpiArbiterAcquire(SpiClient::kAdc, spi_handle_, kDrdyWindowUs,
+                                       kBusAcquireTimeout);
+    if (lock != ESP_OK) {
+      return lock;
+    }
+    gpio_set_level(chip_select_pin_, 0);
+    const int64_t open_us = esp_timer_get_time();
+
+    int64_t edge_us = 0;
+    if (WaitDrdyEdge_(open_us + kDrdyWindowUs, &edge_us)) {
+      if (edge_us > 0) {
+        last_ready_us_ = edge_us;
+        if (tracking) {
+          conv_estimate_us_ = std::clamp<int64_t>(edge_us - last_conv_start_us_,
+                                                  kDrdyWindowLeadUs, mode_().guard_us);
+        }
+      } else {
+        last_ready_us_ = open_us;
+        // Ready before a window opened on schedule: the estimate is too long, so pull the
+        // next window in until the edge lands inside it.
+        if (tracking && open_us - target_us < kDrdyWindowLeadUs) {
+          conv_estimate_us_ = std::max<int64_t>(conv_estimate_us_ - kDrdyWindowLeadUs,
+                                                kDrdyWindowLeadUs);
+        }
+      }
+      return ESP_OK;
+    }
+
+    // Conversion running late: hand the bus back to the W5500 before the next window.
+    gpio_set_level(chip_select_pin_, 1);
+    SpiArbiterRelease(SpiClient::kAdc, spi_handle_);
+    conv_estimate_us_ = std::min(conv_estimate_us_ + kDrdyWindowUs, mode_().guard_us);
+    if (!tracking) SleepUntil_(esp_timer_get_time() + kDrdyWindowUs);
+  }
+  return ESP_ERR_TIMEOUT;
+}
 
-  uint8_t tx[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+// Clocks one frame out of a converter whose CS is low and whose EOC is asserted, over `bus`
+// (already acquired). Any device handle on the host works since CS is driven manually.
+// Leaves CS high, which starts the next conversion.
+esp_err_t LTC2440::ReadFrame_(spi_device_handle_t bus, int32_t* value) {
+  // The first SDI byte selects the OSR of the conversion this readout starts.
+  const uint8_t next_mode = requested_mode_.load(std::memory_order_relaxed);
+  uint8_t tx[4] = {kLtc2440SpeedModes[next_mode].sdi, 0xFF, 0xFF, 0xFF};
   uint8_t rx[4] = {0, 0, 0, 0};
 
   spi_transaction_t transaction = {};
@@ -110,10 +295,9 @@ esp_err_t LTC2440::ReadRaw_(int32_t* value) {
 
   const int kMaxAttempts = 2;
   for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
-    esp_err_t ret = spi_device_transmit(spi_handle_, &transaction);
+    esp_err_t ret = spi_device_transmit(bus, &transaction);
     if (ret != ESP_OK) {
       gpio_set_level(chip_select_pin_, 1);
-      spi_device_release_bus(spi_handle_);
       return ret;
     }
 
@@ -134,7 +318,11 @@ esp_err_t LTC2440::ReadRaw_(int32_t* value) {
       *value = result >> 5;  // drop lowest 5 bits as in reference driver
       gpio_set_level(chip_select_pin_, 1);
       last_conv_start_us_ = esp_timer_get_time();  // conversion starts when CS goes high
-      spi_device_release_bus(spi_handle_);
+      if (next_mode != active_mode_) {
+        // The learned conversion time belonged to the old OSR.
+        active_mode_ = next_mode;
+        conv_estimate_us_ = mode_().conversion_us;
+      }
       return ESP_OK;
     }
 
@@ -156,10 +344,164 @@ esp_err_t LTC2440::ReadRaw_(int32_t* value) {
 
   gpio_set_level(chip_select_pin_, 1);
   last_conv_start_us_ = esp_timer_get_time();
-  spi_device_release_bus(spi_handle_);
   return ESP_ERR_INVALID_RESPONSE;
 }
 
+esp_err_t LTC2440::ReadRaw_(int32_t* value) {
+  if (!initialized_) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  // On success the bus is held and CS is low with EOC asserted.
+  esp_err_t ready = drdy_irq_ ? AwaitReadyIrq_() : AwaitReadyGuarded_();
+  if (ready != ESP_OK) {
+    return ready;
+  }
+  esp_err_t ret = ReadFrame_(spi_handle_, value);
+  SpiArbiterRelease(SpiClient::kAdc, spi_handle_);
+  return ret;
+}
+
+// Earliest time this converter is worth opening a window for.
+int64_t LTC2440::NextWindowUs_() const {
+  if (last_conv_start_us_ <= 0) return 0;
+  return drdy_irq_ ? last_conv_start_us_ + conv_estimate_us_ - kDrdyWindowLeadUs
+                   : last_conv_start_us_ + mode_().guard_us;
+}
+
+// One window for the whole set, timed for the converter expected to finish last. A converter
+// that missed the last round (ADC1 may be unpopulated) must not stretch it for the rest.
+int64_t LTC2440::PipelinedWindowUs(LTC2440* const adcs[], size_t count) {
+  if (!adcs) return 0;
+  int64_t target_us = 0;
+  bool any_responding = false;
+  for (size_t i = 0; i < count; ++i) any_responding |= adcs[i]->responding_;
+  for (size_t i = 0; i < count; ++i) {
+    if (adcs[i]->responding_ || !any_responding) {
+      target_us = std::max(target_us, adcs[i]->NextWindowUs_());
+    }
+  }
+  return target_us;
+}
+
+esp_err_t LTC2440::ReadPipelined(LTC2440* const adcs[], size_t count, int32_t values[],
+                                 esp_err_t results[]) {
+  if (!adcs || count == 0 || !values || !results) return ESP_ERR_INVALID_ARG;
+  LTC2440* lead = adcs[0];
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = 0;
+    results[i] = adcs[i]->initialized_ ? ESP_FAIL : ESP_ERR_INVALID_STATE;
+    if (!adcs[i]->initialized_) lead = nullptr;
+  }
+  if (!lead) return ESP_ERR_INVALID_STATE;
+
+  const int64_t target_us = PipelinedWindowUs(adcs, count);
+  SpiArbiterReserve(SpiClient::kAdc, target_us);
+  lead->SleepUntil_(target_us);
+
+  esp_err_t lock = SpiArbiterAcquire(SpiClient::kAdc, lead->spi_handle_, kSpiAdcHoldBudgetUs,
+                                     kBusAcquireTimeout);
+  if (lock != ESP_OK) {
+    for (size_t i = 0; i < count; ++i) results[i] = lock;
+    return lock;
+  }
+  const int64_t open_us = esp_timer_get_time();
+  const bool on_schedule = target_us > 0 && open_us - target_us < kDrdyWindowLeadUs;
+  // The DRDY waits share one hold budget so the W5500 is never locked out for long; the
+  // frames themselves take ~1 ms at 100 kHz, so leave room for them at the end.
+  const int64_t wait_deadline_us = open_us + kSpiAdcHoldBudgetUs - 1'500;
+
+  // Read in order: conversions were started in this order, so they also end in it. Every
+  // CS rise restarts a conversion, so the next set starts within a few frame times.
+  bool any_edge = false;
+  for (size_t i = 0; i < count; ++i) {
+    LTC2440* adc = adcs[i];
+    const bool probing = adc->missed_windows_ >= kDropAfterMissedWindows;
+    if (probing && open_us < adc->reprobe_us_) {
+      results[i] = ESP_ERR_TIMEOUT;
+      continue;
+    }
+    gpio_set_level(adc->chip_select_pin_, 0);
+    const int64_t cs_low_us = esp_timer_get_time();
+    bool ready = false;
+    if (adc->drdy_irq_) {
+      int64_t edge_us = 0;
+      ready = adc->WaitDrdyEdge_(std::min(cs_low_us + kDrdyWindowUs, wait_deadline_us), &edge_us);
+      if (ready && edge_us > 0) {
+        any_edge = true;
+        adc->last_ready_us_ = edge_us;
+        if (adc->last_conv_start_us_ > 0) {
+          adc->conv_estimate_us_ = std::clamp<int64_t>(edge_us - adc->last_conv_start_us_,
+                                                       kDrdyWindowLeadUs, adc->mode_().guard_us);
+        }
+      } else if (ready) {
+        adc->last_ready_us_ = cs_low_us;
+      }
+    } else {
+      ready = adc->WaitReady_(pdMS_TO_TICKS(3)) == ESP_OK;
+      if (ready) adc->last_ready_us_ = esp_timer_get_time();
+    }
+
+    if (!ready) {
+      // Late converter: skip it this round rather than hold the others' results.
+      gpio_set_level(adc->chip_select_pin_, 1);
+      results[i] = ESP_ERR_TIMEOUT;
+      if (adc->drdy_irq_) {
+        adc->conv_estimate_us_ =
+            std::min(adc->conv_estimate_us_ + kDrdyWindowUs, adc->mode_().guard_us);
+      }
+      if (adc->missed_windows_ < kDropAfterMissedWindows) {
+        if (++adc->missed_windows_ == kDropAfterMissedWindows && adc->log_errors_) {
+          ESP_LOGW(TAG, "CS %d: no data for %u windows, probing once per %lld ms",
+                   static_cast<int>(adc->chip_select_pin_), static_cast<unsigned>(kDropAfterMissedWindows),
+                   static_cast<long long>(kReprobeIntervalUs / 1000));
+        }
+      }
+      if (adc->missed_windows_ >= kDropAfterMissedWindows) adc->reprobe_us_ = open_us + kReprobeIntervalUs;
+      continue;
+    }
+    int32_t raw = 0;
+    results[i] = adc->ReadFrame_(lead->spi_handle_, &raw);
+    if (results[i] != ESP_OK) continue;
+    adc->missed_windows_ = 0;
+    if (probing) {
+      // The frame holds a conversion started back when the converter dropped out; this read
+      // restarted it with the set, so it rejoins with the next window.
+      if (adc->log_errors_) ESP_LOGI(TAG, "CS %d: answering again", static_cast<int>(adc->chip_select_pin_));
+      results[i] = ESP_ERR_NOT_FINISHED;
+      continue;
+    }
+    values[i] = raw - adc->adc_offset_;
+  }
+  SpiArbiterRelease(SpiClient::kAdc, lead->spi_handle_);
+  for (size_t i = 0; i < count; ++i) adcs[i]->responding_ = results[i] == ESP_OK;
+
+  // Everything was already done when a window opened on schedule: pull the next one in.
+  if (on_schedule && !any_edge) {
+    for (size_t i = 0; i < count; ++i) {
+      LTC2440* adc = adcs[i];
+      if (adc->drdy_irq_ && results[i] == ESP_OK) {
+        adc->conv_estimate_us_ = std::max<int64_t>(adc->conv_estimate_us_ - kDrdyWindowLeadUs,
+                                                   kDrdyWindowLeadUs);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    if (results[i] != ESP_OK) return results[i];
+  }
+  return ESP_OK;
+}
+
+esp_err_t LTC2440::SetOsr(uint16_t osr) {
+  for (size_t i = 0; i < kLtc2440SpeedModeCount; ++i) {
+    if (kLtc2440SpeedModes[i].osr == osr) {
+      requested_mode_.store(static_cast<uint8_t>(i), std::memory_order_relaxed);
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_INVALID_ARG;
+}
+
 esp_err_t LTC2440::Read(int32_t* value) {
   int32_t raw = 0;
   esp_err_t ret = ReadRaw_(&raw);
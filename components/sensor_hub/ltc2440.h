@@ -1,13 +1,52 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>  // size_t
 #include <cstdint>  // int32_t
 
 #include "driver/gpio.h"
 #include "driver/spi_master.h"
 #include "esp_err.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+// LTC2440 speed/resolution settings (datasheet OSR table, internal oscillator, 1X mode):
+// output rate is 225.28 kHz / OSR. The SDI byte is clocked in while one conversion is read
+// out and selects the OSR of the next one.
+struct Ltc2440SpeedMode {
+  uint16_t osr;
+  uint8_t sdi;            // first SDI byte: OSR4..OSR0, TWOX
+  int64_t conversion_us;  // nominal conversion time
+  int64_t guard_us;       // fixed wait used when DRDY cannot be watched
+};
+
+constexpr Ltc2440SpeedMode MakeLtc2440SpeedMode(uint16_t osr, uint8_t sdi) {
+  const int64_t conversion_us = (int64_t{osr} * 1'000'000 + 225'279) / 225'280;
+  // 25% covers oscillator tolerance, plus one 32-bit frame at the slowest bus clock.
+  return {osr, sdi, conversion_us, conversion_us + conversion_us / 4 + 500};
+}
+
+inline constexpr Ltc2440SpeedMode kLtc2440SpeedModes[] = {
+    MakeLtc2440SpeedMode(64, 0x01 << 3),     // 3.52 kHz
+    MakeLtc2440SpeedMode(128, 0x02 << 3),    // 1.76 kHz
+    MakeLtc2440SpeedMode(256, 0x03 << 3),    // 880 Hz
+    MakeLtc2440SpeedMode(512, 0x04 << 3),    // 440 Hz
+    MakeLtc2440SpeedMode(1024, 0x05 << 3),   // 220 Hz
+    MakeLtc2440SpeedMode(2048, 0x06 << 3),   // 110 Hz
+    MakeLtc2440SpeedMode(4096, 0x07 << 3),   // 55 Hz
+    MakeLtc2440SpeedMode(8192, 0x08 << 3),   // 27.5 Hz
+    MakeLtc2440SpeedMode(16384, 0x09 << 3),  // 13.75 Hz
+    MakeLtc2440SpeedMode(32768, 0xFF),       // 6.875 Hz, the all-ones byte the driver always sent
+};
+inline constexpr size_t kLtc2440SpeedModeCount =
+    sizeof(kLtc2440SpeedModes) / sizeof(kLtc2440SpeedModes[0]);
+inline constexpr size_t kLtc2440DefaultSpeedMode = kLtc2440SpeedModeCount - 1;
+
+static_assert(kLtc2440SpeedModes[kLtc2440DefaultSpeedMode].osr == 32768, "default must stay OSR 32768");
+static_assert(kLtc2440SpeedModes[kLtc2440DefaultSpeedMode].guard_us <= 185'000,
+              "default guard must stay close to the original 180 ms");
+
 class LTC2440 {
  public:
   explicit LTC2440(gpio_num_t chip_select_pin, gpio_num_t drdy_pin = GPIO_NUM_NC,
@@ -16,18 +55,64 @@ class LTC2440 {
   // Initialize device on already-configured SPI bus.
   esp_err_t Init(spi_host_device_t host, int clock_hz = 100'000);  // я бы по умолчанию <= 2.5 MHz
 
+  // Switch from the fixed conversion guard to DRDY-interrupt scheduling. The GPIO ISR
+  // service must already be installed. Instances sharing one SDO/MISO line share the
+  // interrupt; only the instance holding the bus arms it.
+  //
+  // EOC is only visible on SDO while CS is low, and holding CS low keeps the bus (and the
+  // W5500 on it) locked. So instead of waiting on the edge for the whole conversion, the
+  // driver learns the conversion time from the edges it sees and opens a short window just
+  // before the next one is due. Read() then sleeps on the calling task's notification value.
+  esp_err_t EnableDrdyInterrupt();
+  bool drdy_interrupt() const { return drdy_irq_; }
+
+  // Select the oversampling ratio (one of kLtc2440SpeedModes). Safe to call from any task;
+  // it is sent with the next readout and applies to the conversion that readout starts.
+  esp_err_t SetOsr(uint16_t osr);
+  // OSR of the conversion currently running.
+  uint16_t osr() const { return kLtc2440SpeedModes[active_mode_].osr; }
+
   // Read value with offset applied (24-bit, sign-extended, shifted by 5 bits).
   esp_err_t Read(int32_t* value);
 
+  // Reads converters that share one SPI host in a single bus window, in order, through the
+  // first one's device handle (CS is manual, so any handle can clock any chip). Raising each
+  // CS restarts its conversion, so the set converts together and the next window serves all
+  // of them again. values[i] gets the offset-applied reading and results[i] its status; a
+  // converter that is not ready within its window is skipped this round. After several
+  // missed windows in a row it is left out (ESP_ERR_TIMEOUT without a wait) and probed about
+  // once a second; the probe that finds it answering again reports ESP_ERR_NOT_FINISHED, as
+  // its frame is stale. Returns the first failure, or ESP_OK.
+  static esp_err_t ReadPipelined(LTC2440* const adcs[], size_t count, int32_t values[],
+                                 esp_err_t results[]);
+  // esp_timer time ReadPipelined() will open the next window for the set (0 before the
+  // first read), so a caller can schedule other work up to it instead of sleeping inside.
+  static int64_t PipelinedWindowUs(LTC2440* const adcs[], size_t count);
+
   // Compute and store offset using a moving average over given samples.
   esp_err_t Tare(int samples, int delay_ms);
 
   int32_t offset() const { return adc_offset_; }
 
+  // esp_timer time at which the last value read became ready. In interrupt mode this is the
+  // EOC edge itself (or the window start if the conversion ended before the window opened).
+  int64_t last_ready_us() const { return last_ready_us_; }
+  // Conversion time learned from DRDY edges; the nominal time for the OSR until an edge is seen.
+  int64_t conversion_time_us() const { return conv_estimate_us_; }
+
  private:
   esp_err_t WaitReady_(TickType_t timeout_ticks);
+  esp_err_t AwaitReadyGuarded_();
+  esp_err_t AwaitReadyIrq_();
+  bool WaitDrdyEdge_(int64_t deadline_us, int64_t* edge_us);
+  void SleepUntil_(int64_t target_us);
+  int64_t NextWindowUs_() const;
+  const Ltc2440SpeedMode& mode_() const { return kLtc2440SpeedModes[active_mode_]; }
+  esp_err_t ReadFrame_(spi_device_handle_t bus, int32_t* value);
   esp_err_t ReadRaw_(int32_t* value);
 
+  static void WakeTimerCallback(void* arg);
+
   spi_device_handle_t spi_handle_{nullptr};
   gpio_num_t chip_select_pin_;
   gpio_num_t drdy_pin_;
@@ -35,4 +120,14 @@ class LTC2440 {
   int32_t adc_offset_ = 0;
   bool initialized_ = false;
   int64_t last_conv_start_us_ = 0;
+  int64_t last_ready_us_ = 0;
+  int64_t conv_estimate_us_;
+  std::atomic<uint8_t> requested_mode_{kLtc2440DefaultSpeedMode};
+  uint8_t active_mode_ = kLtc2440DefaultSpeedMode;
+  bool drdy_irq_ = false;
+  bool responding_ = true;  // last ReadPipelined() round succeeded
+  uint8_t missed_windows_ = 0;  // consecutive ReadPipelined() timeouts, saturating at the drop limit
+  int64_t reprobe_us_ = 0;      // while dropped: earliest window that reads it again
+  esp_timer_handle_t wake_timer_ = nullptr;
+  TaskHandle_t wake_task_ = nullptr;
 };
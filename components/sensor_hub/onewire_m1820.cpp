@@ -8,8 +8,10 @@
 
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "nvs.h"
 #include "onewire_bus.h"
 #include "onewire_crc.h"
 
@@ -22,8 +24,9 @@ constexpr uint8_t kCmdSkipRom = 0xCC;
 constexpr uint8_t kCmdConvertT = 0x44;
 constexpr uint8_t kCmdReadScratchpad = 0xBE;
 constexpr uint32_t kConversionDelayUs = 11000;  // ~10.6 ms from datasheet
-constexpr int kReadAttempts = 3;
-constexpr int kReadRetryDelayMs = 50;
+constexpr int kReadAttempts = 3;  // per sensor and cycle
+constexpr size_t kScratchpadBytes = 9;
+constexpr size_t kTemperatureBytes = 2;
 
 const char* TAG = "M1820";
 
@@ -31,6 +34,46 @@ onewire_bus_handle_t g_bus = nullptr;
 std::array<uint64_t, kMaxDevices> g_addresses{};
 int g_sensor_count = 0;
 
+// Conversion cycle in progress. Only the task driving M1820Service() touches it.
+struct Cycle {
+  M1820CycleStatus status = M1820CycleStatus::kIdle;
+  bool temperature_only = false;
+  int64_t ready_us = 0;    // esp_timer time the conversion is complete
+  uint32_t pending = 0;    // sensors still to read
+  int next = 0;            // round-robin position, so a retry waits for the other sensors
+  std::array<uint8_t, kMaxDevices> attempts{};
+  std::array<float, kMaxDevices> temps{};
+};
+Cycle g_cycle;
+std::array<float, kMaxDevices> g_results{};  // last finished cycle
+std::array<uint8_t, kMaxDevices> g_result_attempts{};
+int g_result_count = 0;
+
+// Slot bindings are persisted so indices (and the labels built from them) survive reboots
+// and hot-plug; a removed sensor leaves a hole rather than shifting the others, and new
+// sensors are bound after the highest slot ever used, so an index is not handed to a
+// different sensor while logs still carry the old one.
+constexpr char kNvsNamespace[] = "m1820";
+constexpr char kNvsRomKey[] = "roms";
+constexpr char kNvsSlotEndKey[] = "slot_end";
+constexpr uint8_t kMissedPassesToDrop = 3;
+std::array<uint8_t, kMaxDevices> g_misses{};
+int g_slot_end = 0;  // one past the highest slot ever bound
+
+enum class SearchStep : uint8_t { kMore, kComplete, kAborted };
+
+struct SearchPass {
+  bool active = false;
+  std::array<uint8_t, 8> rom{};
+  int last_discrepancy = 0;
+  bool last_device_flag = false;
+  int last_family_discrepancy = 0;
+  int steps = 0;
+  std::array<uint64_t, kMaxDevices> seen{};
+  int seen_count = 0;
+};
+SearchPass g_search;
+
 uint8_t SearchCrc8(const uint8_t* data, size_t len) {
   return onewire_crc8(0, const_cast<uint8_t*>(data), len);
 }
@@ -165,155 +208,342 @@ bool MatchRom(const uint8_t* rom) {
   return onewire_bus_write_bytes(g_bus, payload, sizeof(payload)) == ESP_OK;
 }
 
+// Reads the first `len` scratchpad bytes; the master may stop early, the next reset ends
+// the read on the device side.
 bool ReadScratchpad(const uint8_t* rom, uint8_t* out_data, size_t len) {
-  if (!out_data || len < 9) return false;
+  if (!out_data || len == 0 || len > kScratchpadBytes) return false;
   if (!BusReset()) return false;
   if (!MatchRom(rom)) return false;
   uint8_t cmd = kCmdReadScratchpad;
   if (onewire_bus_write_bytes(g_bus, &cmd, 1) != ESP_OK) return false;
-  return onewire_bus_read_bytes(g_bus, out_data, 9) == ESP_OK;
+  return onewire_bus_read_bytes(g_bus, out_data, len) == ESP_OK;
 }
 
-int ScanSensors() {
-  g_addresses.fill(0);
-  g_sensor_count = 0;
+bool ReadSensor(int index, bool temperature_only, float* out_celsius) {
+  uint8_t rom_bytes[8];
+  std::memcpy(rom_bytes, &g_addresses[index], sizeof(rom_bytes));
+  uint8_t data[kScratchpadBytes] = {};
+  const size_t len = temperature_only ? kTemperatureBytes : kScratchpadBytes;
+  if (!ReadScratchpad(rom_bytes, data, len)) {
+    ESP_LOGD(TAG, "Scratchpad read failed for sensor %d", index);
+    return false;
+  }
+  if (temperature_only) {
+    // No CRC without the full scratchpad; an absent device still reads back all ones.
+    if (data[0] == 0xFF && data[1] == 0xFF) return false;
+  } else if (SearchCrc8(data, 8) != data[8]) {
+    ESP_LOGD(TAG, "Scratchpad CRC error for sensor %d", index);
+    return false;
+  }
+  int16_t raw = static_cast<int16_t>((static_cast<uint16_t>(data[1]) << 8) | data[0]);
+  *out_celsius = 40.0f + static_cast<float>(raw) * kM1820LsbCelsius;
+  return true;
+}
 
-  ESP_LOGI(TAG, "Start searching M1820 sensors...");
-  int last_discrepancy = 0;
+void FinishCycle() {
+  bool any_ok = false;
+  for (int i = 0; i < g_sensor_count; ++i) {
+    if (g_addresses[i] == 0) continue;
+    if (std::isnan(g_cycle.temps[i])) {
+      ESP_LOGW(TAG, "Sensor %d not read after %d attempt(s)", i, g_cycle.attempts[i]);
+    } else {
+      any_ok = true;
+    }
+  }
+  if (!any_ok) {
+    g_cycle.status = M1820CycleStatus::kFailed;
+    return;
+  }
+  g_results = g_cycle.temps;
+  g_result_attempts = g_cycle.attempts;
+  g_result_count = g_sensor_count;
+  g_cycle.status = M1820CycleStatus::kDone;
+}
+
+bool RomLooksValid(uint64_t rom) {
+  uint8_t bytes[8];
+  std::memcpy(bytes, &rom, sizeof(bytes));
+  return rom != 0 && SearchCrc8(bytes, 7) == bytes[7];
+}
+
+// Targeted search (Maxim AN187 "Verify"): succeeds only if the device with `rom` answers.
+bool VerifyRom(uint64_t rom) {
+  std::array<uint8_t, 8> search_rom{};
+  std::memcpy(search_rom.data(), &rom, sizeof(rom));
+  int last_discrepancy = 64;
   bool last_device_flag = false;
   int last_family_discrepancy = 0;
-  std::array<uint8_t, 8> search_rom{};
+  uint64_t found = 0;
+  return SearchNext(&found, &search_rom, &last_discrepancy, &last_device_flag,
+                    &last_family_discrepancy) &&
+         found == rom;
+}
 
-  int found = 0;
-  int attempts = 0;
-  while (found < kMaxDevices && attempts < 64) {
-    uint64_t rom = 0;
-    if (!SearchNext(&rom, &search_rom, &last_discrepancy, &last_device_flag, &last_family_discrepancy)) {
-      break;
-    }
-    attempts++;
-    uint8_t rom_bytes[8];
-    std::memcpy(rom_bytes, &rom, sizeof(rom_bytes));
-    uint8_t family = static_cast<uint8_t>(rom & 0xFF);
-    if (family != 0x28) {
-      ESP_LOGI(TAG, "Skip non-M1820 device family 0x%02X (rom %016llX)", family, (unsigned long long)rom);
-      if (last_device_flag) break;
-      continue;
-    }
-    bool duplicate = false;
-    for (int i = 0; i < found; ++i) {
-      if (g_addresses[i] == rom) {
-        duplicate = true;
-        break;
-      }
-    }
-    if (duplicate) {
-      ESP_LOGI(TAG, "Duplicate device %016llX skipped, stopping search", (unsigned long long)rom);
-      break;
+void RecountSensors() {
+  g_sensor_count = 0;
+  for (int i = 0; i < kMaxDevices; ++i) {
+    if (g_addresses[i] != 0) g_sensor_count = i + 1;
+  }
+}
+
+bool LoadRomTable() {
+  nvs_handle_t handle;
+  if (nvs_open(kNvsNamespace, NVS_READONLY, &handle) != ESP_OK) return false;
+  size_t size = sizeof(g_addresses);
+  const esp_err_t err = nvs_get_blob(handle, kNvsRomKey, g_addresses.data(), &size);
+  nvs_close(handle);
+  if (err != ESP_OK || size != sizeof(g_addresses)) {
+    g_addresses.fill(0);
+    return false;
+  }
+  uint8_t slot_end = 0;
+  if (nvs_open(kNvsNamespace, NVS_READONLY, &handle) == ESP_OK) {
+    nvs_get_u8(handle, kNvsSlotEndKey, &slot_end);
+    nvs_close(handle);
+  }
+  for (auto& rom : g_addresses) {
+    if (rom != 0 && !RomLooksValid(rom)) rom = 0;
+  }
+  RecountSensors();
+  g_slot_end = std::min(std::max<int>(slot_end, g_sensor_count), kMaxDevices);
+  return g_sensor_count > 0;
+}
+
+void SaveRomTable() {
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(kNvsNamespace, NVS_READWRITE, &handle);
+  if (err == ESP_OK) {
+    err = nvs_set_blob(handle, kNvsRomKey, g_addresses.data(), sizeof(g_addresses));
+    if (err == ESP_OK) err = nvs_set_u8(handle, kNvsSlotEndKey, static_cast<uint8_t>(g_slot_end));
+    if (err == ESP_OK) err = nvs_commit(handle);
+    nvs_close(handle);
+  }
+  if (err != ESP_OK) ESP_LOGW(TAG, "ROM table save failed: %s", esp_err_to_name(err));
+}
+
+void StartSearchPass() {
+  g_search = SearchPass{};
+  g_search.active = true;
+}
+
+// One SearchNext per call so a background pass never holds the bus for long.
+SearchStep SearchPassStep() {
+  if (g_search.steps++ >= 64) return SearchStep::kAborted;
+  uint64_t rom = 0;
+  if (!SearchNext(&rom, &g_search.rom, &g_search.last_discrepancy, &g_search.last_device_flag,
+                  &g_search.last_family_discrepancy)) {
+    // No presence pulse, or a bus error mid-search: either way nothing to conclude from.
+    return SearchStep::kAborted;
+  }
+  const uint8_t family = static_cast<uint8_t>(rom & 0xFF);
+  if (!RomLooksValid(rom)) {
+    ESP_LOGD(TAG, "Search returned ROM %016llX with bad CRC", (unsigned long long)rom);
+    return SearchStep::kAborted;
+  }
+  if (family != 0x28) {
+    ESP_LOGD(TAG, "Skip non-M1820 device family 0x%02X (rom %016llX)", family, (unsigned long long)rom);
+  } else {
+    const auto seen_end = g_search.seen.begin() + g_search.seen_count;
+    if (std::find(g_search.seen.begin(), seen_end, rom) != seen_end) return SearchStep::kComplete;
+    if (g_search.seen_count < kMaxDevices) g_search.seen[g_search.seen_count++] = rom;
+  }
+  return g_search.last_device_flag ? SearchStep::kComplete : SearchStep::kMore;
+}
+
+// Slot for a newly found sensor: after the highest slot ever bound. Only once those run out
+// is the lowest vacated slot reused. -1 if the table is full.
+int NewSensorSlot() {
+  if (g_slot_end < kMaxDevices) return g_slot_end;
+  const auto hole = std::find(g_addresses.begin(), g_addresses.end(), uint64_t{0});
+  if (hole == g_addresses.end()) return -1;
+  const int slot = static_cast<int>(hole - g_addresses.begin());
+  ESP_LOGW(TAG, "All M1820 slots used once, reusing vacated slot %d", slot);
+  return slot;
+}
+
+// Merges a complete pass into the table. Known sensors keep their index; a sensor missing
+// from kMissedPassesToDrop passes in a row frees its slot; new sensors get NewSensorSlot().
+// With count_misses false, absent sensors keep the misses they already have (the boot
+// verify counted them). Returns true if any binding changed.
+bool ApplySearchPass(bool count_misses = true) {
+  bool changed = false;
+  const auto seen_end = g_search.seen.begin() + g_search.seen_count;
+  for (int i = 0; i < kMaxDevices; ++i) {
+    if (g_addresses[i] == 0) continue;
+    if (std::find(g_search.seen.begin(), seen_end, g_addresses[i]) != seen_end) {
+      g_misses[i] = 0;
+    } else if (count_misses && ++g_misses[i] >= kMissedPassesToDrop) {
+      ESP_LOGW(TAG, "M1820[%d] addr=%016llX removed", i, (unsigned long long)g_addresses[i]);
+      g_addresses[i] = 0;
+      g_misses[i] = 0;
+      changed = true;
     }
-    g_addresses[found] = rom;
-    ESP_LOGI(TAG, "Found M1820[%d] addr=%016llX", found, (unsigned long long)rom);
-    found++;
-    if (last_device_flag) {
+  }
+  for (int k = 0; k < g_search.seen_count; ++k) {
+    const uint64_t rom = g_search.seen[k];
+    if (std::find(g_addresses.begin(), g_addresses.end(), rom) != g_addresses.end()) continue;
+    const int slot = NewSensorSlot();
+    if (slot < 0) {
+      ESP_LOGW(TAG, "No free slot for M1820 addr=%016llX", (unsigned long long)rom);
       break;
     }
+    g_addresses[slot] = rom;
+    g_misses[slot] = 0;
+    g_slot_end = std::max(g_slot_end, slot + 1);
+    ESP_LOGI(TAG, "Found M1820[%d] addr=%016llX", slot, (unsigned long long)rom);
+    changed = true;
   }
+  g_search.active = false;
+  if (changed) {
+    RecountSensors();
+    SaveRomTable();
+  }
+  return changed;
+}
 
-  g_sensor_count = found;
-  ESP_LOGI(TAG, "Searching done, %d M1820 device(s) found", g_sensor_count);
-  return g_sensor_count;
+// Blocking full search, used at boot when no stored sensor answers. The result is merged
+// into the loaded table: stored sensors that are still absent keep their slot with the miss
+// VerifyStoredSensors() gave them, and the hot-plug passes drop them as usual. Returns the
+// number of sensors that answered.
+int ScanSensors() {
+  ESP_LOGI(TAG, "Start searching M1820 sensors...");
+  StartSearchPass();
+  SearchStep step;
+  do {
+    step = SearchPassStep();
+  } while (step == SearchStep::kMore);
+  if (step == SearchStep::kComplete) {
+    ApplySearchPass(false);
+  } else {
+    g_search.active = false;
+  }
+  RecountSensors();
+  const int found = step == SearchStep::kComplete ? g_search.seen_count : 0;
+  ESP_LOGI(TAG, "Searching done, %d M1820 device(s) found, %d slot(s) bound", found,
+           g_sensor_count);
+  return found;
+}
+
+// Boot path with a stored table: check each known ROM directly instead of searching.
+int VerifyStoredSensors() {
+  int verified = 0;
+  for (int i = 0; i < kMaxDevices; ++i) {
+    if (g_addresses[i] == 0) continue;
+    if (VerifyRom(g_addresses[i])) {
+      ++verified;
+    } else {
+      g_misses[i] = 1;
+      ESP_LOGW(TAG, "Stored M1820[%d] addr=%016llX not responding", i,
+               (unsigned long long)g_addresses[i]);
+    }
+  }
+  return verified;
 }
 
 }  // namespace
 
 bool M1820Init(gpio_num_t pin) {
   g_addresses.fill(0);
+  g_misses.fill(0);
   g_sensor_count = 0;
+  g_slot_end = 0;
 
   if (!InitBus(pin)) {
     return false;
   }
 
-  ScanSensors();
-  return g_sensor_count > 0;
+  if (LoadRomTable()) {
+    const int verified = VerifyStoredSensors();
+    if (verified > 0) {
+      ESP_LOGI(TAG, "%d of %d stored M1820 sensor(s) verified, search skipped", verified,
+               g_sensor_count);
+      return true;
+    }
+    ESP_LOGW(TAG, "No stored M1820 sensor answers, searching the bus");
+  }
+  return ScanSensors() > 0;
+}
+
+bool M1820BusReady() {
+  return g_bus != nullptr;
+}
+
+bool M1820PresenceStep(bool* changed) {
+  if (changed) *changed = false;
+  if (!g_bus) return true;
+  if (!g_search.active) StartSearchPass();
+  const SearchStep step = SearchPassStep();
+  if (step == SearchStep::kMore) return false;
+  if (step == SearchStep::kAborted) {
+    g_search.active = false;
+    return true;
+  }
+  const bool table_changed = ApplySearchPass();
+  if (changed) *changed = table_changed;
+  return true;
 }
 
 int M1820GetSensorCount() {
   return g_sensor_count;
 }
 
-bool M1820ReadTemperatures(float* out_values, int max_values, int* out_count) {
-  if (!out_values || !out_count || g_sensor_count == 0 || max_values <= 0 || g_bus == nullptr) {
+bool M1820StartConversion(bool temperature_only) {
+  if (g_sensor_count == 0 || g_bus == nullptr) return false;
+  uint8_t convert_cmd[2] = {kCmdSkipRom, kCmdConvertT};
+  if (!BusReset() || onewire_bus_write_bytes(g_bus, convert_cmd, sizeof(convert_cmd)) != ESP_OK) {
+    ESP_LOGD(TAG, "Convert command failed");
+    g_cycle.status = M1820CycleStatus::kFailed;
     return false;
   }
 
-  const int to_read = std::min(g_sensor_count, max_values);
-  *out_count = 0;
-
-  for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
-    for (int i = 0; i < max_values; ++i) {
-      out_values[i] = NAN;
-    }
-
-    const bool last_attempt = attempt + 1 == kReadAttempts;
-    bool conversion_started = false;
-    if (BusReset()) {
-      uint8_t convert_cmd[2] = {kCmdSkipRom, kCmdConvertT};
-      if (onewire_bus_write_bytes(g_bus, convert_cmd, sizeof(convert_cmd)) == ESP_OK) {
-        conversion_started = true;
-      } else if (last_attempt) {
-        ESP_LOGW(TAG, "Convert command failed");
-      }
-    }
-    if (!conversion_started) {
-      if (!last_attempt) {
-        vTaskDelay(pdMS_TO_TICKS(kReadRetryDelayMs));
-        continue;
-      }
-      return false;
-    }
-    vTaskDelay(pdMS_TO_TICKS((kConversionDelayUs + 999) / 1000));
-
-    bool any_ok = false;
-    for (int i = 0; i < to_read; ++i) {
-      const uint64_t addr = g_addresses[i];
-      if (addr == 0) continue;
-      uint8_t rom_bytes[8];
-      std::memcpy(rom_bytes, &addr, sizeof(rom_bytes));
-
-      uint8_t data[9] = {};
-      if (!ReadScratchpad(rom_bytes, data, sizeof(data))) {
-        if (last_attempt) {
-          ESP_LOGW(TAG, "Scratchpad read failed for sensor %d", i);
-        }
-        continue;
-      }
-      if (SearchCrc8(data, 8) != data[8]) {
-        if (last_attempt) {
-          ESP_LOGW(TAG, "Scratchpad CRC error for sensor %d", i);
-        }
-        continue;
-      }
-      int16_t raw = static_cast<int16_t>((static_cast<uint16_t>(data[1]) << 8) | data[0]);
-      float celsius = 40.0f + (static_cast<float>(raw) / 256.0f);
-      out_values[i] = celsius;
-      any_ok = true;
-    }
+  g_cycle = Cycle{};
+  g_cycle.status = M1820CycleStatus::kConverting;
+  g_cycle.temperature_only = temperature_only;
+  g_cycle.ready_us = esp_timer_get_time() + kConversionDelayUs;
+  for (int i = 0; i < g_sensor_count; ++i) {
+    if (g_addresses[i] != 0) g_cycle.pending |= 1u << i;
+  }
+  g_cycle.temps.fill(NAN);
+  return true;
+}
 
-    if (any_ok) {
-      *out_count = to_read;
-      if (attempt > 0) {
-        ESP_LOGI(TAG, "M1820 read recovered after retry %d", attempt + 1);
-      }
-      return true;
-    }
-    if (!last_attempt) {
-      vTaskDelay(pdMS_TO_TICKS(kReadRetryDelayMs));
+M1820CycleStatus M1820Service(int max_reads) {
+  if (g_cycle.status == M1820CycleStatus::kConverting) {
+    if (esp_timer_get_time() < g_cycle.ready_us) return g_cycle.status;
+    g_cycle.status = M1820CycleStatus::kReading;
+  }
+  if (g_cycle.status != M1820CycleStatus::kReading) return g_cycle.status;
+
+  for (int reads = 0; reads < max_reads && g_cycle.pending != 0; ++reads) {
+    int i = g_cycle.next;
+    while (!(g_cycle.pending & (1u << i))) i = (i + 1) % g_sensor_count;
+    g_cycle.next = (i + 1) % g_sensor_count;
+
+    float celsius = NAN;
+    ++g_cycle.attempts[i];
+    if (ReadSensor(i, g_cycle.temperature_only, &celsius)) {
+      g_cycle.temps[i] = celsius;
+      g_cycle.pending &= ~(1u << i);
+    } else if (g_cycle.attempts[i] >= kReadAttempts) {
+      g_cycle.pending &= ~(1u << i);
     }
   }
+  if (g_cycle.pending == 0) FinishCycle();
+  return g_cycle.status;
+}
+
+int M1820GetTemperatures(float* out_values, int max_values) {
+  if (!out_values || max_values <= 0) return 0;
+  const int count = std::min(g_result_count, max_values);
+  for (int i = 0; i < max_values; ++i) out_values[i] = i < count ? g_results[i] : NAN;
+  return count;
+}
 
-  *out_count = to_read;
-  return false;
+int M1820GetReadAttempts(uint8_t* out_values, int max_values) {
+  if (!out_values || max_values <= 0) return 0;
+  const int count = std::min(g_result_count, max_values);
+  for (int i = 0; i < max_values; ++i) out_values[i] = i < count ? g_result_attempts[i] : 0;
+  return count;
 }
 
 int M1820GetAddresses(uint64_t* out_values, int max_values) {
@@ -1,8 +1,41 @@
 #pragma once
 
+#include <cstdint>
+
 #include "driver/gpio.h"
 
+// Temperature register step (1/256 degC).
+inline constexpr float kM1820LsbCelsius = 1.0f / 256.0f;
+
+// Sensors are bound to stable slots (index -> ROM) kept in NVS. Boot verifies the stored
+// ROMs directly and only searches the bus when none of them answers; that search is merged
+// into the stored table. New sensors are bound after the highest slot ever used.
 bool M1820Init(gpio_num_t pin);
+bool M1820BusReady();
+// Slot span: highest bound index + 1. Slots of removed sensors read back as address 0.
 int M1820GetSensorCount();
-bool M1820ReadTemperatures(float* out_values, int max_values, int* out_count);
 int M1820GetAddresses(uint64_t* out_values, int max_values);
+
+// Background presence pass for hot-plug: one ROM search step per call, run between
+// conversion cycles. Returns true when the pass is over; *changed is set when it bound a
+// new sensor or dropped one that missed three passes in a row.
+bool M1820PresenceStep(bool* changed);
+
+// Non-blocking conversion cycle. M1820StartConversion() issues Convert T to every sensor and
+// returns, false if the bus did not take the command (one attempt; the caller paces any
+// retry); M1820Service() then does at most `max_reads` scratchpad reads per call once the
+// conversion time has passed, retrying a failed sensor (up to 3 reads) after the others.
+// Drive both from one task.
+enum class M1820CycleStatus : uint8_t { kIdle, kConverting, kReading, kDone, kFailed };
+
+// temperature_only reads just the two temperature bytes instead of the full scratchpad:
+// ~40% less bus time per sensor, but without the CRC check.
+bool M1820StartConversion(bool temperature_only);
+M1820CycleStatus M1820Service(int max_reads);
+
+// Temperatures of the last completed cycle (NAN for sensors that failed every attempt).
+// Returns the sensor count.
+int M1820GetTemperatures(float* out_values, int max_values);
+// Scratchpad reads each sensor took in the last completed cycle: 1 is a clean read, more
+// means earlier reads failed CRC or got no answer. Returns the sensor count.
+int M1820GetReadAttempts(uint8_t* out_values, int max_values);
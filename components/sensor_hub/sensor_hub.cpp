@@ -2,14 +2,19 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <string>
+#include <utility>
 
 #include "driver/gpio.h"
+#include "driver/pulse_cnt.h"
 #include "driver/spi_common.h"
 #include "driver/spi_master.h"
 #include "driver/i2c_master.h"
 #include "esp_check.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
@@ -17,10 +22,14 @@
 
 #include "app_state.h"
 #include "app_utils.h"
+#include "adc_filters.h"
+#include "adc_stats.h"
 #include "error_manager.h"
 #include "hw_pins.h"
 #include "ltc2440.h"
 #include "onewire_m1820.h"
+#include "sample_ring.h"
+#include "spi_arbiter.h"
 
 static constexpr char kTag[] = "SENS";
 
@@ -32,37 +41,192 @@ static constexpr float kAdcScale = (kVref / 2.0f) / static_cast<float>(1 << 23);
 // ---------- INA219 constants ----------
 
 static constexpr uint8_t    kIna219Addr        = 0x40;
-static constexpr uint16_t   kIna219Config      = 0x399F;   // 32V, gain/8, 12-bit, continuous
+static constexpr uint8_t    kIna219RegConfig   = 0x00;
+static constexpr uint8_t    kIna219RegBus      = 0x02;
+static constexpr uint8_t    kIna219RegPower    = 0x03;
+static constexpr uint8_t    kIna219RegCurrent  = 0x04;
+static constexpr uint8_t    kIna219RegCalib    = 0x05;
+// 32V, gain/8, bus and shunt ADCs each averaging 32 12-bit samples (17.02 ms), continuous.
+static constexpr uint16_t   kIna219Config      = (1u << 13) | (3u << 11) | (0xDu << 7) | (0xDu << 3) | 0x7u;
+static constexpr int64_t    kIna219ConversionUs = 2 * 17'020;  // one bus + one shunt conversion
 static constexpr uint16_t   kIna219Calibration = 4096;
-static constexpr float      kIna219CurrentLsb  = 0.0002f;  // 200 uA
-static constexpr float      kIna219PowerLsb    = kIna219CurrentLsb * 20.0f;
-static constexpr float      kIna219BusLsb      = 0.004f;   // 4 mV
-static constexpr int        kIna219I2cFreqHz   = 100000;
-static constexpr TickType_t kIna219I2cTimeout  = pdMS_TO_TICKS(250);
+static constexpr float      kIna219CurrentLsb  = kInaCurrentLsb;
+static constexpr float      kIna219PowerLsb    = kInaPowerLsb;
+static constexpr float      kIna219BusLsb      = kInaBusVoltageLsb;
+static constexpr uint16_t   kIna219BusCnvr     = 1u << 1;  // conversion ready, cleared by a power read
+static constexpr uint16_t   kIna219BusOvf      = 1u << 0;  // math overflow
+static constexpr int        kIna219I2cFreqHz   = 400000;
+// A three-register batch takes ~0.4 ms at 400 kHz.
+static constexpr int        kIna219I2cTimeoutMs = 20;
+// The shared state gets the mean of the samples read over this period.
+static constexpr int64_t    kInaStatePeriodUs  = 200'000;
+static constexpr int        kInaMaxCnvrPolls   = 10;
+static constexpr int64_t    kInaCnvrPollUs     = 5'000;      // re-read when CNVR was still clear
+static constexpr int64_t    kInaRetryUs        = 1'000'000;  // after a failed read
+static constexpr int64_t    kInaReinitStepUs   = 5'000;      // between re-init register writes
+
+// ---------- fan tach constants ----------
+
+static constexpr int        kFanPulsesPerRev   = 2;
+static constexpr int        kFanPulsesPerBlock = 8;       // one PCNT interrupt per block
+static constexpr uint32_t   kFanGlitchNs       = 10'000;  // PCNT filter limit is ~12.7 us
+static constexpr int64_t    kFanStallUs        = 2'000'000;
+static constexpr int64_t    kFanSpinUpUs       = 5'000'000;
+static constexpr int64_t    kFanTachPeriodUs   = 200'000;
+
+// ---------- M1820 constants ----------
+
+static constexpr int64_t    kTempCyclePeriodUs       = 1'000'000;
+static constexpr int64_t    kTempSliceUs             = 10'000;  // conversion poll / read slice spacing
+static constexpr int        kTempReadsPerSlice       = 2;  // ~23 ms of bus time per slice
+static constexpr int        kTempConvertAttempts     = 3;
+static constexpr int64_t    kTempConvertRetryUs      = 50'000;  // a later slice, not a sleep
+static constexpr bool       kTempReadTemperatureOnly = false;
+static constexpr int64_t    kTempPresencePeriodUs    = 60'000'000;  // hot-plug search pass
+// Outlier filter on the published temperatures: the backend's temp_outliers.py window and
+// threshold. The sigma floor keeps sub-0.2 degC moves from being judged against a flat window.
+static constexpr size_t     kTempFilterWindow        = 9;
+static constexpr float      kTempFilterK             = 3.5f;
+static constexpr float      kTempFilterMinSigmaC     = 0.05f;
+static constexpr uint8_t    kTempHoldCycles          = 3;  // a failed sensor keeps its last value
+
+// ---------- acquisition scheduler constants ----------
+
+// Latest start past the due time before a run counts as an overrun. The ADC window opens
+// 2 ms ahead of the expected end of conversion, so that is all the slack it has.
+static constexpr int64_t  kAdcJobDeadlineUs  = 2'000;
+static constexpr int64_t  kInaJobDeadlineUs  = 10'000;
+static constexpr int64_t  kFanJobDeadlineUs  = 50'000;
+static constexpr int64_t  kTempJobDeadlineUs = 100'000;
+// Expected run time of one step, used to keep a job clear of more urgent ones.
+static constexpr int64_t  kInaJobBudgetUs    = 1'000;
+static constexpr int64_t  kFanJobBudgetUs    = 500;
+static constexpr int64_t  kTempJobBudgetUs   = 25'000;
+static constexpr int64_t  kAdcRetryUs        = 200'000;  // after a failed read
+static constexpr uint32_t kSchedStackBytes   = 6144;
 
 // ---------- module globals ----------
 
 static bool s_spi_bus_inited = false;
 
-static LTC2440 s_adc1(ADC_CS1, ADC_MISO, false);
-static LTC2440 s_adc2(ADC_CS2, ADC_MISO);
-static LTC2440 s_adc3(ADC_CS3, ADC_MISO);
+// One converter per ADC_CS_PINS entry; optional channels do not log their read errors.
+template <size_t... I>
+static std::array<LTC2440, sizeof...(I)> MakeAdcs(std::index_sequence<I...>) {
+  return {{LTC2440(ADC_CS_PINS[I], ADC_MISO, (ADC_OPTIONAL_MASK & (1u << I)) == 0)...}};
+}
+template <size_t... I>
+static std::array<LTC2440*, sizeof...(I)> AdcPointers(std::array<LTC2440, sizeof...(I)>& adcs,
+                                                      std::index_sequence<I...>) {
+  return {{&adcs[I]...}};
+}
+static std::array<LTC2440, ADC_CHANNEL_COUNT> s_adc_devices =
+    MakeAdcs(std::make_index_sequence<ADC_CHANNEL_COUNT>{});
+static const std::array<LTC2440*, ADC_CHANNEL_COUNT> s_adcs =
+    AdcPointers(s_adc_devices, std::make_index_sequence<ADC_CHANNEL_COUNT>{});
 
 static i2c_master_bus_handle_t s_i2c_bus   = nullptr;
 static i2c_master_dev_handle_t s_ina219_dev = nullptr;
 
-static volatile uint32_t s_fan1_pulses = 0;
-static volatile uint32_t s_fan2_pulses = 0;
+// The I2C bus runs in asynchronous mode: a batch queues all three register reads at once and
+// the task sleeps until the driver has run them back to back. Buffers must outlive the
+// queued transactions, hence static; only Ina219Job (or init before it runs) uses them.
+struct InaBatch {
+  uint8_t           regs[3] = {kIna219RegBus, kIna219RegCurrent, kIna219RegPower};
+  uint8_t           rx[3][2] = {};
+  uint8_t           tx[3] = {};  // register write payload (init only)
+  volatile uint32_t done = 0;
+  volatile uint32_t failed = 0;
+  volatile int64_t  first_done_us = 0;
+};
+static InaBatch s_ina_batch;
+static constexpr size_t kInaRingCapacity = 64;  // ~2.5 s of samples
+static InaSample             s_ina_ring_storage[kInaRingCapacity];
+static SampleRing<InaSample> s_ina_ring;
+
+// Every conversion AdcJob reads goes here; consumers keep their own cursors.
+static constexpr size_t kAdcRingCapacityPsram    = 1024;  // ~2.5 min at OSR 32768, 0.3 s at OSR 64
+static constexpr size_t kAdcRingCapacityInternal = 64;
+static SampleRing<AdcSample> s_adc_ring;
+// Raw burst arena: 2 MiB of PSRAM holds ~37 s at OSR 64. Only AdcJob writes records, and
+// only while capturing; phase transitions and the reader count go through s_burst_mux.
+static constexpr size_t   kAdcBurstArenaBytes = 2 * 1024 * 1024;
+static constexpr float    kAdcBurstMaxSeconds = 600.0f;
+// An OSR switch takes effect within two readouts (~0.3 s at OSR 32768); a channel that
+// never reads back must not leave the capture armed at the burst speed.
+static constexpr int64_t  kAdcBurstArmTimeoutUs = 3'000'000;
+static AdcBurstRecord*    s_burst_records     = nullptr;
+static uint32_t           s_burst_capacity    = 0;
+static portMUX_TYPE       s_burst_mux         = portMUX_INITIALIZER_UNLOCKED;
+static AdcBurstPhase      s_burst_phase       = AdcBurstPhase::kIdle;
+static uint32_t           s_burst_readers     = 0;
+static uint32_t           s_burst_count       = 0;
+static uint32_t           s_burst_errors      = 0;
+static uint32_t           s_burst_skip        = 0;
+static int64_t            s_burst_start_us    = 0;
+static int64_t            s_burst_armed_us    = 0;
+static int64_t            s_burst_duration_us = 0;
+static uint16_t           s_burst_osr         = 0;
+static std::array<uint16_t, ADC_CHANNEL_COUNT> s_burst_ran_osr{};
+
+// The shared state only needs the voltages for display/control; at fast OSR settings the
+// ring carries every conversion and the state gets block means spanning at least
+// app_config.adc_state_period_ms. A 3-point median ahead of the block mean keeps a single
+// glitch frame out of the displayed value.
+using AdcStateFilter = FilterChain<RunningMedian<3>, BoxcarDecimator>;
+static std::array<AdcStateFilter, ADC_CHANNEL_COUNT> s_adc_state_filters;
+
+// Live statistics: the accumulators belong to AdcJob; readers get the snapshot it publishes
+// under s_stats_mux. The Allan sum history (32 KiB per channel) lives in PSRAM.
+struct AdcChannelAccumulators {
+  IntegerStats                      stats;
+  AllanAccumulator<kAdcAllanLevels> allan;
+  uint32_t                          gaps = 0;
+};
+static std::array<AdcChannelAccumulators, ADC_CHANNEL_COUNT> s_stats_acc;
+static std::array<uint16_t, ADC_CHANNEL_COUNT>               s_stats_osr{};
+static int64_t          s_stats_first_us        = 0;
+static int64_t          s_stats_last_us         = 0;
+static uint32_t         s_stats_sets            = 0;
+static bool             s_stats_reset_requested = false;
+static portMUX_TYPE     s_stats_mux             = portMUX_INITIALIZER_UNLOCKED;
+static AdcStatsSnapshot s_stats_snapshot{};
+
+// Fan tachometers count in PCNT units that wrap every kFanPulsesPerBlock pulses; the wrap
+// callback timestamps each block, so the RPM comes from the exact time of the last N pulses
+// with one interrupt per block instead of one per edge.
+struct FanTach {
+  gpio_num_t         pin;
+  pcnt_unit_handle_t unit = nullptr;
+  int64_t            block_end_us = 0;     // written by the PCNT callback
+  uint32_t           block_period_us = 0;  // written by the PCNT callback, 0 until two blocks
+  // FanTachJob only.
+  int                last_count = 0;
+  int64_t            last_move_us = 0;
+  int64_t            spin_up_until_us = 0;
+  bool               stalled = false;
+};
+static std::array<FanTach, 2> s_fans = {{{FAN1_TACH}, {FAN2_TACH}}};
+static portMUX_TYPE           s_fan_mux = portMUX_INITIALIZER_UNLOCKED;
 
 // ---------- ISR ----------
 
-static void IRAM_ATTR FanTachIsr(void* arg) {
-  uint32_t gpio = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg));
-  if (gpio == static_cast<uint32_t>(FAN1_TACH)) {
-    __atomic_fetch_add(&s_fan1_pulses, 1, __ATOMIC_RELAXED);
-  } else if (gpio == static_cast<uint32_t>(FAN2_TACH)) {
-    __atomic_fetch_add(&s_fan2_pulses, 1, __ATOMIC_RELAXED);
+static bool IRAM_ATTR FanBlockDone(pcnt_unit_handle_t, const pcnt_watch_event_data_t*, void* ctx) {
+  auto* fan = static_cast<FanTach*>(ctx);
+  const int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL_ISR(&s_fan_mux);
+  if (fan->block_end_us > 0) fan->block_period_us = static_cast<uint32_t>(now_us - fan->block_end_us);
+  fan->block_end_us = now_us;
+  portEXIT_CRITICAL_ISR(&s_fan_mux);
+  return false;
+}
+
+static bool IRAM_ATTR InaTransDone(i2c_master_dev_handle_t, const i2c_master_event_data_t* evt, void*) {
+  if (evt->event == I2C_EVENT_DONE) {
+    if (s_ina_batch.done++ == 0) s_ina_batch.first_done_us = esp_timer_get_time();
+  } else {
+    s_ina_batch.failed++;
   }
+  return false;
 }
 
 // ---------- public utilities ----------
@@ -79,34 +243,48 @@ void EnsureGpioIsrServiceInstalled() {
   ESP_ERROR_CHECK(err);
 }
 
-static inline uint64_t GpioMaskSafe(gpio_num_t pin) {
-  if (pin == GPIO_NUM_NC || static_cast<int>(pin) < 0) return 0;
-  return 1ULL << static_cast<unsigned>(pin);
+static esp_err_t InitFanTach(FanTach* fan) {
+  pcnt_unit_config_t unit_cfg = {};
+  unit_cfg.low_limit  = -1;
+  unit_cfg.high_limit = kFanPulsesPerBlock;
+  ESP_RETURN_ON_ERROR(pcnt_new_unit(&unit_cfg, &fan->unit), kTag, "PCNT unit failed");
+  pcnt_glitch_filter_config_t filter_cfg = {};
+  filter_cfg.max_glitch_ns = kFanGlitchNs;
+  ESP_RETURN_ON_ERROR(pcnt_unit_set_glitch_filter(fan->unit, &filter_cfg), kTag, "PCNT filter failed");
+
+  pcnt_chan_config_t chan_cfg = {};
+  chan_cfg.edge_gpio_num  = fan->pin;
+  chan_cfg.level_gpio_num = -1;
+  pcnt_channel_handle_t chan = nullptr;
+  ESP_RETURN_ON_ERROR(pcnt_new_channel(fan->unit, &chan_cfg, &chan), kTag, "PCNT channel failed");
+  ESP_RETURN_ON_ERROR(pcnt_channel_set_edge_action(chan, PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                                   PCNT_CHANNEL_EDGE_ACTION_HOLD),
+                      kTag, "PCNT edge action failed");
+  gpio_pullup_en(fan->pin);
+
+  ESP_RETURN_ON_ERROR(pcnt_unit_add_watch_point(fan->unit, kFanPulsesPerBlock), kTag,
+                      "PCNT watch point failed");
+  pcnt_event_callbacks_t cbs = {};
+  cbs.on_reach = &FanBlockDone;
+  ESP_RETURN_ON_ERROR(pcnt_unit_register_event_callbacks(fan->unit, &cbs, fan), kTag,
+                      "PCNT callback failed");
+  ESP_RETURN_ON_ERROR(pcnt_unit_enable(fan->unit), kTag, "PCNT enable failed");
+  ESP_RETURN_ON_ERROR(pcnt_unit_clear_count(fan->unit), kTag, "PCNT clear failed");
+  return pcnt_unit_start(fan->unit);
 }
 
 void SensorHubInitGpios() {
-  if (ETH_INT != GPIO_NUM_NC || FAN1_TACH != GPIO_NUM_NC || FAN2_TACH != GPIO_NUM_NC) {
+  if (ETH_INT != GPIO_NUM_NC) {
     EnsureGpioIsrServiceInstalled();
   }
 
-  const uint64_t pin_mask = GpioMaskSafe(FAN1_TACH) | GpioMaskSafe(FAN2_TACH);
-  if (pin_mask == 0) return;
-
-  gpio_config_t tach_conf = {};
-  tach_conf.intr_type     = GPIO_INTR_POSEDGE;
-  tach_conf.mode          = GPIO_MODE_INPUT;
-  tach_conf.pin_bit_mask  = pin_mask;
-  tach_conf.pull_up_en    = GPIO_PULLUP_ENABLE;
-  tach_conf.pull_down_en  = GPIO_PULLDOWN_DISABLE;
-  ESP_ERROR_CHECK(gpio_config(&tach_conf));
-
-  if (FAN1_TACH != GPIO_NUM_NC) {
-    ESP_ERROR_CHECK(gpio_isr_handler_add(FAN1_TACH, FanTachIsr,
-                                         reinterpret_cast<void*>(static_cast<uintptr_t>(FAN1_TACH))));
-  }
-  if (FAN2_TACH != GPIO_NUM_NC) {
-    ESP_ERROR_CHECK(gpio_isr_handler_add(FAN2_TACH, FanTachIsr,
-                                         reinterpret_cast<void*>(static_cast<uintptr_t>(FAN2_TACH))));
+  for (FanTach& fan : s_fans) {
+    if (fan.pin == GPIO_NUM_NC) continue;
+    esp_err_t err = InitFanTach(&fan);
+    if (err != ESP_OK) {
+      ESP_LOGE(kTag, "Fan tach on GPIO %d disabled: %s", static_cast<int>(fan.pin), esp_err_to_name(err));
+      fan.unit = nullptr;
+    }
   }
 }
 
@@ -119,6 +297,7 @@ esp_err_t InitSpiBus() {
   buscfg.quadwp_io_num = -1;
   buscfg.quadhd_io_num = -1;
   buscfg.max_transfer_sz = 1536;
+  SpiArbiterInit();
   esp_err_t ret = spi_bus_initialize(SPI2_HOST, &buscfg, SPI_DMA_CH_AUTO);
   if (ret == ESP_ERR_INVALID_STATE) {
     s_spi_bus_inited = true;
@@ -132,13 +311,43 @@ esp_err_t InitSpiBus() {
 
 esp_err_t SensorHubInitAdcs() {
   ESP_RETURN_ON_ERROR(InitSpiBus(), kTag, "SPI bus init failed");
-  ESP_RETURN_ON_ERROR(s_adc1.Init(SPI2_HOST, ADC_SPI_FREQ_HZ), kTag, "ADC1 init failed");
-  ESP_RETURN_ON_ERROR(s_adc2.Init(SPI2_HOST, ADC_SPI_FREQ_HZ), kTag, "ADC2 init failed");
-  ESP_RETURN_ON_ERROR(s_adc3.Init(SPI2_HOST, ADC_SPI_FREQ_HZ), kTag, "ADC3 init failed");
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    esp_err_t err = s_adcs[i]->Init(SPI2_HOST, ADC_SPI_FREQ_HZ);
+    if (err != ESP_OK) {
+      ESP_LOGE(kTag, "ADC%d init failed: %s", i + 1, esp_err_to_name(err));
+      return err;
+    }
+  }
+
+  // DRDY interrupts only change pacing; any failure leaves that ADC on the fixed guard.
+  EnsureGpioIsrServiceInstalled();
+  for (LTC2440* adc : s_adcs) {
+    esp_err_t err = adc->EnableDrdyInterrupt();
+    if (err != ESP_OK) {
+      ESP_LOGW(kTag, "ADC DRDY interrupt unavailable (%s), using fixed guard", esp_err_to_name(err));
+    }
+  }
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    if (SensorHubSetAdcOsr(i, app_config.adc_osr[i]) != ESP_OK) {
+      ESP_LOGW(kTag, "ADC%d: unsupported OSR %u, keeping %u", i + 1,
+               static_cast<unsigned>(app_config.adc_osr[i]), static_cast<unsigned>(s_adcs[i]->osr()));
+    }
+  }
   return ESP_OK;
 }
 
-esp_err_t SensorHubInitIna() {
+esp_err_t SensorHubSetAdcOsr(int channel, uint16_t osr) {
+  if (channel < 0 || channel >= ADC_CHANNEL_COUNT) return ESP_ERR_INVALID_ARG;
+  return s_adcs[channel]->SetOsr(osr);
+}
+
+uint16_t SensorHubGetAdcOsr(int channel) {
+  if (channel < 0 || channel >= ADC_CHANNEL_COUNT) return 0;
+  return s_adcs[channel]->osr();
+}
+
+// Bus, device and ring; no bus traffic, so the re-init slices can call it too.
+static esp_err_t AttachIna219() {
   if (!s_i2c_bus) {
     i2c_master_bus_config_t bus_cfg = {};
     bus_cfg.i2c_port              = I2C_NUM_0;
@@ -147,7 +356,7 @@ esp_err_t SensorHubInitIna() {
     bus_cfg.clk_source            = I2C_CLK_SRC_DEFAULT;
     bus_cfg.glitch_ignore_cnt     = 7;
     bus_cfg.intr_priority         = 0;
-    bus_cfg.trans_queue_depth     = 0;
+    bus_cfg.trans_queue_depth     = 4;  // asynchronous: room for one batch
     bus_cfg.flags.enable_internal_pullup = true;
     ESP_RETURN_ON_ERROR(i2c_new_master_bus(&bus_cfg, &s_i2c_bus), kTag, "I2C bus init failed");
   }
@@ -159,261 +368,985 @@ esp_err_t SensorHubInitIna() {
     dev_cfg.scl_speed_hz = kIna219I2cFreqHz;
     ESP_RETURN_ON_ERROR(i2c_master_bus_add_device(s_i2c_bus, &dev_cfg, &s_ina219_dev), kTag,
                         "INA219 attach failed");
+    i2c_master_event_callbacks_t cbs = {};
+    cbs.on_trans_done = &InaTransDone;
+    ESP_RETURN_ON_ERROR(i2c_master_register_event_callbacks(s_ina219_dev, &cbs, nullptr), kTag,
+                        "INA219 callback registration failed");
   }
+  if (!s_ina_ring.ready()) s_ina_ring.Attach(s_ina_ring_storage, kInaRingCapacity);
+  return ESP_OK;
+}
 
-  auto write_reg = [](uint8_t reg, uint16_t value) -> esp_err_t {
-    uint8_t payload[3] = {
-        reg,
-        static_cast<uint8_t>((value >> 8) & 0xFF),
-        static_cast<uint8_t>(value & 0xFF),
-    };
-    return i2c_master_transmit(s_ina219_dev, payload, sizeof(payload), kIna219I2cTimeout);
-  };
+// Writes are queued like every transaction on the async bus, so the payload lives in the
+// static batch: a wait that times out must not leave the driver holding a stack pointer.
+static esp_err_t WriteIna219Reg(uint8_t reg, uint16_t value) {
+  uint8_t* payload = s_ina_batch.tx;
+  payload[0] = reg;
+  payload[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+  payload[2] = static_cast<uint8_t>(value & 0xFF);
+  s_ina_batch.failed = 0;
+  esp_err_t err =
+      i2c_master_transmit(s_ina219_dev, payload, sizeof(s_ina_batch.tx), kIna219I2cTimeoutMs);
+  const esp_err_t wait_err = i2c_master_bus_wait_all_done(s_i2c_bus, kIna219I2cTimeoutMs);
+  if (err == ESP_OK) err = wait_err;
+  if (err == ESP_OK && s_ina_batch.failed) err = ESP_FAIL;
+  return err;
+}
 
-  ESP_RETURN_ON_ERROR(write_reg(0x00, kIna219Config), kTag, "INA219 config failed");
-  ESP_RETURN_ON_ERROR(write_reg(0x05, kIna219Calibration), kTag, "INA219 calibration failed");
+esp_err_t SensorHubInitIna() {
+  ESP_RETURN_ON_ERROR(AttachIna219(), kTag, "INA219 setup failed");
+  ESP_RETURN_ON_ERROR(WriteIna219Reg(kIna219RegConfig, kIna219Config), kTag, "INA219 config failed");
+  ESP_RETURN_ON_ERROR(WriteIna219Reg(kIna219RegCalib, kIna219Calibration), kTag,
+                      "INA219 calibration failed");
   ESP_LOGI(kTag, "INA219 initialized");
   return ESP_OK;
 }
 
 bool WaitForTempSensors(int timeout_ms) {
   if (timeout_ms <= 0) {
-    return CopyState().temp_sensor_count > 0;
+    return ReadThermalState().temp_sensor_count > 0;
   }
   const int64_t deadline = esp_timer_get_time() + static_cast<int64_t>(timeout_ms) * 1000;
   while (esp_timer_get_time() < deadline) {
-    if (CopyState().temp_sensor_count > 0) return true;
+    if (ReadThermalState().temp_sensor_count > 0) return true;
     vTaskDelay(pdMS_TO_TICKS(200));
   }
-  return CopyState().temp_sensor_count > 0;
+  return ReadThermalState().temp_sensor_count > 0;
 }
 
 // ---------- private helpers ----------
 
-static esp_err_t ReadIna219() {
+// Reads one averaged conversion as a single queued batch (bus, current, power). Returns
+// ESP_ERR_NOT_FINISHED while CNVR is clear, i.e. the registers still hold the last sample.
+static esp_err_t ReadIna219(InaSample* out) {
   if (!s_ina219_dev) {
     ErrorManagerSetLocal(ErrorCode::kInaRead, ErrorSeverity::kWarning, "INA219 not initialized");
     return ESP_ERR_INVALID_STATE;
   }
-  auto read_reg = [](uint8_t reg, uint16_t* value) -> esp_err_t {
-    if (!value) return ESP_ERR_INVALID_ARG;
-    uint8_t reg_addr = reg;
-    uint8_t rx[2]    = {};
-    esp_err_t res =
-        i2c_master_transmit_receive(s_ina219_dev, &reg_addr, sizeof(reg_addr), rx, sizeof(rx), kIna219I2cTimeout);
-    if (res == ESP_OK) {
-      *value = static_cast<uint16_t>(static_cast<uint16_t>(rx[0]) << 8 | static_cast<uint16_t>(rx[1]));
-    }
-    return res;
-  };
-
-  uint16_t bus_raw = 0, current_raw = 0, power_raw = 0;
-
-  esp_err_t err = read_reg(0x02, &bus_raw);
-  if (err != ESP_OK) {
-    ErrorManagerSetLocal(ErrorCode::kInaRead, ErrorSeverity::kWarning,
-                         std::string("INA219 read bus failed (i2c): ") + esp_err_to_name(err));
-    return err;
-  }
-  err = read_reg(0x04, &current_raw);
-  if (err != ESP_OK) {
-    ErrorManagerSetLocal(ErrorCode::kInaRead, ErrorSeverity::kWarning,
-                         std::string("INA219 read current failed (i2c): ") + esp_err_to_name(err));
-    return err;
+  InaBatch& b = s_ina_batch;
+  b.done = 0;
+  b.failed = 0;
+  esp_err_t err = ESP_OK;
+  for (int i = 0; i < 3 && err == ESP_OK; ++i) {
+    err = i2c_master_transmit_receive(s_ina219_dev, &b.regs[i], 1, b.rx[i], sizeof(b.rx[i]),
+                                      kIna219I2cTimeoutMs);
   }
-  err = read_reg(0x03, &power_raw);
+  // Even after a queueing error, drain what was queued before the buffers are reused.
+  const esp_err_t wait_err = i2c_master_bus_wait_all_done(s_i2c_bus, kIna219I2cTimeoutMs);
+  if (err == ESP_OK) err = wait_err;
+  if (err == ESP_OK && (b.failed || b.done != 3)) err = ESP_FAIL;
   if (err != ESP_OK) {
     ErrorManagerSetLocal(ErrorCode::kInaRead, ErrorSeverity::kWarning,
-                         std::string("INA219 read power failed (i2c): ") + esp_err_to_name(err));
+                         std::string("INA219 batch read failed (i2c): ") + esp_err_to_name(err));
     return err;
   }
 
-  const float bus_v     = static_cast<float>((bus_raw >> 3) & 0x1FFF) * kIna219BusLsb;
-  const float current_a = static_cast<float>(static_cast<int16_t>(current_raw)) * kIna219CurrentLsb;
-  const float power_w   = static_cast<float>(static_cast<uint16_t>(power_raw)) * kIna219PowerLsb;
+  auto reg = [&](int i) {
+    return static_cast<uint16_t>(static_cast<uint16_t>(b.rx[i][0]) << 8 | b.rx[i][1]);
+  };
+  const uint16_t bus_raw     = reg(0);
+  const uint16_t current_raw = reg(1);
+  const uint16_t power_raw   = reg(2);
+  if (!(bus_raw & kIna219BusCnvr)) return ESP_ERR_NOT_FINISHED;
 
-  UpdateState([&](SharedState& s) {
-    s.ina_bus_voltage = bus_v;
-    s.ina_current     = current_a;
-    s.ina_power       = power_w;
-  });
+  out->timestamp_us = b.first_done_us;
+  out->bus_v        = static_cast<float>((bus_raw >> 3) & 0x1FFF) * kIna219BusLsb;
+  out->current_a    = static_cast<float>(static_cast<int16_t>(current_raw)) * kIna219CurrentLsb;
+  out->power_w      = static_cast<float>(power_raw) * kIna219PowerLsb;
+  out->overflow     = (bus_raw & kIna219BusOvf) != 0;
   ErrorManagerClearLocal(ErrorCode::kInaRead);
   return ESP_OK;
 }
 
 struct TempMeta {
-  std::array<std::string, MAX_TEMP_SENSORS> labels{};
-  std::array<std::string, MAX_TEMP_SENSORS> addresses{};
+  std::array<TempLabelString, MAX_TEMP_SENSORS> labels{};
+  std::array<TempAddressString, MAX_TEMP_SENSORS> addresses{};
 };
 
-static std::string FormatOneWireAddress(uint64_t address) {
-  char buf[20];
-  std::snprintf(buf, sizeof(buf), "0x%016llX", static_cast<unsigned long long>(address));
-  return std::string(buf);
-}
-
 static TempMeta BuildTempMeta(int count) {
   TempMeta meta{};
   uint64_t addrs[MAX_TEMP_SENSORS]{};
   const int addr_count = M1820GetAddresses(addrs, MAX_TEMP_SENSORS);
   const int capped     = std::min(count, MAX_TEMP_SENSORS);
+  char buf[TEMP_ADDRESS_MAX_LEN + 1];
   for (int i = 0; i < capped; ++i) {
-    if (i < addr_count) {
-      meta.addresses[i] = FormatOneWireAddress(addrs[i]);
-      meta.labels[i]    = "T" + std::to_string(i + 1);
+    if (i < addr_count && addrs[i] != 0) {
+      std::snprintf(buf, sizeof(buf), "0x%016llX", static_cast<unsigned long long>(addrs[i]));
+      meta.addresses[i] = buf;
+      std::snprintf(buf, sizeof(buf), "T%d", i + 1);
+      meta.labels[i] = buf;
     }
   }
   return meta;
 }
 
-// ---------- public ReadAllAdc ----------
+// ---------- ADC conversions ----------
 
-esp_err_t ReadAllAdc(float* v1, float* v2, float* v3) {
-  int32_t raw1 = 0, raw2 = 0, raw3 = 0;
-  esp_err_t err = s_adc1.Read(&raw1);
-  if (err != ESP_OK) {
-    raw1 = 0;
-  }
-  err = s_adc2.Read(&raw2);
-  if (err != ESP_OK) {
-    ESP_LOGW(kTag, "ADC2 read failed: %s", esp_err_to_name(err));
-    ErrorManagerSet(ErrorCode::kAdcRead, ErrorSeverity::kError, "ADC2 read failed");
-    return err;
+// All converters are read in one bus window and restarted together, so each set is a
+// simultaneous sample sharing one timestamp.
+static esp_err_t ReadAllAdcRaw(AdcSample* sample) {
+  esp_err_t results[ADC_CHANNEL_COUNT];
+  LTC2440::ReadPipelined(s_adcs.data(), ADC_CHANNEL_COUNT, sample->raw, results);
+  sample->timestamp_us = esp_timer_get_time();
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    if (results[i] != ESP_OK) continue;
+    sample->valid_mask |= static_cast<uint8_t>(1u << i);
+    sample->ready_us[i] = s_adcs[i]->last_ready_us();
   }
-  err = s_adc3.Read(&raw3);
-  if (err != ESP_OK) {
-    ESP_LOGW(kTag, "ADC3 read failed: %s", esp_err_to_name(err));
-    ErrorManagerSet(ErrorCode::kAdcRead, ErrorSeverity::kError, "ADC3 read failed");
-    return err;
+  // Optional channels may fail soft (raw stays 0); the others are required.
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    if (results[i] == ESP_OK || (ADC_OPTIONAL_MASK & (1u << i))) continue;
+    char msg[24];
+    std::snprintf(msg, sizeof(msg), "ADC%d read failed", i + 1);
+    ESP_LOGW(kTag, "%s: %s", msg, esp_err_to_name(results[i]));
+    ErrorManagerSet(ErrorCode::kAdcRead, ErrorSeverity::kError, msg);
+    return results[i];
   }
-  *v1 = static_cast<float>(raw1) * kAdcScale;
-  *v2 = static_cast<float>(raw2) * kAdcScale;
-  *v3 = static_cast<float>(raw3) * kAdcScale;
   ErrorManagerClear(ErrorCode::kAdcRead);
   return ESP_OK;
 }
 
-// ---------- tasks ----------
+static void AllocateAdcRing() {
+  if (s_adc_ring.ready()) return;
+  size_t capacity = kAdcRingCapacityPsram;
+  void* storage = heap_caps_calloc(capacity, sizeof(AdcSample), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!storage) {
+    capacity = kAdcRingCapacityInternal;
+    storage = heap_caps_calloc(capacity, sizeof(AdcSample), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  }
+  if (!storage || !s_adc_ring.Attach(static_cast<AdcSample*>(storage), capacity)) {
+    ESP_LOGE(kTag, "ADC sample ring allocation failed");
+    return;
+  }
+  ESP_LOGI(kTag, "ADC sample ring: %u samples", static_cast<unsigned>(capacity));
+}
 
-static void AdcTask(void*) {
-  while (true) {
-    float v1 = 0.0f, v2 = 0.0f, v3 = 0.0f;
-    if (ReadAllAdc(&v1, &v2, &v3) == ESP_OK) {
-      const uint64_t now_ms = esp_timer_get_time() / 1000ULL;
-      UpdateState([&](SharedState& s) {
-        s.voltage1     = v1 - s.offset1;
-        s.voltage2     = v2 - s.offset2;
-        s.voltage3     = v3 - s.offset3;
-        s.voltage1_cal = v1;
-        s.voltage2_cal = v2;
-        s.voltage3_cal = v3;
-        s.last_update_ms = now_ms;
-      });
+float AdcCodeToVolts(int32_t code) {
+  return static_cast<float>(code) * kAdcScale;
+}
+
+AdcSampleCursor AdcSamplesOpenCursor() {
+  AdcSampleCursor cursor;
+  cursor.next_seq = s_adc_ring.head();
+  return cursor;
+}
+
+bool AdcSamplesRead(AdcSampleCursor* cursor, AdcSample* out, TickType_t timeout) {
+  if (!cursor || !out) return false;
+  // Conversions arrive every ~150 ms or more, so a short poll costs nothing measurable.
+  constexpr TickType_t kPoll = pdMS_TO_TICKS(5) > 0 ? pdMS_TO_TICKS(5) : 1;
+  const TickType_t start = xTaskGetTickCount();
+  while (!s_adc_ring.Read(&cursor->next_seq, out, &cursor->lost)) {
+    const TickType_t waited = xTaskGetTickCount() - start;
+    if (waited >= timeout) return false;
+    vTaskDelay(std::min<TickType_t>(kPoll, timeout - waited));
+  }
+  return true;
+}
+
+InaSampleCursor InaSamplesOpenCursor() {
+  InaSampleCursor cursor;
+  cursor.next_seq = s_ina_ring.head();
+  return cursor;
+}
+
+bool InaSamplesRead(InaSampleCursor* cursor, InaSample* out, TickType_t timeout) {
+  if (!cursor || !out) return false;
+  const TickType_t start = xTaskGetTickCount();
+  while (!s_ina_ring.Read(&cursor->next_seq, out, &cursor->lost)) {
+    const TickType_t waited = xTaskGetTickCount() - start;
+    if (waited >= timeout) return false;
+    vTaskDelay(1);
+  }
+  return true;
+}
+
+// ---------- ADC burst capture ----------
+
+static void AllocateAdcBurstArena() {
+  if (s_burst_records) return;
+  void* arena = heap_caps_malloc(kAdcBurstArenaBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!arena) {
+    ESP_LOGW(kTag, "ADC burst arena unavailable (no PSRAM), burst capture disabled");
+    return;
+  }
+  s_burst_records  = static_cast<AdcBurstRecord*>(arena);
+  s_burst_capacity = kAdcBurstArenaBytes / sizeof(AdcBurstRecord);
+  ESP_LOGI(kTag, "ADC burst arena: %u records", static_cast<unsigned>(s_burst_capacity));
+}
+
+static AdcBurstPhase BurstPhase() {
+  portENTER_CRITICAL(&s_burst_mux);
+  const AdcBurstPhase phase = s_burst_phase;
+  portEXIT_CRITICAL(&s_burst_mux);
+  return phase;
+}
+
+static void SetBurstPhase(AdcBurstPhase phase) {
+  portENTER_CRITICAL(&s_burst_mux);
+  s_burst_phase = phase;
+  portEXIT_CRITICAL(&s_burst_mux);
+}
+
+// Called by AdcJob for every pipelined read, successful or not.
+static void AdcBurstCapture(const AdcSample& sample, bool ok) {
+  const AdcBurstPhase phase = BurstPhase();
+  if (phase == AdcBurstPhase::kArmed) {
+    if (s_burst_osr != 0) {
+      if (esp_timer_get_time() - s_burst_armed_us > kAdcBurstArmTimeoutUs) {
+        for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) SensorHubSetAdcOsr(i, app_config.adc_osr[i]);
+        SetBurstPhase(AdcBurstPhase::kAborted);
+        ESP_LOGW(kTag, "ADC burst aborted: no conversion at osr %u within %lld ms",
+                 static_cast<unsigned>(s_burst_osr),
+                 static_cast<long long>(kAdcBurstArmTimeoutUs / 1000));
+        return;
+      }
+      // osr() flips when the readout that sends the new OSR completes; the sample that
+      // readout returned still came from the old OSR, so skip one more. Channels that did
+      // not answer cannot flip and are not waited for.
+      if (sample.valid_mask == 0) return;
+      for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+        if ((sample.valid_mask & (1u << i)) && s_adcs[i]->osr() != s_burst_osr) return;
+      }
+      if (s_burst_skip > 0) {
+        --s_burst_skip;
+        return;
+      }
     }
-    vTaskDelay(pdMS_TO_TICKS(200));
+    for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) s_burst_ran_osr[i] = s_adcs[i]->osr();
+    s_burst_start_us = sample.timestamp_us;
+    s_burst_errors   = 0;
+    __atomic_store_n(&s_burst_count, 0u, __ATOMIC_RELAXED);
+    SetBurstPhase(AdcBurstPhase::kCapturing);
+  } else if (phase != AdcBurstPhase::kCapturing) {
+    return;
+  }
+
+  const uint32_t index = s_burst_count;
+  AdcBurstRecord& rec = s_burst_records[index];
+  rec.t_us = static_cast<uint32_t>(sample.timestamp_us - s_burst_start_us);
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    rec.raw[i] = (sample.valid_mask & (1u << i)) ? sample.raw[i] : kAdcBurstInvalidCode;
+  }
+  if (!ok) ++s_burst_errors;
+  __atomic_store_n(&s_burst_count, index + 1, __ATOMIC_RELEASE);
+
+  if (index + 1 >= s_burst_capacity || sample.timestamp_us - s_burst_start_us >= s_burst_duration_us) {
+    if (s_burst_osr != 0) {
+      for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) SensorHubSetAdcOsr(i, app_config.adc_osr[i]);
+    }
+    SetBurstPhase(AdcBurstPhase::kDone);
+    ESP_LOGI(kTag, "ADC burst done: %u records in %.3f s, %u read errors",
+             static_cast<unsigned>(index + 1),
+             static_cast<double>(sample.timestamp_us - s_burst_start_us) / 1e6,
+             static_cast<unsigned>(s_burst_errors));
+  }
+}
+
+esp_err_t AdcBurstStart(float seconds, uint16_t osr) {
+  if (!(seconds > 0.0f) || seconds > kAdcBurstMaxSeconds) return ESP_ERR_INVALID_ARG;
+  if (osr != 0 && !IsValidAdcOsr(osr)) return ESP_ERR_INVALID_ARG;
+  if (!s_burst_records) return ESP_ERR_NO_MEM;
+
+  portENTER_CRITICAL(&s_burst_mux);
+  const bool busy = s_burst_phase == AdcBurstPhase::kArmed ||
+                    s_burst_phase == AdcBurstPhase::kCapturing || s_burst_readers > 0;
+  if (!busy) {
+    s_burst_duration_us = static_cast<int64_t>(seconds * 1e6f);
+    s_burst_osr         = osr;
+    s_burst_skip        = 1;
+    s_burst_armed_us    = esp_timer_get_time();
+    s_burst_phase       = AdcBurstPhase::kArmed;
+  }
+  portEXIT_CRITICAL(&s_burst_mux);
+  if (busy) return ESP_ERR_INVALID_STATE;
+
+  if (osr != 0) {
+    for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) SensorHubSetAdcOsr(i, osr);
+  }
+  ESP_LOGI(kTag, "ADC burst armed: %.3f s, osr %u", static_cast<double>(seconds),
+           static_cast<unsigned>(osr));
+  return ESP_OK;
+}
+
+AdcBurstStatus AdcBurstGetStatus() {
+  AdcBurstStatus status{};
+  status.phase       = BurstPhase();
+  status.records     = status.phase == AdcBurstPhase::kArmed
+                           ? 0
+                           : __atomic_load_n(&s_burst_count, __ATOMIC_ACQUIRE);
+  status.capacity    = s_burst_capacity;
+  status.read_errors = s_burst_errors;
+  return status;
+}
+
+bool AdcBurstAcquire(AdcBurstHeader* header, const AdcBurstRecord** records) {
+  if (!header || !records) return false;
+  portENTER_CRITICAL(&s_burst_mux);
+  const bool done = s_burst_phase == AdcBurstPhase::kDone;
+  if (done) ++s_burst_readers;
+  portEXIT_CRITICAL(&s_burst_mux);
+  if (!done) return false;
+
+  *header = {};
+  std::memcpy(header->magic, "ADCB", sizeof(header->magic));
+  header->version        = 1;
+  header->channels       = ADC_CHANNEL_COUNT;
+  header->record_count   = __atomic_load_n(&s_burst_count, __ATOMIC_ACQUIRE);
+  header->record_bytes   = sizeof(AdcBurstRecord);
+  header->start_us       = s_burst_start_us;
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) header->osr[i] = s_burst_ran_osr[i];
+  header->volts_per_code = kAdcScale;
+  header->read_errors    = s_burst_errors;
+  *records = s_burst_records;
+  return true;
+}
+
+void AdcBurstRelease() {
+  portENTER_CRITICAL(&s_burst_mux);
+  if (s_burst_readers > 0) --s_burst_readers;
+  portEXIT_CRITICAL(&s_burst_mux);
+}
+
+// ---------- live statistics ----------
+
+static void AllocateAdcStatsHistory() {
+  if (s_stats_acc[0].allan.ready()) return;
+  constexpr size_t kPerChannel = AllanAccumulator<kAdcAllanLevels>::kHistory;
+  void* history = heap_caps_malloc(kPerChannel * sizeof(int64_t) * ADC_CHANNEL_COUNT,
+                                   MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!history) {
+    ESP_LOGW(kTag, "ADC Allan history unavailable (no PSRAM), Allan deviation disabled");
+    return;
+  }
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    s_stats_acc[i].allan.Attach(static_cast<int64_t*>(history) + i * kPerChannel);
+  }
+}
+
+static void AdcStatsRestart() {
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    s_stats_acc[i].stats.Reset();
+    s_stats_acc[i].allan.Reset();
+    s_stats_acc[i].gaps = 0;
+    s_stats_osr[i]      = s_adcs[i]->osr();
+  }
+  s_stats_first_us = 0;
+  s_stats_last_us  = 0;
+  s_stats_sets     = 0;
+}
+
+// Called by AdcJob for every pipelined read, successful or not.
+static void AdcStatsPush(const AdcSample& sample, bool ok) {
+  bool restart = __atomic_exchange_n(&s_stats_reset_requested, false, __ATOMIC_ACQ_REL);
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) restart |= s_adcs[i]->osr() != s_stats_osr[i];
+  if (restart) AdcStatsRestart();
+  if (!ok) {
+    for (AdcChannelAccumulators& acc : s_stats_acc) ++acc.gaps;
+    return;
+  }
+  if (s_stats_sets++ == 0) s_stats_first_us = sample.timestamp_us;
+  s_stats_last_us = sample.timestamp_us;
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    AdcChannelAccumulators& acc = s_stats_acc[i];
+    if (!(sample.valid_mask & (1u << i))) {
+      ++acc.gaps;
+      continue;
+    }
+    acc.stats.Push(sample.raw[i]);
+    acc.allan.Push(sample.raw[i]);
   }
 }
 
-static void Ina219Task(void*) {
+static void AdcStatsPublish() {
+  AdcStatsSnapshot snap{};
+  snap.since_us        = s_stats_first_us;
+  snap.allan_available = s_stats_acc[0].allan.ready();
+  if (s_stats_sets > 1) {
+    snap.tau0_s = static_cast<float>(static_cast<double>(s_stats_last_us - s_stats_first_us) /
+                                     (1e6 * (s_stats_sets - 1)));
+  }
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    const AdcChannelAccumulators& acc = s_stats_acc[i];
+    AdcChannelStats& out = snap.ch[i];
+    snap.osr[i]  = s_stats_osr[i];
+    out.count    = acc.stats.count();
+    out.gaps     = acc.gaps;
+    out.mean_v   = static_cast<float>(acc.stats.mean()) * kAdcScale;
+    out.stddev_v = static_cast<float>(acc.stats.stddev()) * kAdcScale;
+    out.min_v    = static_cast<float>(acc.stats.min()) * kAdcScale;
+    out.max_v    = static_cast<float>(acc.stats.max()) * kAdcScale;
+    for (int k = 0; k < kAdcAllanLevels; ++k) {
+      out.allan_terms[k] = acc.allan.terms(k);
+      out.allan_dev_v[k] = static_cast<float>(acc.allan.deviation(k)) * kAdcScale;
+    }
+  }
+  portENTER_CRITICAL(&s_stats_mux);
+  s_stats_snapshot = snap;
+  portEXIT_CRITICAL(&s_stats_mux);
+}
+
+AdcStatsSnapshot AdcStatsGet() {
+  portENTER_CRITICAL(&s_stats_mux);
+  const AdcStatsSnapshot snap = s_stats_snapshot;
+  portEXIT_CRITICAL(&s_stats_mux);
+  return snap;
+}
+
+void AdcStatsReset() {
+  __atomic_store_n(&s_stats_reset_requested, true, __ATOMIC_RELEASE);
+}
+
+// Samples per state update. The set is paced by its slowest converter, so its nominal
+// conversion time bounds the sample period from below.
+static uint32_t AdcStateDecimation() {
+  int64_t slowest_us = 1;
+  for (LTC2440* adc : s_adcs) {
+    for (const Ltc2440SpeedMode& mode : kLtc2440SpeedModes) {
+      if (mode.osr == adc->osr()) slowest_us = std::max(slowest_us, mode.conversion_us);
+    }
+  }
+  const int64_t period_us = static_cast<int64_t>(app_config.adc_state_period_ms) * 1000;
+  return static_cast<uint32_t>(std::max<int64_t>(1, period_us / slowest_us));
+}
+
+// ---------- acquisition jobs ----------
+// Each job runs one bounded step and returns the esp_timer time it wants to run next. Only
+// the acquisition scheduler calls them, so their state needs no locking.
+
+static int64_t AdcJob(int64_t) {
+  AdcSample sample{};
+  const bool ok = ReadAllAdcRaw(&sample) == ESP_OK;
+  AdcBurstCapture(sample, ok);
+  AdcStatsPush(sample, ok);
+  if (!ok) return esp_timer_get_time() + kAdcRetryUs;
+  sample.seq = s_adc_ring.head();
+  s_adc_ring.Push(sample);
+  const uint32_t decimation = AdcStateDecimation();
+  std::array<float, ADC_CHANNEL_COUNT> mean_code{};
+  uint32_t emitted = 0;  // channels with a new block mean
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    // A channel that did not answer has raw = 0; keep it out of its mean.
+    if (!(sample.valid_mask & (1u << i))) continue;
+    AdcStateFilter& filter = s_adc_state_filters[i];
+    BoxcarDecimator& block = filter.stage<1>();
+    if (block.decimation() != decimation) block.SetDecimation(decimation);
+    if (filter.Push(sample.raw[i], &mean_code[i])) emitted |= 1u << i;
+  }
+  if (emitted != 0) {
+    AdcStatsPublish();
+    const uint64_t now_ms = sample.timestamp_us / 1000ULL;
+    UpdateState(StateGroupBit(StateGroup::kAdc), [&](SharedState& s) {
+      for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+        if (!(emitted & (1u << i))) continue;
+        s.voltage_cal[i] = mean_code[i] * kAdcScale;
+        s.voltage[i]     = s.voltage_cal[i] - s.offset[i];
+      }
+      s.last_update_ms = now_ms;
+    });
+  }
+  // The window just closed restarted the conversions. Announce the next one now: the other
+  // jobs and Ethernet run in the gap instead of ReadPipelined() sleeping through it.
+  const int64_t next_us = LTC2440::PipelinedWindowUs(s_adcs.data(), ADC_CHANNEL_COUNT);
+  SpiArbiterReserve(SpiClient::kAdc, next_us);
+  return next_us > 0 ? next_us : esp_timer_get_time();
+}
+
+struct InaJobState {
   int     consecutive_failures = 0;
   int64_t last_log_us          = 0;
   int64_t last_reinit_us       = 0;
-  while (true) {
-    esp_err_t err = ReadIna219();
-    if (err != ESP_OK) {
-      consecutive_failures++;
-      const int64_t now_us = esp_timer_get_time();
-      if (consecutive_failures == 1 || now_us - last_log_us > 10'000'000) {
-        ESP_LOGW(kTag, "INA219 read failed: %s (consecutive=%d)", esp_err_to_name(err),
-                 consecutive_failures);
-        last_log_us = now_us;
+  int64_t period_start_us      = 0;
+  int     period_samples       = 0;
+  int     cnvr_polls           = 0;
+  int     reinit_step          = 0;  // 1: config, 2: calibration register next
+  CompensatedSum sum_v, sum_i, sum_p;
+};
+static InaJobState s_ina_job;
+
+// Re-init writes one register per run, so a wedged device costs the scheduler at most one
+// I2C timeout at a time instead of the whole sequence.
+static int64_t InaReinitStep(InaJobState* st) {
+  esp_err_t err = AttachIna219();
+  if (err == ESP_OK) {
+    err = st->reinit_step == 1 ? WriteIna219Reg(kIna219RegConfig, kIna219Config)
+                               : WriteIna219Reg(kIna219RegCalib, kIna219Calibration);
+  }
+  const int64_t now_us = esp_timer_get_time();
+  if (err != ESP_OK) {
+    ESP_LOGW(kTag, "INA219 reinit failed: %s", esp_err_to_name(err));
+    st->reinit_step = 0;
+    return now_us + kInaRetryUs;
+  }
+  if (++st->reinit_step <= 2) return now_us + kInaReinitStepUs;
+  st->reinit_step = 0;
+  ESP_LOGI(kTag, "INA219 reinitialized");
+  return now_us + kIna219ConversionUs;
+}
+
+// One averaged conversion per kIna219ConversionUs; CNVR is polled again if it is late.
+static int64_t Ina219Job(int64_t) {
+  InaJobState& st = s_ina_job;
+  if (st.reinit_step > 0) return InaReinitStep(&st);
+  InaSample sample{};
+  esp_err_t err = ReadIna219(&sample);
+  if (err == ESP_ERR_NOT_FINISHED) {
+    if (++st.cnvr_polls < kInaMaxCnvrPolls) return esp_timer_get_time() + kInaCnvrPollUs;
+    // Continuous mode always sets CNVR; the device was reset or reconfigured behind us.
+    ErrorManagerSetLocal(ErrorCode::kInaRead, ErrorSeverity::kWarning,
+                         "INA219 conversion-ready never set");
+    err = ESP_ERR_TIMEOUT;
+  }
+  st.cnvr_polls = 0;
+  if (err == ESP_OK) {
+    sample.seq = s_ina_ring.head();
+    s_ina_ring.Push(sample);
+    if (st.period_samples == 0) st.period_start_us = sample.timestamp_us;
+    st.sum_v.Add(sample.bus_v);
+    st.sum_i.Add(sample.current_a);
+    st.sum_p.Add(sample.power_w);
+    ++st.period_samples;
+    if (sample.timestamp_us - st.period_start_us >= kInaStatePeriodUs) {
+      const float n = static_cast<float>(st.period_samples);
+      UpdateState(StateGroupBit(StateGroup::kAdc), [&](SharedState& s) {
+        s.ina_bus_voltage = st.sum_v.value() / n;
+        s.ina_current     = st.sum_i.value() / n;
+        s.ina_power       = st.sum_p.value() / n;
+      });
+      st.sum_v.Reset();
+      st.sum_i.Reset();
+      st.sum_p.Reset();
+      st.period_samples = 0;
+    }
+  }
+  const int64_t now_us = esp_timer_get_time();
+  if (err != ESP_OK) {
+    st.consecutive_failures++;
+    if (st.consecutive_failures == 1 || now_us - st.last_log_us > 10'000'000) {
+      ESP_LOGW(kTag, "INA219 read failed: %s (consecutive=%d)", esp_err_to_name(err),
+               st.consecutive_failures);
+      st.last_log_us = now_us;
+    }
+    if (st.consecutive_failures >= 3 && now_us - st.last_reinit_us > 10'000'000) {
+      st.last_reinit_us = now_us;
+      ESP_LOGW(kTag, "Reinitializing INA219 after I2C failures");
+      st.reinit_step = 1;
+      return now_us + kInaReinitStepUs;
+    }
+  } else if (st.consecutive_failures > 0) {
+    ESP_LOGI(kTag, "INA219 recovered after %d failed read(s)", st.consecutive_failures);
+    st.consecutive_failures = 0;
+  }
+  return now_us + (err == ESP_OK ? kIna219ConversionUs : kInaRetryUs);
+}
+
+// RPM from the last complete block, or from the pulses since it once that is the longer
+// (slowing down) interval. 0 after kFanStallUs without a pulse.
+static uint32_t FanRpm(FanTach* fan, int64_t now_us, bool* pulsing) {
+  int count = 0;
+  pcnt_unit_get_count(fan->unit, &count);
+  portENTER_CRITICAL(&s_fan_mux);
+  const int64_t  block_end_us    = fan->block_end_us;
+  const uint32_t block_period_us = fan->block_period_us;
+  portEXIT_CRITICAL(&s_fan_mux);
+
+  // The count moving between polls also proves pulses; the block end is an exact edge time.
+  if (count != fan->last_count) {
+    fan->last_count   = count;
+    fan->last_move_us = now_us;
+  }
+  const int64_t last_pulse_us = std::max(block_end_us, fan->last_move_us);
+  *pulsing = last_pulse_us > 0 && now_us - last_pulse_us < kFanStallUs;
+  if (!*pulsing) return 0;
+
+  constexpr float kUsPerMinute = 60e6f;
+  float pulses_per_us = 0.0f;
+  if (block_period_us > 0) pulses_per_us = kFanPulsesPerBlock / static_cast<float>(block_period_us);
+  if (block_end_us > 0 && now_us > block_end_us) {
+    // A fan that slowed down has not finished its block yet; the partial block bounds it.
+    const float partial = (count + 1) / static_cast<float>(now_us - block_end_us);
+    if (block_period_us == 0 || partial < pulses_per_us) pulses_per_us = partial;
+  }
+  return static_cast<uint32_t>(pulses_per_us * kUsPerMinute / kFanPulsesPerRev + 0.5f);
+}
+
+static std::array<float, 2> s_fan_last_power{};
+
+static int64_t FanTachJob(int64_t due_us) {
+  const int64_t now_us = esp_timer_get_time();
+  const ThermalState thermal = ReadThermalState();
+  std::array<uint32_t, 2> rpm{};
+  bool any_stalled = false;
+  for (size_t i = 0; i < s_fans.size(); ++i) {
+    FanTach& fan = s_fans[i];
+    if (!fan.unit) continue;
+    bool pulsing = false;
+    rpm[i] = FanRpm(&fan, now_us, &pulsing);
+    // A fan switched on gets time to spin up before a missing tach counts as a stall.
+    if (thermal.fan_power > 0.0f && s_fan_last_power[i] <= 0.0f) fan.spin_up_until_us = now_us + kFanSpinUpUs;
+    s_fan_last_power[i] = thermal.fan_power;
+    const bool stalled = thermal.fan_power > 0.0f && !pulsing && now_us >= fan.spin_up_until_us;
+    if (stalled && !fan.stalled) ESP_LOGW(kTag, "Fan%u stalled", static_cast<unsigned>(i + 1));
+    fan.stalled = stalled;
+    any_stalled |= stalled;
+  }
+  if (any_stalled) {
+    std::string msg = "Fan stalled:";
+    for (size_t i = 0; i < s_fans.size(); ++i) {
+      if (s_fans[i].stalled) msg += " fan" + std::to_string(i + 1);
+    }
+    ErrorManagerSet(ErrorCode::kFanStall, ErrorSeverity::kError, msg);
+  } else {
+    ErrorManagerClear(ErrorCode::kFanStall);
+  }
+  if (rpm[0] != thermal.fan1_rpm || rpm[1] != thermal.fan2_rpm) {
+    UpdateState(StateGroupBit(StateGroup::kThermalControl), [&](SharedState& s) {
+      s.fan1_rpm = rpm[0];
+      s.fan2_rpm = rpm[1];
+    });
+  }
+  return std::max(due_us + kFanTachPeriodUs, now_us);
+}
+
+// A temperature cycle is a presence step now and then, Convert T (retried from later slices),
+// and the scratchpad reads a few sensors per slice, so the bus (and the scheduler) is free
+// between slices.
+enum class TempJobPhase : uint8_t { kIdle, kPresence, kConvert, kCycle };
+
+struct TempSensorFilter {
+  uint64_t rom = 0;  // slot owner; a hot-plugged sensor starts a fresh window
+  HampelFilter<kTempFilterWindow> hampel{kTempFilterK, kTempFilterMinSigmaC};
+  float   last_clean = NAN;
+  uint8_t held       = 0;
+};
+
+struct TempJobState {
+  TempJobPhase phase            = TempJobPhase::kIdle;
+  int64_t      cycle_start_us   = 0;
+  int64_t      last_presence_us = 0;
+  int          convert_attempts = 0;
+  std::array<float, MAX_TEMP_SENSORS>   temps{};
+  std::array<uint8_t, MAX_TEMP_SENSORS> attempts{};
+  std::array<uint8_t, MAX_TEMP_SENSORS> flags{};
+  std::array<TempSensorFilter, MAX_TEMP_SENSORS> filters;
+};
+static TempJobState s_temp_job;
+
+// Replaces each reading of the finished cycle with its filtered value. A sensor that failed
+// every read (CRC or no answer) holds its last clean value for a few cycles, then reads NAN.
+static void FilterTemperatures(int count) {
+  TempJobState& st = s_temp_job;
+  uint64_t roms[MAX_TEMP_SENSORS]{};
+  M1820GetAddresses(roms, MAX_TEMP_SENSORS);
+  M1820GetReadAttempts(st.attempts.data(), MAX_TEMP_SENSORS);
+  st.flags.fill(0);
+  for (int i = 0; i < count && i < MAX_TEMP_SENSORS; ++i) {
+    TempSensorFilter& f = st.filters[i];
+    if (f.rom != roms[i]) {
+      f = TempSensorFilter{};
+      f.rom = roms[i];
+    }
+    float& t = st.temps[i];
+    if (!std::isfinite(t)) {
+      if (std::isfinite(f.last_clean) && f.held < kTempHoldCycles) {
+        t = f.last_clean;
+        ++f.held;
+        st.flags[i] |= kTempFlagHeld;
+      }
+      continue;
+    }
+    f.held = 0;
+    if (st.attempts[i] > 1) st.flags[i] |= kTempFlagRetried;
+    float clean = t;
+    if (!f.hampel.Push(t, &clean)) {
+      ESP_LOGD(kTag, "Sensor %d: %.3f C rejected, using %.3f C", i + 1, t, clean);
+      st.flags[i] |= kTempFlagRejected;
+    }
+    t = clean;
+    f.last_clean = clean;
+  }
+}
+
+static void PublishTemperatures(int count) {
+  FilterTemperatures(count);
+  const std::array<float, MAX_TEMP_SENSORS>& temps = s_temp_job.temps;
+  ErrorManagerClear(ErrorCode::kTempSensor);
+  const auto meta = BuildTempMeta(count);
+  UpdateState(StateGroupBit(StateGroup::kTemps) | StateGroupBit(StateGroup::kThermalControl), [&](SharedState& s) {
+    s.temp_sensor_count = count;
+    s.temps_c           = temps;
+    s.temp_flags        = s_temp_job.flags;
+    ++s.temp_cycle;
+    s.temp_labels       = meta.labels;
+    s.temp_addresses    = meta.addresses;
+    if (count > 0) {
+      const uint16_t available_mask =
+          static_cast<uint16_t>((1u << std::min(count, MAX_TEMP_SENSORS)) - 1u);
+      uint16_t mask = static_cast<uint16_t>(s.pid_sensor_mask & available_mask);
+      if (mask == 0) {
+        int idx = s.pid_sensor_index;
+        if (idx < 0 || idx >= count) idx = 0;
+        mask = static_cast<uint16_t>(1u << idx);
       }
-      if (consecutive_failures >= 3 && now_us - last_reinit_us > 10'000'000) {
-        last_reinit_us = now_us;
-        ESP_LOGW(kTag, "Reinitializing INA219 after I2C failures");
-        esp_err_t init_err = SensorHubInitIna();
-        if (init_err != ESP_OK) {
-          ESP_LOGW(kTag, "INA219 reinit failed: %s", esp_err_to_name(init_err));
-        }
+      s.pid_sensor_mask = mask;
+      if (s.pid_sensor_index >= count || s.pid_sensor_index < 0) {
+        s.pid_sensor_index = FirstSetBitIndex(mask);
       }
-    } else if (consecutive_failures > 0) {
-      ESP_LOGI(kTag, "INA219 recovered after %d failed read(s)", consecutive_failures);
-      consecutive_failures = 0;
     }
-    vTaskDelay(pdMS_TO_TICKS(1000));
+  });
+  if (count > 0) {
+    ESP_LOGD(kTag, "Temps (%d):", count);
+    for (int i = 0; i < count; ++i) {
+      ESP_LOGD(kTag, "  Sensor %d: %.2f C", i + 1, temps[i]);
+    }
   }
 }
 
-static void FanTachTask(void*) {
-  const uint32_t pulses_per_rev = 2;
-  while (true) {
-    uint32_t c1 = s_fan1_pulses;
-    uint32_t c2 = s_fan2_pulses;
-    s_fan1_pulses = 0;
-    s_fan2_pulses = 0;
-    const uint32_t rpm1 = (c1 * 60U) / pulses_per_rev;
-    const uint32_t rpm2 = (c2 * 60U) / pulses_per_rev;
-    UpdateState([&](SharedState& s) {
-      s.fan1_rpm = rpm1;
-      s.fan2_rpm = rpm2;
-    });
-    vTaskDelay(pdMS_TO_TICKS(1000));
+// Next cycle start on the kTempCyclePeriodUs grid, or now if the cycle overran it.
+static int64_t NextTempCycle() {
+  return std::max(s_temp_job.cycle_start_us + kTempCyclePeriodUs, esp_timer_get_time());
+}
+
+static int64_t TempJob(int64_t due_us) {
+  TempJobState& st = s_temp_job;
+  const int64_t now_us = esp_timer_get_time();
+  if (st.phase == TempJobPhase::kIdle) {
+    st.cycle_start_us = due_us;
+    st.convert_attempts = 0;
+    st.phase = TempJobPhase::kConvert;
+    if (now_us - st.last_presence_us >= kTempPresencePeriodUs) {
+      st.last_presence_us = now_us;
+      st.phase = TempJobPhase::kPresence;
+    }
   }
+  if (st.phase == TempJobPhase::kPresence) {
+    bool changed = false;
+    if (!M1820PresenceStep(&changed)) return now_us + kTempSliceUs;
+    if (changed) ESP_LOGI(kTag, "M1820 sensor set changed: %d slot(s)", M1820GetSensorCount());
+    st.phase = TempJobPhase::kConvert;
+  }
+  if (st.phase == TempJobPhase::kConvert) {
+    if (M1820GetSensorCount() == 0) {
+      st.phase = TempJobPhase::kIdle;
+      if (ReadThermalState().temp_sensor_count != 0) {
+        UpdateState(StateGroupBit(StateGroup::kTemps), [](SharedState& s) { s.temp_sensor_count = 0; });
+      }
+      return NextTempCycle();
+    }
+    if (M1820StartConversion(kTempReadTemperatureOnly)) {
+      st.phase = TempJobPhase::kCycle;
+      return esp_timer_get_time() + kTempSliceUs;
+    }
+    if (++st.convert_attempts < kTempConvertAttempts) {
+      return esp_timer_get_time() + kTempConvertRetryUs;
+    }
+    st.phase = TempJobPhase::kIdle;
+  } else {
+    const M1820CycleStatus status = M1820Service(kTempReadsPerSlice);
+    if (status == M1820CycleStatus::kConverting || status == M1820CycleStatus::kReading) {
+      return esp_timer_get_time() + kTempSliceUs;
+    }
+    st.phase = TempJobPhase::kIdle;
+    if (status == M1820CycleStatus::kDone) {
+      PublishTemperatures(M1820GetTemperatures(st.temps.data(), MAX_TEMP_SENSORS));
+      return NextTempCycle();
+    }
+  }
+  ESP_LOGW(kTag, "M1820 conversion cycle failed");
+  ErrorManagerSet(ErrorCode::kTempSensor, ErrorSeverity::kWarning, "M1820 read failed");
+  return NextTempCycle();
 }
 
-static void TempTask(void*) {
-  std::array<float, MAX_TEMP_SENSORS> temps{};
-  while (true) {
-    int count = 0;
-    if (M1820ReadTemperatures(temps.data(), MAX_TEMP_SENSORS, &count)) {
-      ErrorManagerClear(ErrorCode::kTempSensor);
-      const auto meta = BuildTempMeta(count);
-      UpdateState([&](SharedState& s) {
-        s.temp_sensor_count = count;
-        s.temps_c           = temps;
-        s.temp_labels       = meta.labels;
-        s.temp_addresses    = meta.addresses;
-        if (count > 0) {
-          const uint16_t available_mask =
-              static_cast<uint16_t>((1u << std::min(count, MAX_TEMP_SENSORS)) - 1u);
-          uint16_t mask = static_cast<uint16_t>(s.pid_sensor_mask & available_mask);
-          if (mask == 0) {
-            int idx = s.pid_sensor_index;
-            if (idx < 0 || idx >= count) idx = 0;
-            mask = static_cast<uint16_t>(1u << idx);
-          }
-          s.pid_sensor_mask = mask;
-          if (s.pid_sensor_index >= count || s.pid_sensor_index < 0) {
-            s.pid_sensor_index = FirstSetBitIndex(mask);
-          }
-        }
-      });
-      if (count > 0) {
-        ESP_LOGD(kTag, "Temps (%d):", count);
-        for (int i = 0; i < count; ++i) {
-          ESP_LOGD(kTag, "  Sensor %d: %.2f C", i + 1, temps[i]);
-        }
+// ---------- acquisition scheduler ----------
+// One task runs every sensor job, non-preemptively and earliest deadline first. A job is due
+// at the time its last step returned and should start within its relative deadline. The
+// ADC job is due at the next LTC2440 window, so the slower jobs fill the gaps between
+// windows; a due job that would still be running when a more urgent one falls due is held
+// back until that one has run, or until its own deadline forces it.
+
+struct AcqJob {
+  const char* name;
+  int64_t (*run)(int64_t due_us);
+  int64_t period_us;    // nominal, for reporting; 0 when the job paces itself
+  int64_t deadline_us;
+  int64_t budget_us;
+  bool    enabled = false;
+  int64_t due_us  = 0;
+  bool    held    = false;  // deferral already counted for this release
+  // Accounting, guarded by s_sched_mux.
+  IntegerStats latency;
+  IntegerStats run_time;
+  uint32_t     overruns  = 0;
+  uint32_t     deferrals = 0;
+};
+
+enum class SensorJob : uint8_t { kAdc = 0, kIna, kFan, kTemp };
+
+static std::array<AcqJob, kSensorJobCount> s_jobs = {{
+    {"adc", &AdcJob, 0, kAdcJobDeadlineUs, kSpiAdcHoldBudgetUs},
+    {"ina219", &Ina219Job, kIna219ConversionUs, kInaJobDeadlineUs, kInaJobBudgetUs},
+    {"fan_tach", &FanTachJob, kFanTachPeriodUs, kFanJobDeadlineUs, kFanJobBudgetUs},
+    {"temp", &TempJob, kTempCyclePeriodUs, kTempJobDeadlineUs, kTempJobBudgetUs},
+}};
+static portMUX_TYPE       s_sched_mux        = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t       s_sched_task       = nullptr;
+static esp_timer_handle_t s_sched_wake_timer = nullptr;
+
+static void SchedWakeCallback(void*) {
+  if (s_sched_task) xTaskNotifyGive(s_sched_task);
+}
+
+// Sleeps with microsecond resolution (ticks are 10 ms). The LTC2440 waits share the task
+// notification, so every wait loops on its own condition and a stray wake-up costs nothing.
+static void SchedSleepUntil(int64_t target_us) {
+  const int64_t tick_us = 1000LL * portTICK_PERIOD_MS;
+  int64_t remaining = target_us - esp_timer_get_time();
+  if (remaining <= 0) return;
+  if (!s_sched_wake_timer) {
+    vTaskDelay(static_cast<TickType_t>((remaining + tick_us - 1) / tick_us));
+    return;
+  }
+  esp_timer_start_once(s_sched_wake_timer, static_cast<uint64_t>(remaining));
+  while ((remaining = target_us - esp_timer_get_time()) > 0) {
+    ulTaskNotifyTake(pdTRUE, static_cast<TickType_t>((remaining + tick_us - 1) / tick_us) + 1);
+  }
+  esp_timer_stop(s_sched_wake_timer);
+}
+
+// The job to run at now_us, or -1 with *wake_us set to the next time a decision can change.
+static int PickJob(int64_t now_us, int64_t* wake_us) {
+  int pick = -1;
+  int64_t next_due_us = INT64_MAX;
+  for (int i = 0; i < kSensorJobCount; ++i) {
+    const AcqJob& job = s_jobs[i];
+    if (!job.enabled) continue;
+    if (job.due_us > now_us) {
+      next_due_us = std::min(next_due_us, job.due_us);
+    } else if (pick < 0 ||
+               job.due_us + job.deadline_us < s_jobs[pick].due_us + s_jobs[pick].deadline_us) {
+      pick = i;
+    }
+  }
+  *wake_us = next_due_us;
+  if (pick < 0) return -1;
+
+  AcqJob& job = s_jobs[pick];
+  const int64_t deadline_us = job.due_us + job.deadline_us;
+  if (now_us >= deadline_us) return pick;
+  for (const AcqJob& other : s_jobs) {
+    if (!other.enabled || other.due_us <= now_us) continue;
+    if (other.due_us + other.deadline_us < deadline_us && other.due_us < now_us + job.budget_us) {
+      if (!job.held) {
+        job.held = true;
+        portENTER_CRITICAL(&s_sched_mux);
+        ++job.deferrals;
+        portEXIT_CRITICAL(&s_sched_mux);
       }
-    } else {
-      ESP_LOGW(kTag, "M1820ReadTemperatures failed");
-      ErrorManagerSet(ErrorCode::kTempSensor, ErrorSeverity::kWarning, "M1820 read failed");
+      *wake_us = std::min(next_due_us, deadline_us);
+      return -1;
     }
-    vTaskDelay(pdMS_TO_TICKS(2000));
   }
+  return pick;
 }
 
-// ---------- SensorHubStartTasks ----------
+static void SensorSchedulerTask(void*) {
+  s_sched_task = xTaskGetCurrentTaskHandle();
+  const int64_t start_us = esp_timer_get_time();
+  for (AcqJob& job : s_jobs) job.due_us = start_us;
+  s_temp_job.last_presence_us = start_us;
+  while (true) {
+    int64_t wake_us = 0;
+    const int idx = PickJob(esp_timer_get_time(), &wake_us);
+    if (idx < 0) {
+      SchedSleepUntil(wake_us);
+      continue;
+    }
+    AcqJob& job = s_jobs[idx];
+    const int64_t due_us   = job.due_us;
+    const int64_t begin_us = esp_timer_get_time();
+    const int64_t next_us  = job.run(due_us);
+    const int64_t end_us   = esp_timer_get_time();
+    job.due_us = next_us;
+    job.held   = false;
+    // Integer accounting: this runs with interrupts masked, once per conversion at fast OSR.
+    const int32_t latency_us = static_cast<int32_t>(std::clamp<int64_t>(begin_us - due_us, INT32_MIN, INT32_MAX));
+    const int32_t run_us     = static_cast<int32_t>(std::min<int64_t>(end_us - begin_us, INT32_MAX));
+    portENTER_CRITICAL(&s_sched_mux);
+    job.latency.Push(latency_us);
+    job.run_time.Push(run_us);
+    if (begin_us > due_us + job.deadline_us) ++job.overruns;
+    portEXIT_CRITICAL(&s_sched_mux);
+  }
+}
 
-void SensorHubStartTasks(bool ina_ok, bool temp_ok) {
-  // ADC on core 0, prio 4 — keep separated from stepper (core 1, prio 3)
-  xTaskCreatePinnedToCore(&AdcTask, "adc_task", 4096, nullptr, 4, nullptr, 0);
-  if (ina_ok) {
-    xTaskCreatePinnedToCore(&Ina219Task, "ina219_task", 5120, nullptr, 2, nullptr, 0);
+void SensorSchedulerGetStats(SensorJobStats out[kSensorJobCount]) {
+  // Only the accumulators are copied with interrupts masked; the double-precision merge and
+  // sqrt behind mean() and stddev() are software float on this core and run after.
+  struct Snapshot {
+    IntegerStats latency;
+    IntegerStats run_time;
+    uint32_t     overruns;
+    uint32_t     deferrals;
+    bool         enabled;
+  };
+  std::array<Snapshot, kSensorJobCount> snap;
+  portENTER_CRITICAL(&s_sched_mux);
+  for (int i = 0; i < kSensorJobCount; ++i) {
+    const AcqJob& job = s_jobs[i];
+    snap[i] = {job.latency, job.run_time, job.overruns, job.deferrals, job.enabled};
   }
-  if (FAN1_TACH != GPIO_NUM_NC || FAN2_TACH != GPIO_NUM_NC) {
-    xTaskCreatePinnedToCore(&FanTachTask, "fan_tach_task", 2048, nullptr, 2, nullptr, 0);
+  portEXIT_CRITICAL(&s_sched_mux);
+  for (int i = 0; i < kSensorJobCount; ++i) {
+    const AcqJob& job = s_jobs[i];
+    const Snapshot& sn = snap[i];
+    SensorJobStats& st = out[i];
+    st.name            = job.name;
+    st.enabled         = sn.enabled;
+    st.period_us       = static_cast<uint32_t>(job.period_us);
+    st.deadline_us     = static_cast<uint32_t>(job.deadline_us);
+    st.runs            = sn.latency.count();
+    st.overruns        = sn.overruns;
+    st.deferrals       = sn.deferrals;
+    st.latency_mean_us = static_cast<float>(sn.latency.mean());
+    st.latency_max_us  = static_cast<float>(sn.latency.max());
+    st.jitter_us       = static_cast<float>(sn.latency.stddev());
+    st.run_mean_us     = static_cast<float>(sn.run_time.mean());
+    st.run_max_us      = static_cast<float>(sn.run_time.max());
   }
-  if (temp_ok) {
-    xTaskCreatePinnedToCore(&TempTask, "temp_task", 8192, nullptr, 2, nullptr, 0);
+}
+
+void SensorSchedulerResetStats() {
+  portENTER_CRITICAL(&s_sched_mux);
+  for (AcqJob& job : s_jobs) {
+    job.latency.Reset();
+    job.run_time.Reset();
+    job.overruns  = 0;
+    job.deferrals = 0;
+  }
+  portEXIT_CRITICAL(&s_sched_mux);
+}
+
+// ---------- SensorHubStartTasks ----------
+
+void SensorHubStartTasks(bool ina_ok, bool temp_ok) {
+  AllocateAdcRing();
+  AllocateAdcBurstArena();
+  AllocateAdcStatsHistory();
+  s_jobs[static_cast<int>(SensorJob::kAdc)].enabled  = true;
+  s_jobs[static_cast<int>(SensorJob::kIna)].enabled  = ina_ok;
+  s_jobs[static_cast<int>(SensorJob::kFan)].enabled  = s_fans[0].unit || s_fans[1].unit;
+  // Without sensors at boot the temperature job still runs the hot-plug search on a working bus.
+  s_jobs[static_cast<int>(SensorJob::kTemp)].enabled = temp_ok || M1820BusReady();
+
+  esp_timer_create_args_t args = {};
+  args.callback        = &SchedWakeCallback;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name            = "sensor_sched";
+  if (esp_timer_create(&args, &s_sched_wake_timer) != ESP_OK) {
+    ESP_LOGW(kTag, "Scheduler wake timer unavailable, sleeping in ticks");
+    s_sched_wake_timer = nullptr;
   }
+  // Core 0, prio 4 (the ADC's): keep separated from the stepper (core 1, prio 3).
+  xTaskCreatePinnedToCore(&SensorSchedulerTask, "sensor_sched", kSchedStackBytes, nullptr, 4,
+                          nullptr, 0);
 }
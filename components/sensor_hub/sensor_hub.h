@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
+
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "hw_pins.h"
 
 // Call once before any ADC or Ethernet SPI use; idempotent.
 esp_err_t InitSpiBus();
@@ -11,18 +15,190 @@ void EnsureGpioIsrServiceInstalled();
 // Configure fan-tachometer GPIO pins and attach ISR handlers.
 void SensorHubInitGpios();
 
-// Initialize SPI bus + all three LTC2440 ADC devices.
+// Initialize SPI bus + one LTC2440 per channel (ADC_CS_PINS).
 esp_err_t SensorHubInitAdcs();
 
+// LTC2440 oversampling ratio for channel 0..ADC_CHANNEL_COUNT-1 (ADC1, ADC2, ...). A new OSR
+// is sent with the next readout; the pipelined set runs at the rate of its slowest channel.
+esp_err_t SensorHubSetAdcOsr(int channel, uint16_t osr);
+// OSR of the conversion the channel is currently running.
+uint16_t SensorHubGetAdcOsr(int channel);
+
 // Initialize (or reinitialize) the INA219 power monitor over I2C.
 esp_err_t SensorHubInitIna();
 
+// One INA219 conversion: bus voltage, current and power from the same averaging cycle
+// (32 samples per ADC, ~34 ms).
+struct InaSample {
+  int64_t  timestamp_us;  // esp_timer time the batch was read; the averages cover the ~34 ms before
+  uint32_t seq;           // sample number, identical to the ring sequence
+  float    bus_v;
+  float    current_a;
+  float    power_w;
+  bool     overflow;      // OVF: current/power out of range for the calibration
+};
+
+// Quantization steps of the InaSample fields at the configured calibration.
+inline constexpr float kInaBusVoltageLsb = 0.004f;   // 4 mV
+inline constexpr float kInaCurrentLsb    = 0.0002f;  // 200 uA
+inline constexpr float kInaPowerLsb      = kInaCurrentLsb * 20.0f;
+
+struct InaSampleCursor {
+  uint32_t next_seq = 0;
+  uint32_t lost = 0;  // samples overwritten before this consumer read them
+};
+
+// Cursor positioned at the next sample the INA219 job will publish.
+InaSampleCursor InaSamplesOpenCursor();
+
+// Reads the next INA219 sample for `cursor`, waiting up to `timeout` for one to arrive.
+bool InaSamplesRead(InaSampleCursor* cursor, InaSample* out, TickType_t timeout);
+
 // Block until at least one temperature sensor is detected, or timeout expires.
 bool WaitForTempSensors(int timeout_ms);
 
-// Read all three ADC channels.
-esp_err_t ReadAllAdc(float* v1, float* v2, float* v3);
+// Published temperatures (ThermalState::temps_c, used by PID and logging) pass a per-sensor
+// Hampel filter first. temp_flags tells what happened to the latest reading of each sensor.
+inline constexpr uint8_t kTempFlagRejected = 1u << 0;  // outlier, replaced by the window median
+inline constexpr uint8_t kTempFlagHeld     = 1u << 1;  // every read failed; last clean value held
+inline constexpr uint8_t kTempFlagRetried  = 1u << 2;  // clean only after a failed CRC/read
+
+// One ADC job conversion of every LTC2440 channel, in raw (tare-free) codes.
+struct AdcSample {
+  int64_t timestamp_us;  // esp_timer time the set was read (one bus window for all channels)
+  // esp_timer time each conversion completed (DRDY edge), 0 if not read.
+  int64_t ready_us[ADC_CHANNEL_COUNT];
+  uint32_t seq;          // conversion number, identical to the ring sequence
+  int32_t raw[ADC_CHANNEL_COUNT];
+  uint8_t valid_mask;    // bit i set when channel i+1 read OK (optional channels fail soft, raw=0)
+};
+
+// Position of one consumer in the ADC sample ring. Every consumer keeps its own cursor.
+struct AdcSampleCursor {
+  uint32_t next_seq = 0;
+  uint32_t lost = 0;  // samples overwritten before this consumer read them
+};
+
+// Cursor positioned at the next conversion the ADC job will publish.
+AdcSampleCursor AdcSamplesOpenCursor();
+
+// Reads the next conversion for `cursor`, waiting up to `timeout` for one to arrive.
+bool AdcSamplesRead(AdcSampleCursor* cursor, AdcSample* out, TickType_t timeout);
+
+// Converts an LTC2440 code from AdcSample::raw into volts (before the zero offsets).
+float AdcCodeToVolts(int32_t code);
+
+// ---------- raw burst capture ----------
+// Captures every conversion the ADC job reads, undecimated, into a PSRAM arena preallocated at
+// start-up. GET /adc/burst serves it as AdcBurstHeader followed by record_count records
+// (little-endian, packed as declared).
+
+// OSR slots in the header, rounded up so the layout needs no padding; with three channels
+// the fourth slot is the former reserved word.
+inline constexpr int kAdcBurstOsrSlots = (ADC_CHANNEL_COUNT + 3) / 4 * 4;
+
+struct AdcBurstHeader {
+  char     magic[4];        // "ADCB"
+  uint16_t version;         // 1
+  uint16_t channels;        // ADC_CHANNEL_COUNT
+  uint32_t record_count;
+  uint32_t record_bytes;    // sizeof(AdcBurstRecord)
+  int64_t  start_us;        // esp_timer time of the first record
+  uint16_t osr[kAdcBurstOsrSlots];  // OSR each channel ran at, 0 in unused slots
+  float    volts_per_code;  // AdcCodeToVolts() scale
+  uint32_t read_errors;     // reads where a required channel failed (records kept, codes invalid)
+};
+static_assert(sizeof(AdcBurstHeader) == 32 + 2 * kAdcBurstOsrSlots,
+              "AdcBurstHeader is a wire format");
+
+struct AdcBurstRecord {
+  uint32_t t_us;                    // offset from AdcBurstHeader::start_us
+  int32_t  raw[ADC_CHANNEL_COUNT];  // raw (tare-free) codes; kAdcBurstInvalidCode if not read
+};
+static_assert(sizeof(AdcBurstRecord) == 4 + 4 * ADC_CHANNEL_COUNT,
+              "AdcBurstRecord is a wire format");
+
+inline constexpr int32_t kAdcBurstInvalidCode = INT32_MIN;  // never produced by a 24-bit code
+
+// kAborted: an OSR switch was requested but no conversion at that OSR arrived in time; the
+// configured speeds are restored and nothing was recorded.
+enum class AdcBurstPhase : uint8_t { kIdle, kArmed, kCapturing, kDone, kAborted };
+
+struct AdcBurstStatus {
+  AdcBurstPhase phase;
+  uint32_t records;
+  uint32_t capacity;  // 0 when the arena could not be allocated
+  uint32_t read_errors;
+};
+
+// Arms a capture of `seconds` (bounded by the arena size). osr != 0 runs all channels at that
+// OSR for the capture and restores the configured speeds afterwards; recording starts with
+// the first conversion taken at the new OSR. Fails with ESP_ERR_INVALID_STATE while a capture
+// is running or being downloaded.
+esp_err_t AdcBurstStart(float seconds, uint16_t osr);
+AdcBurstStatus AdcBurstGetStatus();
+// Pins a finished capture so it cannot be overwritten while it is read; returns false if no
+// capture is complete. Every successful call must be paired with AdcBurstRelease().
+bool AdcBurstAcquire(AdcBurstHeader* header, const AdcBurstRecord** records);
+void AdcBurstRelease();
+
+// ---------- live statistics ----------
+// The ADC job keeps per-channel mean/variance/extrema and an overlapping Allan deviation
+// at tau = tau0 * 2^k, where tau0 is the measured set period. Values are volts at the ADC
+// input (before the zero offsets). Statistics restart on AdcStatsReset() and whenever an OSR
+// changes; failed reads are skipped and counted as gaps.
+
+inline constexpr int kAdcAllanLevels = 11;
+
+struct AdcChannelStats {
+  uint32_t count;
+  uint32_t gaps;
+  float    mean_v;
+  float    stddev_v;
+  float    min_v;
+  float    max_v;
+  uint32_t allan_terms[kAdcAllanLevels];
+  float    allan_dev_v[kAdcAllanLevels];  // 0 until the level has a term
+};
+
+struct AdcStatsSnapshot {
+  int64_t  since_us;         // esp_timer time of the first set since the last restart, 0 if none
+  float    tau0_s;           // measured set period, 0 until two sets
+  uint16_t osr[ADC_CHANNEL_COUNT];
+  bool     allan_available;  // false when the sum history could not be allocated (no PSRAM)
+  AdcChannelStats ch[ADC_CHANNEL_COUNT];
+};
+
+// Latest statistics, published together with the shared ADC state.
+AdcStatsSnapshot AdcStatsGet();
+// Restarts all statistics from the next conversion.
+void AdcStatsReset();
+
+// ---------- acquisition scheduler ----------
+// One task runs the ADC, INA219, fan-tach and temperature jobs earliest deadline first.
+// Latency is how late a run started past its due time; jitter is its standard deviation.
+
+inline constexpr int kSensorJobCount = 4;
+
+struct SensorJobStats {
+  const char* name;       // "adc", "ina219", "fan_tach", "temp"
+  bool     enabled;
+  uint32_t period_us;     // nominal; 0 for the ADC, which is paced by its conversions
+  uint32_t deadline_us;   // latest start past the due time before a run counts as an overrun
+  uint32_t runs;
+  uint32_t overruns;
+  uint32_t deferrals;     // due runs held back so a more urgent job could start on time
+  float    latency_mean_us;
+  float    latency_max_us;
+  float    jitter_us;
+  float    run_mean_us;
+  float    run_max_us;
+};
+
+void SensorSchedulerGetStats(SensorJobStats out[kSensorJobCount]);
+void SensorSchedulerResetStats();
 
-// Create ADC, INA219, fan-tach, and temperature FreeRTOS tasks.
-// ina_ok: skip Ina219Task if false; temp_ok: skip TempTask if false.
+// Starts the acquisition scheduler. ina_ok: skip the INA219 job if false; temp_ok: sensors
+// were found at boot (the temperature job still runs without them while the 1-Wire bus is
+// up, to pick up hot-plugged sensors).
 void SensorHubStartTasks(bool ina_ok, bool temp_ok);
@@ -0,0 +1,171 @@
+#include "spi_arbiter.h"
+
+#include <algorithm>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+namespace {
+constexpr char kTag[] = "SPI_ARB";
+
+// Margin kept between the end of a deferred transaction and the start of a reserved slot.
+constexpr int64_t kSlotGuardUs = 200;
+constexpr EventBits_t kSlotFreeBit = BIT0;
+
+SemaphoreHandle_t  s_bus_mutex = nullptr;
+EventGroupHandle_t s_slot_events = nullptr;
+portMUX_TYPE       s_arb_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Guarded by s_arb_mux. One reservation at a time: only the ADC announces slots.
+int64_t   s_slot_start_us = 0;
+SpiClient s_slot_owner = SpiClient::kAdc;
+
+// Hold start per client; only written by the task currently holding s_bus_mutex.
+int64_t        s_hold_start_us[kSpiClientCount] = {};
+SpiClientStats s_stats[kSpiClientCount] = {};
+
+constexpr uint32_t kHoldBudgetUs[kSpiClientCount] = {kSpiAdcHoldBudgetUs, kSpiEthHoldBudgetUs};
+
+uint32_t ClampUs(int64_t us) {
+  return static_cast<uint32_t>(std::clamp<int64_t>(us, 0, UINT32_MAX));
+}
+
+TickType_t TicksCeil(int64_t us) {
+  const int64_t tick_us = 1000LL * portTICK_PERIOD_MS;
+  return static_cast<TickType_t>(std::max<int64_t>(1, (us + tick_us - 1) / tick_us));
+}
+
+// Holds `client` back while a window of `expected_hold_us` would overlap another client's
+// reserved slot. Bounded by the slot's hold budget, so a stale reservation only costs one
+// budget. Returns true if the caller had to wait.
+bool WaitForSlot(SpiClient client, uint32_t expected_hold_us, int64_t deadline_us) {
+  bool deferred = false;
+  while (true) {
+    portENTER_CRITICAL(&s_arb_mux);
+    const int64_t start_us = s_slot_start_us;
+    const SpiClient owner = s_slot_owner;
+    portEXIT_CRITICAL(&s_arb_mux);
+    if (start_us <= 0 || owner == client) return deferred;
+
+    const int64_t now_us = esp_timer_get_time();
+    const int64_t slot_end_us = start_us + kHoldBudgetUs[static_cast<int>(owner)];
+    if (now_us + expected_hold_us + kSlotGuardUs <= start_us || now_us >= slot_end_us) {
+      return deferred;
+    }
+    const int64_t until_us = std::min(slot_end_us, deadline_us);
+    if (now_us >= until_us) return deferred;
+    deferred = true;
+    xEventGroupWaitBits(s_slot_events, kSlotFreeBit, pdFALSE, pdTRUE, TicksCeil(until_us - now_us));
+  }
+}
+}  // namespace
+
+void SpiArbiterInit() {
+  if (s_bus_mutex) return;
+  s_slot_events = xEventGroupCreate();
+  s_bus_mutex = xSemaphoreCreateMutex();
+  if (!s_bus_mutex || !s_slot_events) {
+    ESP_LOGE(kTag, "SPI arbiter allocation failed, using the plain bus lock");
+    s_bus_mutex = nullptr;
+    return;
+  }
+  xEventGroupSetBits(s_slot_events, kSlotFreeBit);
+  for (int i = 0; i < kSpiClientCount; ++i) s_stats[i].hold_budget_us = kHoldBudgetUs[i];
+}
+
+esp_err_t SpiArbiterAcquire(SpiClient client, spi_device_handle_t dev, uint32_t expected_hold_us,
+                            TickType_t timeout) {
+  const int idx = static_cast<int>(client);
+  if (!s_bus_mutex) return spi_device_acquire_bus(dev, timeout);
+
+  const int64_t t0 = esp_timer_get_time();
+  const int64_t deadline_us = t0 + static_cast<int64_t>(timeout) * 1000LL * portTICK_PERIOD_MS;
+  const bool deferred = WaitForSlot(client, expected_hold_us, deadline_us);
+
+  const int64_t after_slot_us = esp_timer_get_time();
+  const TickType_t left = after_slot_us >= deadline_us ? 0 : TicksCeil(deadline_us - after_slot_us);
+  esp_err_t err = ESP_ERR_TIMEOUT;
+  if (xSemaphoreTake(s_bus_mutex, left) == pdTRUE) {
+    err = spi_device_acquire_bus(dev, portMAX_DELAY);
+    if (err != ESP_OK) xSemaphoreGive(s_bus_mutex);
+  }
+
+  const int64_t now_us = esp_timer_get_time();
+  const uint32_t wait_us = ClampUs(now_us - t0);
+  bool dropped_slot = false;
+  portENTER_CRITICAL(&s_arb_mux);
+  SpiClientStats& st = s_stats[idx];
+  if (deferred) ++st.deferrals;
+  if (err == ESP_OK) {
+    ++st.acquisitions;
+    st.wait_total_us += wait_us;
+    st.wait_max_us = std::max(st.wait_max_us, wait_us);
+  } else {
+    ++st.timeouts;
+    // The window this client reserved will not happen; do not keep others waiting for it.
+    dropped_slot = s_slot_start_us > 0 && s_slot_owner == client;
+    if (dropped_slot) s_slot_start_us = 0;
+  }
+  portEXIT_CRITICAL(&s_arb_mux);
+  if (dropped_slot) xEventGroupSetBits(s_slot_events, kSlotFreeBit);
+  if (err == ESP_OK) s_hold_start_us[idx] = now_us;
+  return err;
+}
+
+void SpiArbiterRelease(SpiClient client, spi_device_handle_t dev) {
+  const int idx = static_cast<int>(client);
+  if (!s_bus_mutex) {
+    spi_device_release_bus(dev);
+    return;
+  }
+  const uint32_t hold_us = ClampUs(esp_timer_get_time() - s_hold_start_us[idx]);
+  spi_device_release_bus(dev);
+
+  portENTER_CRITICAL(&s_arb_mux);
+  SpiClientStats& st = s_stats[idx];
+  st.hold_total_us += hold_us;
+  st.hold_max_us = std::max(st.hold_max_us, hold_us);
+  if (hold_us > st.hold_budget_us) ++st.over_budget;
+  const bool owned_slot = s_slot_start_us > 0 && s_slot_owner == client;
+  if (owned_slot) s_slot_start_us = 0;
+  portEXIT_CRITICAL(&s_arb_mux);
+
+  xSemaphoreGive(s_bus_mutex);
+  if (owned_slot) xEventGroupSetBits(s_slot_events, kSlotFreeBit);
+}
+
+void SpiArbiterReserve(SpiClient client, int64_t start_us) {
+  if (!s_bus_mutex || start_us <= 0) return;
+  xEventGroupClearBits(s_slot_events, kSlotFreeBit);
+  portENTER_CRITICAL(&s_arb_mux);
+  s_slot_start_us = start_us;
+  s_slot_owner = client;
+  portEXIT_CRITICAL(&s_arb_mux);
+}
+
+const char* SpiClientName(SpiClient client) {
+  switch (client) {
+    case SpiClient::kAdc:      return "adc";
+    case SpiClient::kEthernet: return "ethernet";
+    case SpiClient::kCount:    break;
+  }
+  return "?";
+}
+
+void SpiArbiterGetStats(SpiClientStats out[kSpiClientCount]) {
+  portENTER_CRITICAL(&s_arb_mux);
+  for (int i = 0; i < kSpiClientCount; ++i) out[i] = s_stats[i];
+  portEXIT_CRITICAL(&s_arb_mux);
+}
+
+void SpiArbiterResetStats() {
+  portENTER_CRITICAL(&s_arb_mux);
+  for (int i = 0; i < kSpiClientCount; ++i) {
+    s_stats[i] = {};
+    s_stats[i].hold_budget_us = kHoldBudgetUs[i];
+  }
+  portEXIT_CRITICAL(&s_arb_mux);
+}
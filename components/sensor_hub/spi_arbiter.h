@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+#include "driver/spi_master.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// Arbitration of SPI2_HOST between the LTC2440s and the W5500.
+//
+// Every bus window goes through SpiArbiterAcquire()/SpiArbiterRelease(), which serialize
+// the clients on one priority-inheriting mutex and then lock the IDF bus. The ADC works in
+// time slots: before sleeping towards its next conversion window it announces the slot
+// start with SpiArbiterReserve(), and Ethernet transactions that would still be running
+// when the slot opens wait until the ADC releases the bus (at most the ADC hold budget past
+// the slot start). Ethernet therefore runs between ADC windows instead of delaying them,
+// and the ADC bounds its own hold time so Ethernet is never locked out for long.
+
+enum class SpiClient : uint8_t { kAdc = 0, kEthernet, kCount };
+
+inline constexpr int kSpiClientCount = static_cast<int>(SpiClient::kCount);
+
+// Longest the ADC may keep the bus for one window (all three DRDY waits and frames).
+inline constexpr uint32_t kSpiAdcHoldBudgetUs = 8'000;
+// Accounting budget for one W5500 transaction (a full frame at 8 MHz takes ~1.6 ms).
+inline constexpr uint32_t kSpiEthHoldBudgetUs = 2'000;
+
+struct SpiClientStats {
+  uint32_t acquisitions;
+  uint32_t timeouts;       // acquire gave up
+  uint32_t deferrals;      // Ethernet transactions held back for an ADC slot
+  uint32_t over_budget;    // holds longer than hold_budget_us
+  uint32_t hold_budget_us;
+  uint32_t wait_max_us;
+  uint32_t hold_max_us;
+  uint64_t wait_total_us;  // includes any slot deferral
+  uint64_t hold_total_us;
+};
+
+// Called by InitSpiBus(); idempotent. Until then the calls below fall back to the plain
+// IDF bus lock.
+void SpiArbiterInit();
+
+// `expected_hold_us` is the caller's estimate of the window, used to keep Ethernet
+// transactions clear of a reserved ADC slot.
+esp_err_t SpiArbiterAcquire(SpiClient client, spi_device_handle_t dev, uint32_t expected_hold_us,
+                            TickType_t timeout);
+void SpiArbiterRelease(SpiClient client, spi_device_handle_t dev);
+
+// Announces that `client` will open a window at esp_timer time `start_us`. Cleared by that
+// client's next release.
+void SpiArbiterReserve(SpiClient client, int64_t start_us);
+
+const char* SpiClientName(SpiClient client);
+void SpiArbiterGetStats(SpiClientStats out[kSpiClientCount]);
+void SpiArbiterResetStats();
@@ -124,7 +124,7 @@ void UpdateSdStatsLocked() {
   const int root_files = CountFilesInDir(CONFIG_MOUNT_POINT, true);
   const int to_upload_files = CountFilesInDir(TO_UPLOAD_DIR, false);
   const int uploaded_files = CountFilesInDir(UPLOADED_DIR, false);
-  UpdateState([&](SharedState& s) {
+  UpdateState(StateGroupBit(StateGroup::kStorageStats), [&](SharedState& s) {
     s.sd_total_bytes = total;
     s.sd_used_bytes = used;
     s.sd_data_root_files = root_files;
@@ -740,7 +740,7 @@ static bool UploadPendingOnce() {
   constexpr int kMaxSdUsagePercent = 60;
   constexpr int kMaxUploadsPerCycle = 1;
   constexpr int kMaxUploadAttemptsPerCycle = 1;
-  UpdateState([](SharedState& s) {
+  UpdateState(StateGroupBit(StateGroup::kStorageStats), [](SharedState& s) {
     s.heap_free_bytes = static_cast<uint32_t>(heap_caps_get_free_size(MALLOC_CAP_8BIT));
     s.heap_min_free_bytes = static_cast<uint32_t>(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
     s.heap_largest_free_block_bytes = static_cast<uint32_t>(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
@@ -158,11 +158,11 @@ void Wn90lpClient::taskLoop() {
       if (poll()) {
         latest = getData();
         latest_online = true;
-        UpdateState([&latest](SharedState& s) { s.meteo = latest; });
+        UpdateState(StateGroupBit(StateGroup::kMeteo), [&latest](SharedState& s) { s.meteo = latest; });
         if (next_file_us == 0) next_file_us = esp_timer_get_time();  // write first valid reading immediately
       } else {
         latest_online = false;
-        UpdateState([](SharedState& s) { s.meteo.online = false; });
+        UpdateState(StateGroupBit(StateGroup::kMeteo), [](SharedState& s) { s.meteo.online = false; });
       }
       do {
         next_poll_us += poll_interval_us;
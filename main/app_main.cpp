@@ -59,7 +59,8 @@ void InitGpios() {
       GpioMask(RELAY_PIN) | GpioMask(STEPPER_EN) | GpioMask(STEPPER_DIR) | GpioMask(STEPPER_STEP) |
       GpioMask(HEATER_PWM) | GpioMask(FAN_PWM) | GpioMask(EXT_PWR_ON) |
       GpioMask(STATUS_LED_RED) | GpioMask(STATUS_LED_GREEN) |
-      GpioMask(ADC_CS1) | GpioMask(ADC_CS2) | GpioMask(ADC_CS3) | GpioMask(ETH_CS) | GpioMask(ETH_RST);
+      GpioMask(ETH_CS) | GpioMask(ETH_RST);
+  for (gpio_num_t cs : ADC_CS_PINS) io_conf.pin_bit_mask |= GpioMask(cs);
   io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
   io_conf.pull_up_en = GPIO_PULLUP_DISABLE;
   if (io_conf.pin_bit_mask != 0) {
@@ -74,9 +75,7 @@ void InitGpios() {
   SetExternalPower(true);
   gpio_set_level(STATUS_LED_RED, 0);
   gpio_set_level(STATUS_LED_GREEN, 0);
-  gpio_set_level(ADC_CS1, 1);
-  gpio_set_level(ADC_CS2, 1);
-  gpio_set_level(ADC_CS3, 1);
+  for (gpio_num_t cs : ADC_CS_PINS) gpio_set_level(cs, 1);
   gpio_set_level(ETH_CS, 1);
   gpio_set_level(ETH_RST, 0);
 
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 
 #include "app_services.h"
 #include "app_utils.h"
@@ -29,93 +30,127 @@ void ScheduleNetworkApply() {
   xTaskCreatePinnedToCore(&NetworkApplyTask, "net_apply", 4096, nullptr, 2, &network_apply_task, 0);
 }
 
+cJSON* FloatArrayJson(const float* values, int count) {
+  cJSON* arr = cJSON_CreateArray();
+  for (int i = 0; i < count; ++i) {
+    cJSON_AddItemToArray(arr, std::isfinite(values[i]) ? cJSON_CreateNumber(values[i]) : cJSON_CreateNull());
+  }
+  return arr;
+}
+
+cJSON* BrightnessCalsJson() {
+  const RadiometerCalibrationTable& cals = app_config.brightness_cals;
+  cJSON* arr = cJSON_CreateArray();
+  for (int i = 0; i < cals.size(); ++i) {
+    const RadiometerCalibration& cal = cals.at(i);
+    cJSON* entry = cJSON_CreateObject();
+    cJSON_AddNumberToObject(entry, "createdMs", static_cast<double>(cal.created_ms));
+    cJSON_AddItemToObject(entry, "tAdc", FloatArrayJson(cal.t_adc.data(), ADC_CHANNEL_COUNT));
+    cJSON_AddItemToObject(entry, "slope", FloatArrayJson(cal.slope.data(), ADC_CHANNEL_COUNT));
+    cJSON_AddItemToObject(entry, "intercept", FloatArrayJson(cal.intercept.data(), ADC_CHANNEL_COUNT));
+    cJSON_AddItemToArray(arr, entry);
+  }
+  return arr;
+}
+
 std::string BuildStateJsonInternal() {
   RefreshHallDebugState();
-  SharedState snapshot = CopyState();
+  const AdcState adc = ReadAdcState();
+  const ThermalState thermal = ReadThermalState();
+  const MotionState motion = ReadMotionState();
+  const NetState net = ReadNetState();
+  const StorageState storage = ReadStorageState();
   cJSON* root = cJSON_CreateObject();
-  cJSON_AddBoolToObject(root, "logging", snapshot.logging);
-  cJSON_AddStringToObject(root, "logFilename", snapshot.log_filename.c_str());
-  cJSON_AddBoolToObject(root, "logUseMotor", snapshot.log_use_motor);
-  cJSON_AddNumberToObject(root, "logDuration", snapshot.log_duration_s);
+  cJSON_AddBoolToObject(root, "logging", storage.logging);
+  cJSON_AddStringToObject(root, "logFilename", storage.log_filename.c_str());
+  cJSON_AddBoolToObject(root, "logUseMotor", storage.log_use_motor);
+  cJSON_AddNumberToObject(root, "logDuration", storage.log_duration_s);
   cJSON_AddNumberToObject(root, "loggingMotorSteps", app_config.logging_motor_steps);
   cJSON_AddBoolToObject(root, "loggingHomeEachCycle", app_config.logging_home_each_cycle);
-  cJSON_AddNumberToObject(root, "voltage1", snapshot.voltage1);
-  cJSON_AddNumberToObject(root, "voltage2", snapshot.voltage2);
-  cJSON_AddNumberToObject(root, "voltage3", snapshot.voltage3);
-  cJSON_AddNumberToObject(root, "inaBusVoltage", snapshot.ina_bus_voltage);
-  cJSON_AddNumberToObject(root, "inaCurrent", snapshot.ina_current);
-  cJSON_AddNumberToObject(root, "inaPower", snapshot.ina_power);
-  cJSON_AddBoolToObject(root, "pidEnabled", snapshot.pid_enabled);
-  cJSON_AddNumberToObject(root, "pidOutput", snapshot.pid_output);
-  cJSON_AddNumberToObject(root, "pidSetpoint", snapshot.pid_setpoint);
-  cJSON_AddNumberToObject(root, "pidSensorIndex", snapshot.pid_sensor_index);
-  cJSON_AddNumberToObject(root, "pidSensorMask", snapshot.pid_sensor_mask);
-  cJSON_AddNumberToObject(root, "pidKp", snapshot.pid_kp);
-  cJSON_AddNumberToObject(root, "pidKi", snapshot.pid_ki);
-  cJSON_AddNumberToObject(root, "pidKd", snapshot.pid_kd);
-  cJSON_AddNumberToObject(root, "pidTemperature", snapshot.pid_temperature);
-  cJSON_AddNumberToObject(root, "pidError", snapshot.pid_error);
-  cJSON_AddNumberToObject(root, "pidIntegral", snapshot.pid_integral);
-  cJSON_AddNumberToObject(root, "pidIntegralCandidate", snapshot.pid_integral_candidate);
-  cJSON_AddNumberToObject(root, "pidDerivative", snapshot.pid_derivative);
-  cJSON_AddNumberToObject(root, "pidPTerm", snapshot.pid_p_term);
-  cJSON_AddNumberToObject(root, "pidITerm", snapshot.pid_i_term);
-  cJSON_AddNumberToObject(root, "pidDTerm", snapshot.pid_d_term);
-  cJSON_AddNumberToObject(root, "pidRawOutput", snapshot.pid_raw_output);
-  cJSON_AddNumberToObject(root, "pidDt", snapshot.pid_dt);
-  cJSON_AddBoolToObject(root, "pidSaturatedHigh", snapshot.pid_saturated_high);
-  cJSON_AddBoolToObject(root, "pidSaturatedLow", snapshot.pid_saturated_low);
-  cJSON_AddBoolToObject(root, "pidIntegralHeld", snapshot.pid_integral_held);
-  cJSON_AddBoolToObject(root, "stepperEnabled", snapshot.stepper_enabled);
-  cJSON_AddBoolToObject(root, "stepperHoming", snapshot.homing);
-  cJSON_AddBoolToObject(root, "stepperDirForward", snapshot.stepper_direction_forward);
-  cJSON_AddBoolToObject(root, "stepperMoving", snapshot.stepper_moving);
-  cJSON_AddNumberToObject(root, "stepperPosition", snapshot.stepper_position);
-  cJSON_AddNumberToObject(root, "stepperTarget", snapshot.stepper_target);
-  cJSON_AddNumberToObject(root, "stepperSpeedUs", snapshot.stepper_speed_us);
-  cJSON_AddNumberToObject(root, "stepperHomeOffsetSteps", snapshot.stepper_home_offset_steps);
-  cJSON_AddNumberToObject(root, "motorHallActiveLevel", snapshot.motor_hall_active_level);
-  cJSON_AddNumberToObject(root, "motorHallRawLevel", snapshot.motor_hall_raw_level);
-  cJSON_AddBoolToObject(root, "motorHallTriggered", snapshot.motor_hall_triggered);
-  cJSON_AddNumberToObject(root, "motorHallEdgeCount", snapshot.motor_hall_edge_count);
-  cJSON_AddNumberToObject(root, "motorHallActiveEdgeCount", snapshot.motor_hall_active_edge_count);
-  cJSON_AddNumberToObject(root, "motorHallLevel0EdgeCount", snapshot.motor_hall_level0_edge_count);
-  cJSON_AddNumberToObject(root, "motorHallLevel1EdgeCount", snapshot.motor_hall_level1_edge_count);
-  cJSON_AddNumberToObject(root, "motorHallLastEdgeLevel", snapshot.motor_hall_last_edge_level);
-  cJSON_AddNumberToObject(root, "motorHallLastEdgeSeenUs", static_cast<double>(snapshot.motor_hall_last_edge_seen_us));
-  cJSON_AddBoolToObject(root, "stepperHomed", snapshot.stepper_homed);
-  cJSON_AddStringToObject(root, "stepperHomeStatus", snapshot.stepper_home_status.c_str());
-  cJSON_AddNumberToObject(root, "fan1Rpm", snapshot.fan1_rpm);
-  cJSON_AddNumberToObject(root, "fan2Rpm", snapshot.fan2_rpm);
-  cJSON_AddNumberToObject(root, "heaterPower", snapshot.heater_power);
-  cJSON_AddNumberToObject(root, "fanPower", snapshot.fan_power);
-  cJSON_AddBoolToObject(root, "externalPowerOn", snapshot.external_power_on);
-  cJSON_AddNumberToObject(root, "wifiRssi", snapshot.wifi_rssi_dbm);
-  cJSON_AddNumberToObject(root, "wifiQuality", snapshot.wifi_quality);
-  cJSON_AddStringToObject(root, "wifiIp", snapshot.wifi_ip.c_str());
-  cJSON_AddStringToObject(root, "wifiStaIp", snapshot.wifi_ip_sta.c_str());
-  cJSON_AddStringToObject(root, "wifiApIp", snapshot.wifi_ip_ap.c_str());
-  cJSON_AddNumberToObject(root, "sdTotalBytes", static_cast<double>(snapshot.sd_total_bytes));
-  cJSON_AddNumberToObject(root, "sdUsedBytes", static_cast<double>(snapshot.sd_used_bytes));
-  cJSON_AddNumberToObject(root, "sdRootDataFiles", snapshot.sd_data_root_files);
-  cJSON_AddNumberToObject(root, "sdToUploadFiles", snapshot.sd_to_upload_files);
-  cJSON_AddNumberToObject(root, "sdUploadedFiles", snapshot.sd_uploaded_files);
-  cJSON_AddNumberToObject(root, "heapFreeBytes", static_cast<double>(snapshot.heap_free_bytes));
-  cJSON_AddNumberToObject(root, "heapMinFreeBytes", static_cast<double>(snapshot.heap_min_free_bytes));
-  cJSON_AddNumberToObject(root, "heapLargestFreeBlockBytes", static_cast<double>(snapshot.heap_largest_free_block_bytes));
-  cJSON_AddNumberToObject(root, "heapInternalFreeBytes", static_cast<double>(snapshot.heap_internal_free_bytes));
+  cJSON_AddNumberToObject(root, "loggingSettleMinMs", app_config.logging_settle_min_ms);
+  cJSON_AddNumberToObject(root, "loggingSettleMaxMs", app_config.logging_settle_max_ms);
+  cJSON_AddNumberToObject(root, "loggingSettleSlopeUvS", app_config.logging_settle_slope_uv_s);
+  cJSON_AddNumberToObject(root, "loggingSettleStdUv", app_config.logging_settle_std_uv);
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    const std::string key = "voltage" + std::to_string(ch + 1);
+    cJSON_AddNumberToObject(root, key.c_str(), adc.voltage[ch]);
+  }
+  cJSON_AddNumberToObject(root, "inaBusVoltage", adc.ina_bus_voltage);
+  cJSON_AddNumberToObject(root, "inaCurrent", adc.ina_current);
+  cJSON_AddNumberToObject(root, "inaPower", adc.ina_power);
+  cJSON_AddBoolToObject(root, "pidEnabled", thermal.pid_enabled);
+  cJSON_AddNumberToObject(root, "pidOutput", thermal.pid_output);
+  cJSON_AddNumberToObject(root, "pidSetpoint", thermal.pid_setpoint);
+  cJSON_AddNumberToObject(root, "pidSensorIndex", thermal.pid_sensor_index);
+  cJSON_AddNumberToObject(root, "pidSensorMask", thermal.pid_sensor_mask);
+  cJSON_AddNumberToObject(root, "pidKp", thermal.pid_kp);
+  cJSON_AddNumberToObject(root, "pidKi", thermal.pid_ki);
+  cJSON_AddNumberToObject(root, "pidKd", thermal.pid_kd);
+  cJSON_AddNumberToObject(root, "pidTemperature", thermal.pid_temperature);
+  cJSON_AddNumberToObject(root, "pidError", thermal.pid_error);
+  cJSON_AddNumberToObject(root, "pidIntegral", thermal.pid_integral);
+  cJSON_AddNumberToObject(root, "pidIntegralCandidate", thermal.pid_integral_candidate);
+  cJSON_AddNumberToObject(root, "pidDerivative", thermal.pid_derivative);
+  cJSON_AddNumberToObject(root, "pidPTerm", thermal.pid_p_term);
+  cJSON_AddNumberToObject(root, "pidITerm", thermal.pid_i_term);
+  cJSON_AddNumberToObject(root, "pidDTerm", thermal.pid_d_term);
+  cJSON_AddNumberToObject(root, "pidRawOutput", thermal.pid_raw_output);
+  cJSON_AddNumberToObject(root, "pidDt", thermal.pid_dt);
+  cJSON_AddBoolToObject(root, "pidSaturatedHigh", thermal.pid_saturated_high);
+  cJSON_AddBoolToObject(root, "pidSaturatedLow", thermal.pid_saturated_low);
+  cJSON_AddBoolToObject(root, "pidIntegralHeld", thermal.pid_integral_held);
+  cJSON_AddBoolToObject(root, "stepperEnabled", motion.stepper_enabled);
+  cJSON_AddBoolToObject(root, "stepperHoming", motion.homing);
+  cJSON_AddBoolToObject(root, "stepperDirForward", motion.stepper_direction_forward);
+  cJSON_AddBoolToObject(root, "stepperMoving", motion.stepper_moving);
+  cJSON_AddNumberToObject(root, "stepperPosition", motion.stepper_position);
+  cJSON_AddNumberToObject(root, "stepperTarget", motion.stepper_target);
+  cJSON_AddNumberToObject(root, "stepperSpeedUs", motion.stepper_speed_us);
+  cJSON_AddNumberToObject(root, "stepperHomeOffsetSteps", motion.stepper_home_offset_steps);
+  cJSON_AddNumberToObject(root, "motorHallActiveLevel", motion.motor_hall_active_level);
+  cJSON_AddNumberToObject(root, "motorHallRawLevel", motion.motor_hall_raw_level);
+  cJSON_AddBoolToObject(root, "motorHallTriggered", motion.motor_hall_triggered);
+  cJSON_AddNumberToObject(root, "motorHallEdgeCount", motion.motor_hall_edge_count);
+  cJSON_AddNumberToObject(root, "motorHallActiveEdgeCount", motion.motor_hall_active_edge_count);
+  cJSON_AddNumberToObject(root, "motorHallLevel0EdgeCount", motion.motor_hall_level0_edge_count);
+  cJSON_AddNumberToObject(root, "motorHallLevel1EdgeCount", motion.motor_hall_level1_edge_count);
+  cJSON_AddNumberToObject(root, "motorHallLastEdgeLevel", motion.motor_hall_last_edge_level);
+  cJSON_AddNumberToObject(root, "motorHallLastEdgeSeenUs", static_cast<double>(motion.motor_hall_last_edge_seen_us));
+  cJSON_AddNumberToObject(root, "motorHallWidthSteps", motion.motor_hall_width_steps);
+  cJSON_AddNumberToObject(root, "motorHallSpeedSps", motion.motor_hall_speed_sps);
+  cJSON_AddBoolToObject(root, "stepperHomed", motion.stepper_homed);
+  cJSON_AddStringToObject(root, "stepperHomeStatus", motion.stepper_home_status.c_str());
+  cJSON_AddNumberToObject(root, "fan1Rpm", thermal.fan1_rpm);
+  cJSON_AddNumberToObject(root, "fan2Rpm", thermal.fan2_rpm);
+  cJSON_AddNumberToObject(root, "heaterPower", thermal.heater_power);
+  cJSON_AddNumberToObject(root, "fanPower", thermal.fan_power);
+  cJSON_AddBoolToObject(root, "externalPowerOn", thermal.external_power_on);
+  cJSON_AddNumberToObject(root, "wifiRssi", net.wifi_rssi_dbm);
+  cJSON_AddNumberToObject(root, "wifiQuality", net.wifi_quality);
+  cJSON_AddStringToObject(root, "wifiIp", net.wifi_ip.c_str());
+  cJSON_AddStringToObject(root, "wifiStaIp", net.wifi_ip_sta.c_str());
+  cJSON_AddStringToObject(root, "wifiApIp", net.wifi_ip_ap.c_str());
+  cJSON_AddNumberToObject(root, "sdTotalBytes", static_cast<double>(storage.sd_total_bytes));
+  cJSON_AddNumberToObject(root, "sdUsedBytes", static_cast<double>(storage.sd_used_bytes));
+  cJSON_AddNumberToObject(root, "sdRootDataFiles", storage.sd_data_root_files);
+  cJSON_AddNumberToObject(root, "sdToUploadFiles", storage.sd_to_upload_files);
+  cJSON_AddNumberToObject(root, "sdUploadedFiles", storage.sd_uploaded_files);
+  cJSON_AddNumberToObject(root, "heapFreeBytes", static_cast<double>(storage.heap_free_bytes));
+  cJSON_AddNumberToObject(root, "heapMinFreeBytes", static_cast<double>(storage.heap_min_free_bytes));
+  cJSON_AddNumberToObject(root, "heapLargestFreeBlockBytes", static_cast<double>(storage.heap_largest_free_block_bytes));
+  cJSON_AddNumberToObject(root, "heapInternalFreeBytes", static_cast<double>(storage.heap_internal_free_bytes));
   cJSON_AddNumberToObject(root, "heapInternalLargestFreeBlockBytes",
-                          static_cast<double>(snapshot.heap_internal_largest_free_block_bytes));
-  cJSON_AddNumberToObject(root, "heapPsramFreeBytes", static_cast<double>(snapshot.heap_psram_free_bytes));
+                          static_cast<double>(storage.heap_internal_largest_free_block_bytes));
+  cJSON_AddNumberToObject(root, "heapPsramFreeBytes", static_cast<double>(storage.heap_psram_free_bytes));
   cJSON_AddNumberToObject(root, "heapPsramLargestFreeBlockBytes",
-                          static_cast<double>(snapshot.heap_psram_largest_free_block_bytes));
-  cJSON_AddNumberToObject(root, "minioUploadAttempts", snapshot.minio_upload_attempts);
-  cJSON_AddNumberToObject(root, "minioUploadSuccesses", snapshot.minio_upload_successes);
-  cJSON_AddNumberToObject(root, "minioUploadFailures", snapshot.minio_upload_failures);
-  cJSON_AddNumberToObject(root, "minioArchiveFailures", snapshot.minio_archive_failures);
-  cJSON_AddNumberToObject(root, "minioLastAttemptMs", static_cast<double>(snapshot.minio_last_attempt_ms));
-  cJSON_AddNumberToObject(root, "minioLastSuccessMs", static_cast<double>(snapshot.minio_last_success_ms));
-  cJSON_AddNumberToObject(root, "minioLastFailureMs", static_cast<double>(snapshot.minio_last_failure_ms));
+                          static_cast<double>(storage.heap_psram_largest_free_block_bytes));
+  cJSON_AddNumberToObject(root, "minioUploadAttempts", storage.minio_upload_attempts);
+  cJSON_AddNumberToObject(root, "minioUploadSuccesses", storage.minio_upload_successes);
+  cJSON_AddNumberToObject(root, "minioUploadFailures", storage.minio_upload_failures);
+  cJSON_AddNumberToObject(root, "minioArchiveFailures", storage.minio_archive_failures);
+  cJSON_AddNumberToObject(root, "minioLastAttemptMs", static_cast<double>(storage.minio_last_attempt_ms));
+  cJSON_AddNumberToObject(root, "minioLastSuccessMs", static_cast<double>(storage.minio_last_success_ms));
+  cJSON_AddNumberToObject(root, "minioLastFailureMs", static_cast<double>(storage.minio_last_failure_ms));
   cJSON_AddNumberToObject(root, "uptimeMs", static_cast<double>(esp_timer_get_time() / 1000ULL));
   cJSON_AddBoolToObject(root, "wifiApMode", app_config.wifi_ap_mode);
   cJSON_AddStringToObject(root, "wifiMode", app_config.wifi_ap_mode ? "ap" : "sta");
@@ -133,6 +168,17 @@ std::string BuildStateJsonInternal() {
   cJSON_AddStringToObject(root, "gpsMode", app_config.gps_mode.c_str());
   cJSON_AddNumberToObject(root, "meteoPollIntervalS", app_config.meteo_poll_interval_s);
   cJSON_AddNumberToObject(root, "meteoFileIntervalS", app_config.meteo_file_interval_s);
+  cJSON* adc_osr = cJSON_CreateArray();
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    cJSON_AddItemToArray(adc_osr, cJSON_CreateNumber(SensorHubGetAdcOsr(i)));
+  }
+  cJSON_AddItemToObject(root, "adcOsr", adc_osr);
+  cJSON_AddItemToObject(root, "brightnessCals", BrightnessCalsJson());
+  cJSON* brightness_sensors = cJSON_CreateArray();
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    cJSON_AddItemToArray(brightness_sensors, cJSON_CreateString(app_config.brightness_sensor[ch].c_str()));
+  }
+  cJSON_AddItemToObject(root, "brightnessSensors", brightness_sensors);
   char gps_actual_mode[256] = {};
   GetGpsCurrentModeText(gps_actual_mode, sizeof(gps_actual_mode));
   cJSON_AddStringToObject(root, "gpsActualMode", gps_actual_mode);
@@ -154,13 +200,13 @@ std::string BuildStateJsonInternal() {
     cJSON_AddNumberToObject(root, "gpsTimeAgeMs", static_cast<double>(gps_status.time_age_ms));
   }
   cJSON* temp_obj = cJSON_CreateObject();
-  for (int i = 0; i < snapshot.temp_sensor_count && i < MAX_TEMP_SENSORS; ++i) {
+  for (int i = 0; i < thermal.temp_sensor_count && i < MAX_TEMP_SENSORS; ++i) {
     const std::string key = "t" + std::to_string(i + 1);
-    const std::string& addr = snapshot.temp_addresses[i];
     cJSON* entry = cJSON_CreateObject();
-    cJSON_AddNumberToObject(entry, "value", snapshot.temps_c[i]);
-    cJSON_AddStringToObject(entry, "address", addr.c_str());
+    cJSON_AddNumberToObject(entry, "value", thermal.temps_c[i]);
+    cJSON_AddStringToObject(entry, "address", thermal.temp_addresses[i].c_str());
     cJSON_AddStringToObject(entry, "label", key.c_str());
+    cJSON_AddNumberToObject(entry, "flags", thermal.temp_flags[i]);
     cJSON_AddItemToObject(temp_obj, key.c_str(), entry);
   }
   cJSON_AddItemToObject(root, "tempSensors", temp_obj);
@@ -227,7 +273,7 @@ ActionResult ActionStepperDisable() {
 }
 
 ActionResult ActionStepperMove(const StepperMoveRequest& req) {
-  SharedState snapshot = CopyState();
+  const MotionState snapshot = ReadMotionState();
   if (!snapshot.stepper_enabled) {
     return {false, "Stepper not enabled", {}};
   }
@@ -245,8 +291,7 @@ ActionResult ActionStepperStop() {
 }
 
 ActionResult ActionStepperFindZero() {
-  SharedState snapshot = CopyState();
-  if (!snapshot.stepper_enabled) {
+  if (!ReadMotionState().stepper_enabled) {
     EnableStepper();
   }
   std::string msg;
@@ -324,15 +369,15 @@ ActionResult ActionPidApply(const PidApplyRequest& req) {
   int sensor = req.sensor;
   uint16_t sensor_mask = req.sensor_mask;
 
-  SharedState snapshot = CopyState();
-  if (snapshot.temp_sensor_count > 0) {
-    sensor = std::clamp(sensor, 0, snapshot.temp_sensor_count - 1);
+  const int temp_sensor_count = ReadThermalState().temp_sensor_count;
+  if (temp_sensor_count > 0) {
+    sensor = std::clamp(sensor, 0, temp_sensor_count - 1);
   } else if (sensor < 0) {
     sensor = 0;
   }
   if (req.sensor_mask_set) {
-    sensor_mask = ClampSensorMask(sensor_mask, snapshot.temp_sensor_count);
-    if (sensor_mask == 0 && snapshot.temp_sensor_count > 0) {
+    sensor_mask = ClampSensorMask(sensor_mask, temp_sensor_count);
+    if (sensor_mask == 0 && temp_sensor_count > 0) {
       sensor_mask = static_cast<uint16_t>(1u << sensor);
     }
     sensor = FirstSetBitIndex(sensor_mask);
@@ -361,8 +406,7 @@ ActionResult ActionPidApply(const PidApplyRequest& req) {
 }
 
 ActionResult ActionPidEnable() {
-  SharedState snapshot = CopyState();
-  if (snapshot.temp_sensor_count == 0) {
+  if (ReadThermalState().temp_sensor_count == 0) {
     return {false, "no temp sensors", {}};
   }
   UpdateState([](SharedState& s) { s.pid_enabled = true; });
@@ -503,6 +547,93 @@ ActionResult ActionMeteoConfigApply(const MeteoConfigApplyRequest& req) {
   return {true, "meteo_config_saved", payload};
 }
 
+ActionResult ActionAdcSpeedApply(const AdcSpeedApplyRequest& req) {
+  if (std::all_of(req.osr.begin(), req.osr.end(), [](int v) { return v == 0; })) {
+    return {false, "no osr given", {}};
+  }
+  std::array<uint16_t, ADC_CHANNEL_COUNT> osr = app_config.adc_osr;
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    if (req.osr[i] == 0) continue;
+    if (!IsValidAdcOsr(req.osr[i])) {
+      return {false, "adc osr must be a power of two between 64 and 32768", {}};
+    }
+    osr[i] = static_cast<uint16_t>(req.osr[i]);
+  }
+
+  const std::array<uint16_t, ADC_CHANNEL_COUNT> old_osr = app_config.adc_osr;
+  app_config.adc_osr = osr;
+  const ConfigSaveResult saved = SaveConfigEverywhere(app_config, pid_config);
+  if (!saved.fully_synced()) {
+    app_config.adc_osr = old_osr;
+    const ConfigSaveResult rolled_back = SaveConfigEverywhere(app_config, pid_config);
+    if (!rolled_back.fully_synced()) {
+      return {false, "adc speed save failed and rollback could not synchronize NVS and SD", {}};
+    }
+    return {false, "adc speed was not changed because NVS and SD could not both be saved", {}};
+  }
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    SensorHubSetAdcOsr(i, osr[i]);
+  }
+
+  std::string payload = "{\"adcOsr\":[";
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    if (i > 0) payload += ",";
+    payload += std::to_string(osr[i]);
+  }
+  payload += "]}";
+  return {true, "adc_speed_saved", payload};
+}
+
+ActionResult ActionBrightnessCalApply(const BrightnessCalApplyRequest& req) {
+  if (!req.calibrations_set && !req.sensors_set) {
+    return {false, "no calibrations or sensors given", {}};
+  }
+  if (req.invalid_calibration >= 0) {
+    return {false, "calibration " + std::to_string(req.invalid_calibration) + " is malformed", {}};
+  }
+  RadiometerCalibrationTable cals = app_config.brightness_cals;
+  if (req.calibrations_set) {
+    cals.Clear();
+    for (size_t i = 0; i < req.calibrations.size(); ++i) {
+      if (!cals.Insert(req.calibrations[i])) {
+        return {false, "calibration " + std::to_string(i) + " has no channel with slope and intercept", {}};
+      }
+    }
+  }
+  std::array<TempAddressString, ADC_CHANNEL_COUNT> sensors = app_config.brightness_sensor;
+  if (req.sensors_set) {
+    for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+      if (req.sensors[ch].size() > TEMP_ADDRESS_MAX_LEN) {
+        return {false, "sensor address too long", {}};
+      }
+      sensors[ch] = req.sensors[ch];
+    }
+  }
+
+  const RadiometerCalibrationTable old_cals = app_config.brightness_cals;
+  const std::array<TempAddressString, ADC_CHANNEL_COUNT> old_sensors = app_config.brightness_sensor;
+  app_config.brightness_cals = cals;
+  app_config.brightness_sensor = sensors;
+  const ConfigSaveResult saved = SaveConfigEverywhere(app_config, pid_config);
+  if (!saved.fully_synced()) {
+    app_config.brightness_cals = old_cals;
+    app_config.brightness_sensor = old_sensors;
+    const ConfigSaveResult rolled_back = SaveConfigEverywhere(app_config, pid_config);
+    if (!rolled_back.fully_synced()) {
+      return {false, "brightness calibration save failed and rollback could not synchronize NVS and SD", {}};
+    }
+    return {false, "brightness calibrations were not changed because NVS and SD could not both be saved", {}};
+  }
+
+  std::string payload = "{\"brightnessCalCount\":" + std::to_string(cals.size()) + ",\"brightnessSensors\":[";
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    if (ch > 0) payload += ",";
+    payload += "\"" + sensors[ch].str() + "\"";
+  }
+  payload += "]}";
+  return {true, "brightness_cal_saved", payload};
+}
+
 ActionResult ActionConfigSyncInternalFlash() {
   if (!SyncConfigToInternalFlash()) {
     return {false, "config_internal_flash_sync_failed", {}};
@@ -534,7 +665,7 @@ ActionResult ActionCalibrate() {
 }
 
 ActionResult ActionRestart() {
-  if (CopyState().logging) {
+  if (ReadStorageState().logging) {
     StopLogging();
   }
   ScheduleRestart();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -77,6 +78,19 @@ struct MeteoConfigApplyRequest {
   int file_interval_s = 60;
 };
 
+struct AdcSpeedApplyRequest {
+  std::array<int, ADC_CHANNEL_COUNT> osr{};  // 0 keeps the channel's current setting
+};
+
+// Replaces the calibration table and/or the sensor bindings; unset parts are kept.
+struct BrightnessCalApplyRequest {
+  std::vector<RadiometerCalibration> calibrations;
+  bool calibrations_set = false;
+  int invalid_calibration = -1;  // index of an entry the bridge could not parse
+  std::array<std::string, ADC_CHANNEL_COUNT> sensors;
+  bool sensors_set = false;
+};
+
 struct UploadedClearRequest {
   int max_files = 1000;
 };
@@ -110,6 +124,8 @@ ActionResult ActionCloudApply(const CloudApplyRequest& req);
 ActionResult ActionGpsApply(const GpsApplyRequest& req);
 ActionResult ActionGpsProbe();
 ActionResult ActionMeteoConfigApply(const MeteoConfigApplyRequest& req);
+ActionResult ActionAdcSpeedApply(const AdcSpeedApplyRequest& req);
+ActionResult ActionBrightnessCalApply(const BrightnessCalApplyRequest& req);
 ActionResult ActionConfigSyncInternalFlash();
 ActionResult ActionUploadedClear(const UploadedClearRequest& req);
 ActionResult ActionCalibrate();
@@ -1,7 +1,9 @@
 #include <algorithm>
+#include <array>
 #include <cerrno>
 #include <cstdarg>
 #include <cctype>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -21,6 +23,7 @@
 #include "mqtt_bridge.h"
 #include "error_manager.h"
 #include "sd_maintenance.h"
+#include "spi_arbiter.h"
 #include "hw_pins.h"
 #include "esp_err.h"
 #include "driver/gpio.h"
@@ -217,72 +220,121 @@ esp_err_t RootHandler(httpd_req_t* req) {
   return httpd_resp_send(req, INDEX_HTML, HTTPD_RESP_USE_STRLEN);
 }
 
+// Allan levels without a term yet are left out.
+static cJSON* BuildAdcStatsJson(const AdcStatsSnapshot& snap) {
+  cJSON* root = cJSON_CreateObject();
+  cJSON_AddNumberToObject(root, "sinceUs", static_cast<double>(snap.since_us));
+  cJSON_AddNumberToObject(root, "tau0S", snap.tau0_s);
+  cJSON_AddBoolToObject(root, "allanAvailable", snap.allan_available);
+  cJSON* channels = cJSON_CreateArray();
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    const AdcChannelStats& c = snap.ch[i];
+    cJSON* item = cJSON_CreateObject();
+    cJSON_AddNumberToObject(item, "osr", snap.osr[i]);
+    cJSON_AddNumberToObject(item, "count", c.count);
+    cJSON_AddNumberToObject(item, "gaps", c.gaps);
+    cJSON_AddNumberToObject(item, "meanV", c.mean_v);
+    cJSON_AddNumberToObject(item, "stddevV", c.stddev_v);
+    cJSON_AddNumberToObject(item, "minV", c.min_v);
+    cJSON_AddNumberToObject(item, "maxV", c.max_v);
+    cJSON* allan = cJSON_CreateArray();
+    for (int k = 0; k < kAdcAllanLevels && c.allan_terms[k] > 0; ++k) {
+      cJSON* point = cJSON_CreateObject();
+      cJSON_AddNumberToObject(point, "tauS", snap.tau0_s * static_cast<float>(1u << k));
+      cJSON_AddNumberToObject(point, "adevV", c.allan_dev_v[k]);
+      cJSON_AddNumberToObject(point, "terms", c.allan_terms[k]);
+      cJSON_AddItemToArray(allan, point);
+    }
+    cJSON_AddItemToObject(item, "allan", allan);
+    cJSON_AddItemToArray(channels, item);
+  }
+  cJSON_AddItemToObject(root, "channels", channels);
+  return root;
+}
+
 esp_err_t DataHandler(httpd_req_t* req) {
   RefreshHallDebugState();
-  SharedState snapshot = CopyState();
+  const AdcState adc = ReadAdcState();
+  const ThermalState thermal = ReadThermalState();
+  const MotionState motion = ReadMotionState();
+  const NetState net = ReadNetState();
+  const StorageState storage = ReadStorageState();
   cJSON* root = cJSON_CreateObject();
-  cJSON_AddNumberToObject(root, "voltage1", snapshot.voltage1);
-  cJSON_AddNumberToObject(root, "voltage2", snapshot.voltage2);
-  cJSON_AddNumberToObject(root, "voltage3", snapshot.voltage3);
-  cJSON_AddNumberToObject(root, "inaBusVoltage", snapshot.ina_bus_voltage);
-  cJSON_AddNumberToObject(root, "inaCurrent", snapshot.ina_current);
-  cJSON_AddNumberToObject(root, "inaPower", snapshot.ina_power);
-  cJSON_AddNumberToObject(root, "wifiRssi", snapshot.wifi_rssi_dbm);
-  cJSON_AddNumberToObject(root, "wifiQuality", snapshot.wifi_quality);
-  cJSON_AddStringToObject(root, "wifiIp", snapshot.wifi_ip.c_str());
-  cJSON_AddStringToObject(root, "wifiStaIp", snapshot.wifi_ip_sta.c_str());
-  cJSON_AddStringToObject(root, "wifiApIp", snapshot.wifi_ip_ap.c_str());
-  cJSON_AddStringToObject(root, "ethIp", snapshot.eth_ip.c_str());
-  cJSON_AddBoolToObject(root, "ethLink", snapshot.eth_link_up);
-  cJSON_AddBoolToObject(root, "ethIpUp", snapshot.eth_ip_up);
-  cJSON_AddNumberToObject(root, "sdTotalBytes", static_cast<double>(snapshot.sd_total_bytes));
-  cJSON_AddNumberToObject(root, "sdUsedBytes", static_cast<double>(snapshot.sd_used_bytes));
-  cJSON_AddNumberToObject(root, "sdRootDataFiles", snapshot.sd_data_root_files);
-  cJSON_AddNumberToObject(root, "sdToUploadFiles", snapshot.sd_to_upload_files);
-  cJSON_AddNumberToObject(root, "sdUploadedFiles", snapshot.sd_uploaded_files);
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    const std::string key = "voltage" + std::to_string(ch + 1);
+    cJSON_AddNumberToObject(root, key.c_str(), adc.voltage[ch]);
+  }
+  // Live brightness temperatures from the stored calibrations, for channels that have one.
+  const RadiometerCalibrationTable brightness_cals = app_config.brightness_cals;
+  if (!brightness_cals.empty()) {
+    const std::array<float, ADC_CHANNEL_COUNT> sensor_temps =
+        RadiometerSensorTemps(thermal.temp_addresses, thermal.temps_c, thermal.temp_sensor_count);
+    for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+      const float tb = brightness_cals.Brightness(ch, adc.voltage[ch], sensor_temps[ch]);
+      if (!std::isfinite(tb)) continue;
+      const std::string key = "brightnessTemp" + std::to_string(ch + 1);
+      cJSON_AddNumberToObject(root, key.c_str(), tb);
+    }
+  }
+  cJSON_AddNumberToObject(root, "inaBusVoltage", adc.ina_bus_voltage);
+  cJSON_AddNumberToObject(root, "inaCurrent", adc.ina_current);
+  cJSON_AddNumberToObject(root, "inaPower", adc.ina_power);
+  cJSON_AddNumberToObject(root, "wifiRssi", net.wifi_rssi_dbm);
+  cJSON_AddNumberToObject(root, "wifiQuality", net.wifi_quality);
+  cJSON_AddStringToObject(root, "wifiIp", net.wifi_ip.c_str());
+  cJSON_AddStringToObject(root, "wifiStaIp", net.wifi_ip_sta.c_str());
+  cJSON_AddStringToObject(root, "wifiApIp", net.wifi_ip_ap.c_str());
+  cJSON_AddStringToObject(root, "ethIp", net.eth_ip.c_str());
+  cJSON_AddBoolToObject(root, "ethLink", net.eth_link_up);
+  cJSON_AddBoolToObject(root, "ethIpUp", net.eth_ip_up);
+  cJSON_AddNumberToObject(root, "sdTotalBytes", static_cast<double>(storage.sd_total_bytes));
+  cJSON_AddNumberToObject(root, "sdUsedBytes", static_cast<double>(storage.sd_used_bytes));
+  cJSON_AddNumberToObject(root, "sdRootDataFiles", storage.sd_data_root_files);
+  cJSON_AddNumberToObject(root, "sdToUploadFiles", storage.sd_to_upload_files);
+  cJSON_AddNumberToObject(root, "sdUploadedFiles", storage.sd_uploaded_files);
   cJSON_AddStringToObject(root, "storageBackend", StorageBackendToString(app_config.storage_backend).c_str());
   cJSON_AddBoolToObject(root, "sdMounted", IsLogSdMounted());
   cJSON_AddBoolToObject(root, "internalFlashMounted", IsInternalFlashMounted());
   cJSON_AddBoolToObject(root, "activeStorageMounted",
                         app_config.storage_backend == StorageBackend::kInternalFlash ? IsInternalFlashMounted() : IsLogSdMounted());
-  cJSON_AddNumberToObject(root, "heapFreeBytes", static_cast<double>(snapshot.heap_free_bytes));
-  cJSON_AddNumberToObject(root, "heapMinFreeBytes", static_cast<double>(snapshot.heap_min_free_bytes));
-  cJSON_AddNumberToObject(root, "heapLargestFreeBlockBytes", static_cast<double>(snapshot.heap_largest_free_block_bytes));
-  cJSON_AddNumberToObject(root, "heapInternalFreeBytes", static_cast<double>(snapshot.heap_internal_free_bytes));
+  cJSON_AddNumberToObject(root, "heapFreeBytes", static_cast<double>(storage.heap_free_bytes));
+  cJSON_AddNumberToObject(root, "heapMinFreeBytes", static_cast<double>(storage.heap_min_free_bytes));
+  cJSON_AddNumberToObject(root, "heapLargestFreeBlockBytes", static_cast<double>(storage.heap_largest_free_block_bytes));
+  cJSON_AddNumberToObject(root, "heapInternalFreeBytes", static_cast<double>(storage.heap_internal_free_bytes));
   cJSON_AddNumberToObject(root, "heapInternalLargestFreeBlockBytes",
-                          static_cast<double>(snapshot.heap_internal_largest_free_block_bytes));
-  cJSON_AddNumberToObject(root, "heapPsramFreeBytes", static_cast<double>(snapshot.heap_psram_free_bytes));
+                          static_cast<double>(storage.heap_internal_largest_free_block_bytes));
+  cJSON_AddNumberToObject(root, "heapPsramFreeBytes", static_cast<double>(storage.heap_psram_free_bytes));
   cJSON_AddNumberToObject(root, "heapPsramLargestFreeBlockBytes",
-                          static_cast<double>(snapshot.heap_psram_largest_free_block_bytes));
-  cJSON_AddNumberToObject(root, "minioUploadAttempts", snapshot.minio_upload_attempts);
-  cJSON_AddNumberToObject(root, "minioUploadSuccesses", snapshot.minio_upload_successes);
-  cJSON_AddNumberToObject(root, "minioUploadFailures", snapshot.minio_upload_failures);
-  cJSON_AddNumberToObject(root, "minioArchiveFailures", snapshot.minio_archive_failures);
-  cJSON_AddNumberToObject(root, "minioLastAttemptMs", static_cast<double>(snapshot.minio_last_attempt_ms));
-  cJSON_AddNumberToObject(root, "minioLastSuccessMs", static_cast<double>(snapshot.minio_last_success_ms));
-  cJSON_AddNumberToObject(root, "minioLastFailureMs", static_cast<double>(snapshot.minio_last_failure_ms));
+                          static_cast<double>(storage.heap_psram_largest_free_block_bytes));
+  cJSON_AddNumberToObject(root, "minioUploadAttempts", storage.minio_upload_attempts);
+  cJSON_AddNumberToObject(root, "minioUploadSuccesses", storage.minio_upload_successes);
+  cJSON_AddNumberToObject(root, "minioUploadFailures", storage.minio_upload_failures);
+  cJSON_AddNumberToObject(root, "minioArchiveFailures", storage.minio_archive_failures);
+  cJSON_AddNumberToObject(root, "minioLastAttemptMs", static_cast<double>(storage.minio_last_attempt_ms));
+  cJSON_AddNumberToObject(root, "minioLastSuccessMs", static_cast<double>(storage.minio_last_success_ms));
+  cJSON_AddNumberToObject(root, "minioLastFailureMs", static_cast<double>(storage.minio_last_failure_ms));
   cJSON_AddNumberToObject(root, "uptimeMs", static_cast<double>(esp_timer_get_time() / 1000ULL));
-  cJSON_AddNumberToObject(root, "heaterPower", snapshot.heater_power);
-  cJSON_AddNumberToObject(root, "fanPower", snapshot.fan_power);
-  cJSON_AddBoolToObject(root, "externalPowerOn", snapshot.external_power_on);
-  cJSON_AddNumberToObject(root, "fan1Rpm", snapshot.fan1_rpm);
-  cJSON_AddNumberToObject(root, "fan2Rpm", snapshot.fan2_rpm);
-  cJSON_AddNumberToObject(root, "tempSensorCount", snapshot.temp_sensor_count);
+  cJSON_AddNumberToObject(root, "heaterPower", thermal.heater_power);
+  cJSON_AddNumberToObject(root, "fanPower", thermal.fan_power);
+  cJSON_AddBoolToObject(root, "externalPowerOn", thermal.external_power_on);
+  cJSON_AddNumberToObject(root, "fan1Rpm", thermal.fan1_rpm);
+  cJSON_AddNumberToObject(root, "fan2Rpm", thermal.fan2_rpm);
+  cJSON_AddNumberToObject(root, "tempSensorCount", thermal.temp_sensor_count);
   cJSON* temp_obj = cJSON_CreateObject();
-  for (int i = 0; i < snapshot.temp_sensor_count && i < MAX_TEMP_SENSORS; ++i) {
+  for (int i = 0; i < thermal.temp_sensor_count && i < MAX_TEMP_SENSORS; ++i) {
     const std::string key = "t" + std::to_string(i + 1);
-    const std::string& addr = snapshot.temp_addresses[i];
     cJSON* entry = cJSON_CreateObject();
-    cJSON_AddNumberToObject(entry, "value", snapshot.temps_c[i]);
-    cJSON_AddStringToObject(entry, "address", addr.c_str());
+    cJSON_AddNumberToObject(entry, "value", thermal.temps_c[i]);
+    cJSON_AddStringToObject(entry, "address", thermal.temp_addresses[i].c_str());
     cJSON_AddStringToObject(entry, "label", key.c_str());
+    cJSON_AddNumberToObject(entry, "flags", thermal.temp_flags[i]);
     cJSON_AddItemToObject(temp_obj, key.c_str(), entry);
   }
   cJSON_AddItemToObject(root, "tempSensors", temp_obj);
-  cJSON_AddBoolToObject(root, "logging", snapshot.logging);
-  cJSON_AddStringToObject(root, "logFilename", snapshot.log_filename.c_str());
-  cJSON_AddBoolToObject(root, "logUseMotor", snapshot.log_use_motor);
-  cJSON_AddNumberToObject(root, "logDuration", snapshot.log_duration_s);
+  cJSON_AddBoolToObject(root, "logging", storage.logging);
+  cJSON_AddStringToObject(root, "logFilename", storage.log_filename.c_str());
+  cJSON_AddBoolToObject(root, "logUseMotor", storage.log_use_motor);
+  cJSON_AddNumberToObject(root, "logDuration", storage.log_duration_s);
   cJSON_AddNumberToObject(root, "loggingMotorSteps", app_config.logging_motor_steps);
   cJSON_AddBoolToObject(root, "loggingHomeEachCycle", app_config.logging_home_each_cycle);
   cJSON_AddBoolToObject(root, "wifiApMode", app_config.wifi_ap_mode);
@@ -303,6 +355,11 @@ esp_err_t DataHandler(httpd_req_t* req) {
   cJSON_AddStringToObject(root, "gpsMode", app_config.gps_mode.c_str());
   cJSON_AddNumberToObject(root, "meteoPollIntervalS", app_config.meteo_poll_interval_s);
   cJSON_AddNumberToObject(root, "meteoFileIntervalS", app_config.meteo_file_interval_s);
+  cJSON* adc_osr = cJSON_CreateArray();
+  for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+    cJSON_AddItemToArray(adc_osr, cJSON_CreateNumber(SensorHubGetAdcOsr(i)));
+  }
+  cJSON_AddItemToObject(root, "adcOsr", adc_osr);
   char gps_actual_mode[256] = {};
   GetGpsCurrentModeText(gps_actual_mode, sizeof(gps_actual_mode));
   cJSON_AddStringToObject(root, "gpsActualMode", gps_actual_mode);
@@ -333,55 +390,167 @@ esp_err_t DataHandler(httpd_req_t* req) {
   cJSON_AddStringToObject(root, "mqttUser", app_config.mqtt_user.c_str());
   cJSON_AddStringToObject(root, "mqttPassword", app_config.mqtt_password.c_str());
   cJSON_AddBoolToObject(root, "mqttEnabled", app_config.mqtt_enabled);
-  cJSON_AddBoolToObject(root, "pidEnabled", snapshot.pid_enabled);
-  cJSON_AddNumberToObject(root, "pidSetpoint", snapshot.pid_setpoint);
-  cJSON_AddNumberToObject(root, "pidSensorIndex", snapshot.pid_sensor_index);
-  cJSON_AddNumberToObject(root, "pidSensorMask", snapshot.pid_sensor_mask);
-  cJSON_AddNumberToObject(root, "pidKp", snapshot.pid_kp);
-  cJSON_AddNumberToObject(root, "pidKi", snapshot.pid_ki);
-  cJSON_AddNumberToObject(root, "pidKd", snapshot.pid_kd);
-  cJSON_AddNumberToObject(root, "pidOutput", snapshot.pid_output);
-  cJSON_AddNumberToObject(root, "pidTemperature", snapshot.pid_temperature);
-  cJSON_AddNumberToObject(root, "pidError", snapshot.pid_error);
-  cJSON_AddNumberToObject(root, "pidIntegral", snapshot.pid_integral);
-  cJSON_AddNumberToObject(root, "pidIntegralCandidate", snapshot.pid_integral_candidate);
-  cJSON_AddNumberToObject(root, "pidDerivative", snapshot.pid_derivative);
-  cJSON_AddNumberToObject(root, "pidPTerm", snapshot.pid_p_term);
-  cJSON_AddNumberToObject(root, "pidITerm", snapshot.pid_i_term);
-  cJSON_AddNumberToObject(root, "pidDTerm", snapshot.pid_d_term);
-  cJSON_AddNumberToObject(root, "pidRawOutput", snapshot.pid_raw_output);
-  cJSON_AddNumberToObject(root, "pidDt", snapshot.pid_dt);
-  cJSON_AddBoolToObject(root, "pidSaturatedHigh", snapshot.pid_saturated_high);
-  cJSON_AddBoolToObject(root, "pidSaturatedLow", snapshot.pid_saturated_low);
-  cJSON_AddBoolToObject(root, "pidIntegralHeld", snapshot.pid_integral_held);
+  cJSON_AddBoolToObject(root, "pidEnabled", thermal.pid_enabled);
+  cJSON_AddNumberToObject(root, "pidSetpoint", thermal.pid_setpoint);
+  cJSON_AddNumberToObject(root, "pidSensorIndex", thermal.pid_sensor_index);
+  cJSON_AddNumberToObject(root, "pidSensorMask", thermal.pid_sensor_mask);
+  cJSON_AddNumberToObject(root, "pidKp", thermal.pid_kp);
+  cJSON_AddNumberToObject(root, "pidKi", thermal.pid_ki);
+  cJSON_AddNumberToObject(root, "pidKd", thermal.pid_kd);
+  cJSON_AddNumberToObject(root, "pidOutput", thermal.pid_output);
+  cJSON_AddNumberToObject(root, "pidTemperature", thermal.pid_temperature);
+  cJSON_AddNumberToObject(root, "pidError", thermal.pid_error);
+  cJSON_AddNumberToObject(root, "pidIntegral", thermal.pid_integral);
+  cJSON_AddNumberToObject(root, "pidIntegralCandidate", thermal.pid_integral_candidate);
+  cJSON_AddNumberToObject(root, "pidDerivative", thermal.pid_derivative);
+  cJSON_AddNumberToObject(root, "pidPTerm", thermal.pid_p_term);
+  cJSON_AddNumberToObject(root, "pidITerm", thermal.pid_i_term);
+  cJSON_AddNumberToObject(root, "pidDTerm", thermal.pid_d_term);
+  cJSON_AddNumberToObject(root, "pidRawOutput", thermal.pid_raw_output);
+  cJSON_AddNumberToObject(root, "pidDt", thermal.pid_dt);
+  cJSON_AddBoolToObject(root, "pidSaturatedHigh", thermal.pid_saturated_high);
+  cJSON_AddBoolToObject(root, "pidSaturatedLow", thermal.pid_saturated_low);
+  cJSON_AddBoolToObject(root, "pidIntegralHeld", thermal.pid_integral_held);
   cJSON_AddStringToObject(root, "wifiMode", app_config.wifi_ap_mode ? "ap" : "sta");
-  cJSON_AddNumberToObject(root, "timestamp", snapshot.last_update_ms);
+  cJSON_AddNumberToObject(root, "timestamp", adc.last_update_ms);
   const UtcTimeSnapshot now = GetBestUtcTimeForData();
   const std::string iso = FormatUtcIso(now);
   cJSON_AddStringToObject(root, "timestampIso", iso.c_str());
   cJSON_AddStringToObject(root, "timeSource", UtcTimeSourceName(now.source));
-  cJSON_AddBoolToObject(root, "stepperEnabled", snapshot.stepper_enabled);
-  cJSON_AddBoolToObject(root, "stepperHoming", snapshot.homing);
-  cJSON_AddBoolToObject(root, "stepperDirForward", snapshot.stepper_direction_forward);
-  cJSON_AddNumberToObject(root, "stepperPosition", snapshot.stepper_position);
-  cJSON_AddNumberToObject(root, "stepperTarget", snapshot.stepper_target);
-  cJSON_AddNumberToObject(root, "stepperSpeedUs", snapshot.stepper_speed_us);
-  cJSON_AddNumberToObject(root, "stepperHomeOffsetSteps", snapshot.stepper_home_offset_steps);
-  cJSON_AddNumberToObject(root, "motorHallActiveLevel", snapshot.motor_hall_active_level);
-  cJSON_AddNumberToObject(root, "motorHallRawLevel", snapshot.motor_hall_raw_level);
-  cJSON_AddBoolToObject(root, "motorHallTriggered", snapshot.motor_hall_triggered);
-  cJSON_AddNumberToObject(root, "motorHallEdgeCount", snapshot.motor_hall_edge_count);
-  cJSON_AddNumberToObject(root, "motorHallActiveEdgeCount", snapshot.motor_hall_active_edge_count);
-  cJSON_AddNumberToObject(root, "motorHallLevel0EdgeCount", snapshot.motor_hall_level0_edge_count);
-  cJSON_AddNumberToObject(root, "motorHallLevel1EdgeCount", snapshot.motor_hall_level1_edge_count);
-  cJSON_AddNumberToObject(root, "motorHallLastEdgeLevel", snapshot.motor_hall_last_edge_level);
-  cJSON_AddNumberToObject(root, "motorHallLastEdgeSeenUs", static_cast<double>(snapshot.motor_hall_last_edge_seen_us));
-  cJSON_AddBoolToObject(root, "stepperMoving", snapshot.stepper_moving);
-  cJSON_AddBoolToObject(root, "stepperHomed", snapshot.stepper_homed);
-  cJSON_AddStringToObject(root, "stepperHomeStatus", snapshot.stepper_home_status.c_str());
-  if (!snapshot.usb_error.empty()) {
-    cJSON_AddStringToObject(root, "usbError", snapshot.usb_error.c_str());
-  }
+  cJSON_AddBoolToObject(root, "stepperEnabled", motion.stepper_enabled);
+  cJSON_AddBoolToObject(root, "stepperHoming", motion.homing);
+  cJSON_AddBoolToObject(root, "stepperDirForward", motion.stepper_direction_forward);
+  cJSON_AddNumberToObject(root, "stepperPosition", motion.stepper_position);
+  cJSON_AddNumberToObject(root, "stepperTarget", motion.stepper_target);
+  cJSON_AddNumberToObject(root, "stepperSpeedUs", motion.stepper_speed_us);
+  cJSON_AddNumberToObject(root, "stepperHomeOffsetSteps", motion.stepper_home_offset_steps);
+  cJSON_AddNumberToObject(root, "motorHallActiveLevel", motion.motor_hall_active_level);
+  cJSON_AddNumberToObject(root, "motorHallRawLevel", motion.motor_hall_raw_level);
+  cJSON_AddBoolToObject(root, "motorHallTriggered", motion.motor_hall_triggered);
+  cJSON_AddNumberToObject(root, "motorHallEdgeCount", motion.motor_hall_edge_count);
+  cJSON_AddNumberToObject(root, "motorHallActiveEdgeCount", motion.motor_hall_active_edge_count);
+  cJSON_AddNumberToObject(root, "motorHallLevel0EdgeCount", motion.motor_hall_level0_edge_count);
+  cJSON_AddNumberToObject(root, "motorHallLevel1EdgeCount", motion.motor_hall_level1_edge_count);
+  cJSON_AddNumberToObject(root, "motorHallLastEdgeLevel", motion.motor_hall_last_edge_level);
+  cJSON_AddNumberToObject(root, "motorHallLastEdgeSeenUs", static_cast<double>(motion.motor_hall_last_edge_seen_us));
+  cJSON_AddNumberToObject(root, "motorHallWidthSteps", motion.motor_hall_width_steps);
+  cJSON_AddNumberToObject(root, "motorHallSpeedSps", motion.motor_hall_speed_sps);
+  cJSON_AddBoolToObject(root, "stepperMoving", motion.stepper_moving);
+  cJSON_AddBoolToObject(root, "stepperHomed", motion.stepper_homed);
+  cJSON_AddStringToObject(root, "stepperHomeStatus", motion.stepper_home_status.c_str());
+  if (!storage.usb_error.empty()) {
+    cJSON_AddStringToObject(root, "usbError", storage.usb_error.c_str());
+  }
+  cJSON_AddItemToObject(root, "adcStats", BuildAdcStatsJson(AdcStatsGet()));
+
+  const char* resp = cJSON_PrintUnformatted(root);
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_sendstr(req, resp);
+  cJSON_free((void*)resp);
+  cJSON_Delete(root);
+  return ESP_OK;
+}
+
+esp_err_t StateContentionHandler(httpd_req_t* req) {
+  static StateCallerStats callers[STATE_CONTENTION_MAX_CALLERS];
+  StateContentionTotals totals{};
+  const size_t count = GetStateContentionStats(callers, STATE_CONTENTION_MAX_CALLERS, &totals);
+  cJSON* root = cJSON_CreateObject();
+  cJSON_AddNumberToObject(root, "updates", totals.updates);
+  cJSON_AddNumberToObject(root, "late", totals.late);
+  cJSON_AddNumberToObject(root, "dropped", totals.dropped);
+  cJSON_AddNumberToObject(root, "untrackedCallers", totals.untracked_callers);
+  cJSON_AddNumberToObject(root, "lateThresholdMs", STATE_UPDATE_LATE_MS);
+  cJSON_AddNumberToObject(root, "maxWaitMs", STATE_UPDATE_MAX_WAIT_MS);
+  cJSON* arr = cJSON_CreateArray();
+  for (size_t i = 0; i < count; ++i) {
+    const StateCallerStats& c = callers[i];
+    cJSON* item = cJSON_CreateObject();
+    cJSON_AddStringToObject(item, "caller", c.caller ? c.caller : "?");
+    cJSON_AddNumberToObject(item, "line", c.line);
+    cJSON_AddNumberToObject(item, "updates", c.updates);
+    cJSON_AddNumberToObject(item, "late", c.late);
+    cJSON_AddNumberToObject(item, "dropped", c.dropped);
+    cJSON_AddNumberToObject(item, "waitMaxUs", c.wait_max_us);
+    cJSON_AddNumberToObject(item, "waitAvgUs", c.updates ? static_cast<double>(c.wait_total_us) / c.updates : 0.0);
+    cJSON_AddNumberToObject(item, "holdMaxUs", c.hold_max_us);
+    cJSON_AddNumberToObject(item, "holdAvgUs", c.updates ? static_cast<double>(c.hold_total_us) / c.updates : 0.0);
+    cJSON_AddItemToArray(arr, item);
+  }
+  cJSON_AddItemToObject(root, "callers", arr);
+
+  const char* resp = cJSON_PrintUnformatted(root);
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_sendstr(req, resp);
+  cJSON_free((void*)resp);
+  cJSON_Delete(root);
+  return ESP_OK;
+}
+
+esp_err_t StateContentionResetHandler(httpd_req_t* req) {
+  ResetStateContentionStats();
+  httpd_resp_set_type(req, "application/json");
+  return httpd_resp_sendstr(req, "{\"status\":\"state_contention_reset\"}");
+}
+
+esp_err_t SpiStatsHandler(httpd_req_t* req) {
+  SpiClientStats stats[kSpiClientCount];
+  SpiArbiterGetStats(stats);
+  cJSON* root = cJSON_CreateObject();
+  cJSON* arr = cJSON_CreateArray();
+  for (int i = 0; i < kSpiClientCount; ++i) {
+    const SpiClientStats& c = stats[i];
+    cJSON* item = cJSON_CreateObject();
+    cJSON_AddStringToObject(item, "client", SpiClientName(static_cast<SpiClient>(i)));
+    cJSON_AddNumberToObject(item, "acquisitions", c.acquisitions);
+    cJSON_AddNumberToObject(item, "timeouts", c.timeouts);
+    cJSON_AddNumberToObject(item, "deferrals", c.deferrals);
+    cJSON_AddNumberToObject(item, "overBudget", c.over_budget);
+    cJSON_AddNumberToObject(item, "holdBudgetUs", c.hold_budget_us);
+    cJSON_AddNumberToObject(item, "waitMaxUs", c.wait_max_us);
+    cJSON_AddNumberToObject(item, "waitAvgUs", c.acquisitions ? static_cast<double>(c.wait_total_us) / c.acquisitions : 0.0);
+    cJSON_AddNumberToObject(item, "holdMaxUs", c.hold_max_us);
+    cJSON_AddNumberToObject(item, "holdAvgUs", c.acquisitions ? static_cast<double>(c.hold_total_us) / c.acquisitions : 0.0);
+    cJSON_AddItemToArray(arr, item);
+  }
+  cJSON_AddItemToObject(root, "clients", arr);
+
+  const char* resp = cJSON_PrintUnformatted(root);
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_sendstr(req, resp);
+  cJSON_free((void*)resp);
+  cJSON_Delete(root);
+  return ESP_OK;
+}
+
+esp_err_t SpiStatsResetHandler(httpd_req_t* req) {
+  SpiArbiterResetStats();
+  httpd_resp_set_type(req, "application/json");
+  return httpd_resp_sendstr(req, "{\"status\":\"spi_stats_reset\"}");
+}
+
+esp_err_t SensorScheduleHandler(httpd_req_t* req) {
+  SensorJobStats stats[kSensorJobCount];
+  SensorSchedulerGetStats(stats);
+  cJSON* root = cJSON_CreateObject();
+  cJSON* arr = cJSON_CreateArray();
+  for (const SensorJobStats& j : stats) {
+    cJSON* item = cJSON_CreateObject();
+    cJSON_AddStringToObject(item, "job", j.name);
+    cJSON_AddBoolToObject(item, "enabled", j.enabled);
+    cJSON_AddNumberToObject(item, "periodUs", j.period_us);
+    cJSON_AddNumberToObject(item, "deadlineUs", j.deadline_us);
+    cJSON_AddNumberToObject(item, "runs", j.runs);
+    cJSON_AddNumberToObject(item, "overruns", j.overruns);
+    cJSON_AddNumberToObject(item, "deferrals", j.deferrals);
+    cJSON_AddNumberToObject(item, "latencyAvgUs", j.latency_mean_us);
+    cJSON_AddNumberToObject(item, "latencyMaxUs", j.latency_max_us);
+    cJSON_AddNumberToObject(item, "jitterUs", j.jitter_us);
+    cJSON_AddNumberToObject(item, "runAvgUs", j.run_mean_us);
+    cJSON_AddNumberToObject(item, "runMaxUs", j.run_max_us);
+    cJSON_AddItemToArray(arr, item);
+  }
+  cJSON_AddItemToObject(root, "jobs", arr);
 
   const char* resp = cJSON_PrintUnformatted(root);
   httpd_resp_set_type(req, "application/json");
@@ -391,6 +560,12 @@ esp_err_t DataHandler(httpd_req_t* req) {
   return ESP_OK;
 }
 
+esp_err_t SensorScheduleResetHandler(httpd_req_t* req) {
+  SensorSchedulerResetStats();
+  httpd_resp_set_type(req, "application/json");
+  return httpd_resp_sendstr(req, "{\"status\":\"sensor_schedule_reset\"}");
+}
+
 esp_err_t CalibrateHandler(httpd_req_t* req) {
   ActionResult res = ActionCalibrate();
   httpd_resp_set_type(req, "application/json");
@@ -810,8 +985,6 @@ esp_err_t LogStopHandler(httpd_req_t* req) {
 }
 
 esp_err_t FsListHandler(httpd_req_t* req) {
-  SharedState snapshot = CopyState();
-
   std::string rel_path;
   int page = 0;
   int page_size = 10;
@@ -931,8 +1104,6 @@ esp_err_t FsListHandler(httpd_req_t* req) {
 }
 
 esp_err_t FsDownloadHandler(httpd_req_t* req) {
-  SharedState snapshot = CopyState();
-
   int qs_len = httpd_req_get_url_query_len(req) + 1;
   if (qs_len <= 1) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing query");
@@ -1014,7 +1185,7 @@ esp_err_t FsDownloadHandler(httpd_req_t* req) {
 }
 
 esp_err_t FsDeleteHandler(httpd_req_t* req) {
-  SharedState snapshot = CopyState();
+  const StorageState snapshot = ReadStorageState();
 
   std::vector<std::string> requested_files;
   bool has_body_files = false;
@@ -1836,7 +2007,7 @@ static esp_err_t TransferUploadQueueHandler(httpd_req_t* req, StorageBackend src
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Source and destination are the same");
     return ESP_FAIL;
   }
-  if (log_config.active || CopyState().logging || log_file != nullptr) {
+  if (log_config.active || ReadStorageState().logging || log_file != nullptr) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Stop logging before transfer");
     return ESP_FAIL;
   }
@@ -2216,6 +2387,195 @@ esp_err_t MeteoConfigApplyHandler(httpd_req_t* req) {
   return httpd_resp_sendstr(req, res.json.c_str());
 }
 
+// Body: {"osr": [o1, o2, ...]} with up to ADC_CHANNEL_COUNT entries (0 keeps a channel), or
+// {"osr": o} for every channel.
+esp_err_t AdcSpeedApplyHandler(httpd_req_t* req) {
+  const size_t buf_len = std::min<size_t>(req->content_len, 256);
+  if (buf_len == 0 || req->content_len > 256) {
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid body size");
+    return ESP_FAIL;
+  }
+  std::string body(buf_len, '\0');
+  size_t received_total = 0;
+  while (received_total < buf_len) {
+    const int received = httpd_req_recv(req, body.data() + received_total, buf_len - received_total);
+    if (received <= 0) {
+      httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Failed to read body");
+      return ESP_FAIL;
+    }
+    received_total += static_cast<size_t>(received);
+  }
+
+  cJSON* root = cJSON_Parse(body.c_str());
+  if (!root) {
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+    return ESP_FAIL;
+  }
+  AdcSpeedApplyRequest action_req;
+  cJSON* osr_item = cJSON_GetObjectItem(root, "osr");
+  bool valid = false;
+  if (osr_item && cJSON_IsNumber(osr_item)) {
+    action_req.osr.fill(osr_item->valueint);
+    valid = true;
+  } else if (osr_item && cJSON_IsArray(osr_item) && cJSON_GetArraySize(osr_item) <= ADC_CHANNEL_COUNT) {
+    valid = true;
+    for (int i = 0; i < cJSON_GetArraySize(osr_item); ++i) {
+      cJSON* entry = cJSON_GetArrayItem(osr_item, i);
+      if (!entry || !cJSON_IsNumber(entry)) {
+        valid = false;
+        break;
+      }
+      action_req.osr[i] = entry->valueint;
+    }
+  }
+  cJSON_Delete(root);
+  if (!valid) {
+    const std::string msg =
+        "osr must be a number or an array of up to " + std::to_string(ADC_CHANNEL_COUNT) + " numbers";
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, msg.c_str());
+    return ESP_FAIL;
+  }
+  bool any_osr = false;
+  for (int osr : action_req.osr) {
+    if (osr != 0 && !IsValidAdcOsr(osr)) {
+      httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "osr must be a power of two between 64 and 32768");
+      return ESP_FAIL;
+    }
+    any_osr |= osr != 0;
+  }
+  if (!any_osr) {
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "osr sets no channel");
+    return ESP_FAIL;
+  }
+
+  ActionResult res = ActionAdcSpeedApply(action_req);
+  if (!res.ok) {
+    httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, res.message.c_str());
+    return ESP_FAIL;
+  }
+  httpd_resp_set_type(req, "application/json");
+  return httpd_resp_sendstr(req, res.json.c_str());
+}
+
+static const char* AdcBurstPhaseName(AdcBurstPhase phase) {
+  switch (phase) {
+    case AdcBurstPhase::kArmed:     return "armed";
+    case AdcBurstPhase::kCapturing: return "capturing";
+    case AdcBurstPhase::kDone:      return "done";
+    case AdcBurstPhase::kAborted:   return "aborted";
+    case AdcBurstPhase::kIdle:      break;
+  }
+  return "idle";
+}
+
+static esp_err_t SendAdcBurstStatus(httpd_req_t* req) {
+  const AdcBurstStatus status = AdcBurstGetStatus();
+  cJSON* root = cJSON_CreateObject();
+  cJSON_AddStringToObject(root, "phase", AdcBurstPhaseName(status.phase));
+  cJSON_AddNumberToObject(root, "records", status.records);
+  cJSON_AddNumberToObject(root, "capacity", status.capacity);
+  cJSON_AddNumberToObject(root, "readErrors", status.read_errors);
+  const char* json = cJSON_PrintUnformatted(root);
+  httpd_resp_set_type(req, "application/json");
+  esp_err_t res = httpd_resp_sendstr(req, json ? json : "{}");
+  cJSON_free((void*)json);
+  cJSON_Delete(root);
+  return res;
+}
+
+// Body: {"seconds": 5, "osr": 64}; osr is optional (configured speeds when absent or 0).
+esp_err_t AdcBurstStartHandler(httpd_req_t* req) {
+  const size_t buf_len = std::min<size_t>(req->content_len, 128);
+  if (buf_len == 0 || req->content_len > 128) {
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid body size");
+    return ESP_FAIL;
+  }
+  std::string body(buf_len, '\0');
+  size_t received_total = 0;
+  while (received_total < buf_len) {
+    const int received = httpd_req_recv(req, body.data() + received_total, buf_len - received_total);
+    if (received <= 0) {
+      httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Failed to read body");
+      return ESP_FAIL;
+    }
+    received_total += static_cast<size_t>(received);
+  }
+
+  cJSON* root = cJSON_Parse(body.c_str());
+  if (!root) {
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+    return ESP_FAIL;
+  }
+  cJSON* seconds_item = cJSON_GetObjectItem(root, "seconds");
+  cJSON* osr_item = cJSON_GetObjectItem(root, "osr");
+  const bool valid = seconds_item && cJSON_IsNumber(seconds_item) && (!osr_item || cJSON_IsNumber(osr_item));
+  const float seconds = valid ? static_cast<float>(seconds_item->valuedouble) : 0.0f;
+  const int osr = (valid && osr_item) ? osr_item->valueint : 0;
+  cJSON_Delete(root);
+  if (!valid || (osr != 0 && !IsValidAdcOsr(osr))) {
+    httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "seconds must be a number; osr a power of two 64..32768");
+    return ESP_FAIL;
+  }
+
+  const esp_err_t err = AdcBurstStart(seconds, static_cast<uint16_t>(osr));
+  if (err == ESP_ERR_INVALID_STATE) {
+    httpd_resp_send_err(req, HTTPD_409_CONFLICT, "Burst capture or download in progress");
+    return ESP_FAIL;
+  }
+  if (err != ESP_OK) {
+    httpd_resp_send_err(req, err == ESP_ERR_INVALID_ARG ? HTTPD_400_BAD_REQUEST : HTTPD_500_INTERNAL_SERVER_ERROR,
+                        esp_err_to_name(err));
+    return ESP_FAIL;
+  }
+  return SendAdcBurstStatus(req);
+}
+
+esp_err_t AdcBurstStatusHandler(httpd_req_t* req) {
+  return SendAdcBurstStatus(req);
+}
+
+// Streams the finished capture straight out of PSRAM: AdcBurstHeader, then the records.
+esp_err_t AdcBurstDownloadHandler(httpd_req_t* req) {
+  AdcBurstHeader header;
+  const AdcBurstRecord* records = nullptr;
+  if (!AdcBurstAcquire(&header, &records)) {
+    httpd_resp_send_err(req, HTTPD_409_CONFLICT, "No finished burst capture");
+    return ESP_FAIL;
+  }
+  httpd_resp_set_type(req, "application/octet-stream");
+  httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"adc_burst.bin\"");
+
+  esp_err_t res = httpd_resp_send_chunk(req, reinterpret_cast<const char*>(&header), sizeof(header));
+  const char* data = reinterpret_cast<const char*>(records);
+  const size_t total = static_cast<size_t>(header.record_count) * sizeof(AdcBurstRecord);
+  constexpr size_t kChunk = 4096;
+  for (size_t sent = 0; res == ESP_OK && sent < total; sent += kChunk) {
+    res = httpd_resp_send_chunk(req, data + sent, std::min(kChunk, total - sent));
+  }
+  AdcBurstRelease();
+  if (res != ESP_OK) {
+    httpd_resp_send_chunk(req, nullptr, 0);
+    return ESP_FAIL;
+  }
+  return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+esp_err_t AdcStatsHandler(httpd_req_t* req) {
+  cJSON* root = BuildAdcStatsJson(AdcStatsGet());
+  const char* json = cJSON_PrintUnformatted(root);
+  httpd_resp_set_type(req, "application/json");
+  esp_err_t res = httpd_resp_sendstr(req, json ? json : "{}");
+  cJSON_free((void*)json);
+  cJSON_Delete(root);
+  return res;
+}
+
+esp_err_t AdcStatsResetHandler(httpd_req_t* req) {
+  AdcStatsReset();
+  httpd_resp_set_type(req, "application/json");
+  return httpd_resp_sendstr(req, "{\"status\":\"adc_stats_reset\"}");
+}
+
 esp_err_t GpsApplyHandler(httpd_req_t* req) {
   const size_t buf_len = std::min<size_t>(req->content_len, 512);
   if (buf_len == 0) {
@@ -2330,7 +2690,7 @@ esp_err_t StorageApplyHandler(httpd_req_t* req) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid storage backend");
     return ESP_FAIL;
   }
-  if (log_config.active || CopyState().logging || log_file != nullptr) {
+  if (log_config.active || ReadStorageState().logging || log_file != nullptr) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Stop logging before switching storage");
     return ESP_FAIL;
   }
@@ -2359,7 +2719,7 @@ esp_err_t StorageApplyHandler(httpd_req_t* req) {
 }
 
 esp_err_t StorageRemountHandler(httpd_req_t* req) {
-  if (log_config.active || CopyState().logging || log_file != nullptr) {
+  if (log_config.active || ReadStorageState().logging || log_file != nullptr) {
     httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Stop logging before remount");
     return ESP_FAIL;
   }
@@ -2398,7 +2758,7 @@ httpd_handle_t StartHttpServer() {
   // Cap the web server's socket pool so it can't monopolize LWIP_MAX_SOCKETS and
   // starve MQTT / SNTP / MinIO upload (default 7 + 3 reserved == the whole pool).
   config.max_open_sockets = 4;
-  config.max_uri_handlers = 47;
+  config.max_uri_handlers = 52;
   config.stack_size = 8192;
 
   if (httpd_start(&http_server, &config) != ESP_OK) {
@@ -2408,6 +2768,12 @@ httpd_handle_t StartHttpServer() {
 
   httpd_uri_t root_uri = {.uri = "/", .method = HTTP_GET, .handler = RootHandler, .user_ctx = nullptr};
   httpd_uri_t data_uri = {.uri = "/data", .method = HTTP_GET, .handler = DataHandler, .user_ctx = nullptr};
+  httpd_uri_t state_contention_uri = {.uri = "/state/contention", .method = HTTP_GET, .handler = StateContentionHandler, .user_ctx = nullptr};
+  httpd_uri_t state_contention_reset_uri = {.uri = "/state/contention/reset", .method = HTTP_POST, .handler = StateContentionResetHandler, .user_ctx = nullptr};
+  httpd_uri_t spi_stats_uri = {.uri = "/spi/stats", .method = HTTP_GET, .handler = SpiStatsHandler, .user_ctx = nullptr};
+  httpd_uri_t spi_stats_reset_uri = {.uri = "/spi/stats/reset", .method = HTTP_POST, .handler = SpiStatsResetHandler, .user_ctx = nullptr};
+  httpd_uri_t sensor_schedule_uri = {.uri = "/sensors/schedule", .method = HTTP_GET, .handler = SensorScheduleHandler, .user_ctx = nullptr};
+  httpd_uri_t sensor_schedule_reset_uri = {.uri = "/sensors/schedule/reset", .method = HTTP_POST, .handler = SensorScheduleResetHandler, .user_ctx = nullptr};
   httpd_uri_t calibrate_uri = {.uri = "/calibrate", .method = HTTP_POST, .handler = CalibrateHandler, .user_ctx = nullptr};
   httpd_uri_t restart_uri = {.uri = "/restart", .method = HTTP_POST, .handler = RestartHandler, .user_ctx = nullptr};
   httpd_uri_t external_power_set_uri = {.uri = "/external_power/set", .method = HTTP_POST, .handler = ExternalPowerSetHandler, .user_ctx = nullptr};
@@ -2423,6 +2789,12 @@ httpd_handle_t StartHttpServer() {
   httpd_uri_t net_apply_uri = {.uri = "/net/apply", .method = HTTP_POST, .handler = NetApplyHandler, .user_ctx = nullptr};
   httpd_uri_t cloud_apply_uri = {.uri = "/cloud/apply", .method = HTTP_POST, .handler = CloudApplyHandler, .user_ctx = nullptr};
   httpd_uri_t meteo_config_apply_uri = {.uri = "/meteo/config", .method = HTTP_POST, .handler = MeteoConfigApplyHandler, .user_ctx = nullptr};
+  httpd_uri_t adc_speed_apply_uri = {.uri = "/adc/speed", .method = HTTP_POST, .handler = AdcSpeedApplyHandler, .user_ctx = nullptr};
+  httpd_uri_t adc_burst_start_uri = {.uri = "/adc/burst/start", .method = HTTP_POST, .handler = AdcBurstStartHandler, .user_ctx = nullptr};
+  httpd_uri_t adc_burst_status_uri = {.uri = "/adc/burst/status", .method = HTTP_GET, .handler = AdcBurstStatusHandler, .user_ctx = nullptr};
+  httpd_uri_t adc_burst_download_uri = {.uri = "/adc/burst", .method = HTTP_GET, .handler = AdcBurstDownloadHandler, .user_ctx = nullptr};
+  httpd_uri_t adc_stats_uri = {.uri = "/adc/stats", .method = HTTP_GET, .handler = AdcStatsHandler, .user_ctx = nullptr};
+  httpd_uri_t adc_stats_reset_uri = {.uri = "/adc/stats/reset", .method = HTTP_POST, .handler = AdcStatsResetHandler, .user_ctx = nullptr};
   httpd_uri_t gps_apply_uri = {.uri = "/gps/apply", .method = HTTP_POST, .handler = GpsApplyHandler, .user_ctx = nullptr};
   httpd_uri_t gps_probe_uri = {.uri = "/gps/probe", .method = HTTP_POST, .handler = GpsProbeHandler, .user_ctx = nullptr};
   httpd_uri_t config_sync_internal_uri = {.uri = "/config/sync_internal_flash", .method = HTTP_POST, .handler = ConfigSyncInternalFlashHandler, .user_ctx = nullptr};
@@ -2448,6 +2820,12 @@ httpd_handle_t StartHttpServer() {
 
   httpd_register_uri_handler(http_server, &root_uri);
   httpd_register_uri_handler(http_server, &data_uri);
+  httpd_register_uri_handler(http_server, &state_contention_uri);
+  httpd_register_uri_handler(http_server, &state_contention_reset_uri);
+  httpd_register_uri_handler(http_server, &spi_stats_uri);
+  httpd_register_uri_handler(http_server, &spi_stats_reset_uri);
+  httpd_register_uri_handler(http_server, &sensor_schedule_uri);
+  httpd_register_uri_handler(http_server, &sensor_schedule_reset_uri);
   httpd_register_uri_handler(http_server, &calibrate_uri);
   httpd_register_uri_handler(http_server, &restart_uri);
   httpd_register_uri_handler(http_server, &external_power_set_uri);
@@ -2463,6 +2841,12 @@ httpd_handle_t StartHttpServer() {
   httpd_register_uri_handler(http_server, &net_apply_uri);
   httpd_register_uri_handler(http_server, &cloud_apply_uri);
   httpd_register_uri_handler(http_server, &meteo_config_apply_uri);
+  httpd_register_uri_handler(http_server, &adc_speed_apply_uri);
+  httpd_register_uri_handler(http_server, &adc_burst_start_uri);
+  httpd_register_uri_handler(http_server, &adc_burst_status_uri);
+  httpd_register_uri_handler(http_server, &adc_burst_download_uri);
+  httpd_register_uri_handler(http_server, &adc_stats_uri);
+  httpd_register_uri_handler(http_server, &adc_stats_reset_uri);
   httpd_register_uri_handler(http_server, &gps_apply_uri);
   httpd_register_uri_handler(http_server, &gps_probe_uri);
   httpd_register_uri_handler(http_server, &config_sync_internal_uri);
@@ -16,6 +16,7 @@
 #include "gps_module.h"
 #include "motion_controller.h"
 #include "network_manager.h"
+#include "sensor_hub.h"
 #include "cJSON.h"
 #include "driver/gpio.h"
 #include "error_manager.h"
@@ -29,12 +30,24 @@
 namespace {
 
 constexpr char TAG_MQTT[] = "MQTT_BRIDGE";
+// State is republished every kMqttStatePeriodMs for the continuously changing
+// measurements, and promptly (rate-limited) when discrete state changes. Stepper position
+// and Hall counters (kMotionProgress) churn during every move, so they ride the period.
+constexpr uint32_t kMqttStatePeriodMs = 10000;
+constexpr uint32_t kMqttStateMinIntervalMs = 1000;
+constexpr uint32_t kMqttStateEventGroups = StateGroupBit(StateGroup::kMotion) |
+                                           StateGroupBit(StateGroup::kNet) |
+                                           StateGroupBit(StateGroup::kLogging);
 esp_mqtt_client_handle_t mqtt_client = nullptr;
 static bool mqtt_connected = false;
 static std::string mqtt_rx_topic;
 static std::string mqtt_rx_payload;
 static char mqtt_state_topic_buf[80];
-static char mqtt_state_payload_buf[4096];
+// Everything but the per-channel fields fits the base; each channel adds its voltages and an
+// adcStats entry (~330 bytes with all Allan levels).
+constexpr size_t kMqttStateBaseBytes = 4096;
+constexpr size_t kMqttStatePerChannelBytes = 384;
+static char mqtt_state_payload_buf[kMqttStateBaseBytes + kMqttStatePerChannelBytes * ADC_CHANNEL_COUNT];
 static SemaphoreHandle_t mqtt_state_publish_mutex = nullptr;
 extern const uint8_t ca_crt_start[] asm("_binary_ca_crt_start");
 extern const uint8_t ca_crt_end[] asm("_binary_ca_crt_end");
@@ -95,6 +108,30 @@ std::vector<uint16_t> ParseRtcmTypes(cJSON* item) {
   return out;
 }
 
+// {"createdMs": 1715500000000, "tAdc": [..], "slope": [..], "intercept": [..]}, one array
+// element per ADC channel; null or a missing element leaves that value unknown.
+bool ParseBrightnessCalibration(cJSON* item, RadiometerCalibration* out) {
+  if (!item || !cJSON_IsObject(item) || !out) return false;
+  cJSON* created = cJSON_GetObjectItem(item, "createdMs");
+  if (!created || !cJSON_IsNumber(created) || created->valuedouble < 0) return false;
+  RadiometerCalibration cal;
+  cal.created_ms = static_cast<uint64_t>(created->valuedouble);
+  auto read_array = [&](const char* key, std::array<float, ADC_CHANNEL_COUNT>* dst) {
+    cJSON* arr = cJSON_GetObjectItem(item, key);
+    if (!arr || !cJSON_IsArray(arr)) return;
+    const int len = std::min(cJSON_GetArraySize(arr), ADC_CHANNEL_COUNT);
+    for (int ch = 0; ch < len; ++ch) {
+      cJSON* entry = cJSON_GetArrayItem(arr, ch);
+      if (entry && cJSON_IsNumber(entry)) (*dst)[ch] = static_cast<float>(entry->valuedouble);
+    }
+  };
+  read_array("tAdc", &cal.t_adc);
+  read_array("slope", &cal.slope);
+  read_array("intercept", &cal.intercept);
+  *out = cal;
+  return true;
+}
+
 bool ParseMqttUri(const std::string& raw_uri, ParsedMqttUri* out) {
   if (!out) {
     return false;
@@ -306,158 +343,166 @@ void MqttSendResponse(const std::string& device, const std::string& req_id, cons
   MqttPublish(topic, json);
 }
 
-void BuildMqttState(char* out, size_t out_len) {
-  if (!out || out_len == 0) return;
+// Returns false if the payload did not fit `out` (and so is not valid JSON).
+bool BuildMqttState(char* out, size_t out_len) {
+  if (!out || out_len == 0) return false;
   JsonBuf b{out, out_len, 0, false};
   out[0] = '\0';
   RefreshHallDebugState();
   JsonAppend(&b, "{");
-  if (state_mutex && xSemaphoreTake(state_mutex, pdMS_TO_TICKS(20)) == pdTRUE) {
-    JsonAppend(&b,
-               "\"voltage1\":%.6f,\"voltage2\":%.6f,\"voltage3\":%.6f,"
-               "\"voltage1_cal\":%.6f,\"voltage2_cal\":%.6f,\"voltage3_cal\":%.6f,"
-               "\"inaBusVoltage\":%.3f,\"inaCurrent\":%.3f,\"inaPower\":%.3f,"
-               "\"heaterPower\":%.1f,\"fanPower\":%.1f,\"fan1Rpm\":%u,\"fan2Rpm\":%u,"
-               "\"externalPowerOn\":%s,"
-               "\"tempSensorCount\":%d,\"tempSensors\":{",
-               state.voltage1,
-               state.voltage2,
-               state.voltage3,
-               state.voltage1_cal,
-               state.voltage2_cal,
-               state.voltage3_cal,
-               state.ina_bus_voltage,
-               state.ina_current,
-               state.ina_power,
-               state.heater_power,
-               state.fan_power,
-               static_cast<unsigned>(state.fan1_rpm),
-               static_cast<unsigned>(state.fan2_rpm),
-               state.external_power_on ? "true" : "false",
-               state.temp_sensor_count);
-    const int temp_count = std::min(state.temp_sensor_count, MAX_TEMP_SENSORS);
-    for (int i = 0; i < temp_count; ++i) {
-      JsonAppend(&b, "%s\"t%d\":{\"value\":%.2f,\"address\":", i == 0 ? "" : ",", i + 1, state.temps_c[i]);
-      JsonAppendEscaped(&b, state.temp_addresses[i].c_str());
-      JsonAppend(&b, ",\"label\":\"t%d\"}", i + 1);
-    }
-    JsonAppend(&b,
-               "},\"logging\":%s,\"logFilename\":",
-               state.logging ? "true" : "false");
-    JsonAppendEscaped(&b, state.log_filename.c_str());
-    JsonAppend(&b,
-               ",\"logUseMotor\":%s,\"logDuration\":%.3f,"
-               "\"loggingMotorSteps\":%d,\"loggingHomeEachCycle\":%s,"
-               "\"pidEnabled\":%s,\"pidSetpoint\":%.3f,\"pidSensorIndex\":%d,\"pidSensorMask\":%u,"
-               "\"pidKp\":%.6f,\"pidKi\":%.6f,\"pidKd\":%.6f,\"pidOutput\":%.3f,"
-               "\"pidTemperature\":%.3f,\"pidError\":%.3f,"
-               "\"pidIntegral\":%.3f,\"pidIntegralCandidate\":%.3f,\"pidDerivative\":%.6f,"
-               "\"pidPTerm\":%.3f,\"pidITerm\":%.3f,\"pidDTerm\":%.3f,\"pidRawOutput\":%.3f,"
-               "\"pidDt\":%.3f,\"pidSaturatedHigh\":%s,\"pidSaturatedLow\":%s,\"pidIntegralHeld\":%s,"
-             "\"stepperEnabled\":%s,\"stepperHoming\":%s,\"stepperDirForward\":%s,\"stepperMoving\":%s,"
-             "\"stepperHomed\":%s,\"stepperPosition\":%d,\"stepperTarget\":%d,"
-             "\"stepperSpeedUs\":%d,\"stepperHomeOffsetSteps\":%d,\"motorHallActiveLevel\":%d,"
-             "\"motorHallRawLevel\":%d,\"motorHallTriggered\":%s,"
-             "\"motorHallEdgeCount\":%u,\"motorHallActiveEdgeCount\":%u,"
-             "\"motorHallLevel0EdgeCount\":%u,\"motorHallLevel1EdgeCount\":%u,"
-             "\"motorHallLastEdgeLevel\":%d,\"motorHallLastEdgeSeenUs\":%lld,"
-             "\"stepperHomeStatus\":",
-               state.log_use_motor ? "true" : "false",
-               state.log_duration_s,
-               app_config.logging_motor_steps,
-               app_config.logging_home_each_cycle ? "true" : "false",
-               state.pid_enabled ? "true" : "false",
-               state.pid_setpoint,
-               state.pid_sensor_index,
-               static_cast<unsigned>(state.pid_sensor_mask),
-               state.pid_kp,
-               state.pid_ki,
-               state.pid_kd,
-               state.pid_output,
-               state.pid_temperature,
-               state.pid_error,
-               state.pid_integral,
-               state.pid_integral_candidate,
-               state.pid_derivative,
-               state.pid_p_term,
-               state.pid_i_term,
-               state.pid_d_term,
-               state.pid_raw_output,
-               state.pid_dt,
-               state.pid_saturated_high ? "true" : "false",
-               state.pid_saturated_low ? "true" : "false",
-               state.pid_integral_held ? "true" : "false",
-               state.stepper_enabled ? "true" : "false",
-               state.homing ? "true" : "false",
-               state.stepper_direction_forward ? "true" : "false",
-               state.stepper_moving ? "true" : "false",
-               state.stepper_homed ? "true" : "false",
-               state.stepper_position,
-               state.stepper_target,
-             state.stepper_speed_us,
-             state.stepper_home_offset_steps,
-             state.motor_hall_active_level,
-             state.motor_hall_raw_level,
-             state.motor_hall_triggered ? "true" : "false",
-             static_cast<unsigned>(state.motor_hall_edge_count),
-             static_cast<unsigned>(state.motor_hall_active_edge_count),
-             static_cast<unsigned>(state.motor_hall_level0_edge_count),
-             static_cast<unsigned>(state.motor_hall_level1_edge_count),
-             state.motor_hall_last_edge_level,
-             static_cast<long long>(state.motor_hall_last_edge_seen_us));
-    JsonAppendEscaped(&b, state.stepper_home_status.c_str());
-    JsonAppend(&b,
-               ",\"wifiRssi\":%d,\"wifiQuality\":%d,\"wifiIp\":",
-               state.wifi_rssi_dbm,
-               state.wifi_quality);
-    JsonAppendEscaped(&b, state.wifi_ip.c_str());
-    JsonAppend(&b, ",\"wifiStaIp\":");
-    JsonAppendEscaped(&b, state.wifi_ip_sta.c_str());
-    JsonAppend(&b, ",\"wifiApIp\":");
-    JsonAppendEscaped(&b, state.wifi_ip_ap.c_str());
-    JsonAppend(&b, ",\"ethIp\":");
-    JsonAppendEscaped(&b, state.eth_ip.c_str());
-    JsonAppend(&b,
-               ",\"ethLink\":%s,\"ethIpUp\":%s,"
-               "\"sdTotalBytes\":%llu,\"sdUsedBytes\":%llu,\"sdRootDataFiles\":%d,"
-               "\"sdToUploadFiles\":%d,\"sdUploadedFiles\":%d,"
-               "\"heapFreeBytes\":%u,\"heapMinFreeBytes\":%u,\"heapLargestFreeBlockBytes\":%u,"
-               "\"heapInternalFreeBytes\":%u,\"heapInternalLargestFreeBlockBytes\":%u,"
-               "\"heapPsramFreeBytes\":%u,\"heapPsramLargestFreeBlockBytes\":%u,"
-               "\"minioUploadAttempts\":%u,\"minioUploadSuccesses\":%u,\"minioUploadFailures\":%u,"
-               "\"minioArchiveFailures\":%u,"
-               "\"minioLastAttemptMs\":%llu,\"minioLastSuccessMs\":%llu,\"minioLastFailureMs\":%llu,"
-               "\"uptimeMs\":%llu,\"timestamp\":%llu",
-               state.eth_link_up ? "true" : "false",
-               state.eth_ip_up ? "true" : "false",
-               static_cast<unsigned long long>(state.sd_total_bytes),
-               static_cast<unsigned long long>(state.sd_used_bytes),
-               state.sd_data_root_files,
-               state.sd_to_upload_files,
-               state.sd_uploaded_files,
-               static_cast<unsigned>(state.heap_free_bytes),
-               static_cast<unsigned>(state.heap_min_free_bytes),
-               static_cast<unsigned>(state.heap_largest_free_block_bytes),
-               static_cast<unsigned>(state.heap_internal_free_bytes),
-               static_cast<unsigned>(state.heap_internal_largest_free_block_bytes),
-               static_cast<unsigned>(state.heap_psram_free_bytes),
-               static_cast<unsigned>(state.heap_psram_largest_free_block_bytes),
-               static_cast<unsigned>(state.minio_upload_attempts),
-               static_cast<unsigned>(state.minio_upload_successes),
-               static_cast<unsigned>(state.minio_upload_failures),
-               static_cast<unsigned>(state.minio_archive_failures),
-               static_cast<unsigned long long>(state.minio_last_attempt_ms),
-               static_cast<unsigned long long>(state.minio_last_success_ms),
-               static_cast<unsigned long long>(state.minio_last_failure_ms),
-               static_cast<unsigned long long>(esp_timer_get_time() / 1000ULL),
-               static_cast<unsigned long long>(state.last_update_ms));
-    if (!state.usb_error.empty()) {
-      JsonAppend(&b, ",\"usbError\":");
-      JsonAppendEscaped(&b, state.usb_error.c_str());
-    }
-    xSemaphoreGive(state_mutex);
-  } else {
-    JsonAppend(&b, "\"stateLocked\":true");
+  // Seqlock views: formatting below runs without holding state_mutex, so writers
+  // (ADC/INA/fan updates) are never blocked behind JSON formatting. Static because the
+  // only caller is serialized by mqtt_state_publish_mutex and the task stack is small.
+  static AdcState adc;
+  static ThermalState thermal;
+  static MotionState motion;
+  static NetState net;
+  static StorageState storage;
+  adc = ReadAdcState();
+  thermal = ReadThermalState();
+  motion = ReadMotionState();
+  net = ReadNetState();
+  storage = ReadStorageState();
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    JsonAppend(&b, "\"voltage%d\":%.6f,", ch + 1, adc.voltage[ch]);
+  }
+  for (int ch = 0; ch < ADC_CHANNEL_COUNT; ++ch) {
+    JsonAppend(&b, "\"voltage%d_cal\":%.6f,", ch + 1, adc.voltage_cal[ch]);
+  }
+  JsonAppend(&b,
+             "\"inaBusVoltage\":%.3f,\"inaCurrent\":%.3f,\"inaPower\":%.3f,"
+             "\"heaterPower\":%.1f,\"fanPower\":%.1f,\"fan1Rpm\":%u,\"fan2Rpm\":%u,"
+             "\"externalPowerOn\":%s,"
+             "\"tempSensorCount\":%d,\"tempSensors\":{",
+             adc.ina_bus_voltage,
+             adc.ina_current,
+             adc.ina_power,
+             thermal.heater_power,
+             thermal.fan_power,
+             static_cast<unsigned>(thermal.fan1_rpm),
+             static_cast<unsigned>(thermal.fan2_rpm),
+             thermal.external_power_on ? "true" : "false",
+             thermal.temp_sensor_count);
+  const int temp_count = std::min(thermal.temp_sensor_count, MAX_TEMP_SENSORS);
+  for (int i = 0; i < temp_count; ++i) {
+    JsonAppend(&b, "%s\"t%d\":{\"value\":%.2f,\"address\":", i == 0 ? "" : ",", i + 1, thermal.temps_c[i]);
+    JsonAppendEscaped(&b, thermal.temp_addresses[i].c_str());
+    JsonAppend(&b, ",\"label\":\"t%d\",\"flags\":%u}", i + 1,
+               static_cast<unsigned>(thermal.temp_flags[i]));
+  }
+  JsonAppend(&b,
+             "},\"logging\":%s,\"logFilename\":",
+             storage.logging ? "true" : "false");
+  JsonAppendEscaped(&b, storage.log_filename.c_str());
+  JsonAppend(&b,
+             ",\"logUseMotor\":%s,\"logDuration\":%.3f,"
+             "\"loggingMotorSteps\":%d,\"loggingHomeEachCycle\":%s,"
+             "\"pidEnabled\":%s,\"pidSetpoint\":%.3f,\"pidSensorIndex\":%d,\"pidSensorMask\":%u,"
+             "\"pidKp\":%.6f,\"pidKi\":%.6f,\"pidKd\":%.6f,\"pidOutput\":%.3f,"
+             "\"pidTemperature\":%.3f,\"pidError\":%.3f,"
+             "\"pidIntegral\":%.3f,\"pidIntegralCandidate\":%.3f,\"pidDerivative\":%.6f,"
+             "\"pidPTerm\":%.3f,\"pidITerm\":%.3f,\"pidDTerm\":%.3f,\"pidRawOutput\":%.3f,"
+             "\"pidDt\":%.3f,\"pidSaturatedHigh\":%s,\"pidSaturatedLow\":%s,\"pidIntegralHeld\":%s,"
+           "\"stepperEnabled\":%s,\"stepperHoming\":%s,\"stepperDirForward\":%s,\"stepperMoving\":%s,"
+           "\"stepperHomed\":%s,\"stepperPosition\":%d,\"stepperTarget\":%d,"
+           "\"stepperSpeedUs\":%d,\"stepperHomeOffsetSteps\":%d,\"motorHallActiveLevel\":%d,"
+           "\"motorHallRawLevel\":%d,\"motorHallTriggered\":%s,"
+           "\"motorHallEdgeCount\":%u,\"motorHallActiveEdgeCount\":%u,"
+           "\"motorHallLevel0EdgeCount\":%u,\"motorHallLevel1EdgeCount\":%u,"
+           "\"motorHallLastEdgeLevel\":%d,\"motorHallLastEdgeSeenUs\":%lld,"
+           "\"stepperHomeStatus\":",
+             storage.log_use_motor ? "true" : "false",
+             storage.log_duration_s,
+             app_config.logging_motor_steps,
+             app_config.logging_home_each_cycle ? "true" : "false",
+             thermal.pid_enabled ? "true" : "false",
+             thermal.pid_setpoint,
+             thermal.pid_sensor_index,
+             static_cast<unsigned>(thermal.pid_sensor_mask),
+             thermal.pid_kp,
+             thermal.pid_ki,
+             thermal.pid_kd,
+             thermal.pid_output,
+             thermal.pid_temperature,
+             thermal.pid_error,
+             thermal.pid_integral,
+             thermal.pid_integral_candidate,
+             thermal.pid_derivative,
+             thermal.pid_p_term,
+             thermal.pid_i_term,
+             thermal.pid_d_term,
+             thermal.pid_raw_output,
+             thermal.pid_dt,
+             thermal.pid_saturated_high ? "true" : "false",
+             thermal.pid_saturated_low ? "true" : "false",
+             thermal.pid_integral_held ? "true" : "false",
+             motion.stepper_enabled ? "true" : "false",
+             motion.homing ? "true" : "false",
+             motion.stepper_direction_forward ? "true" : "false",
+             motion.stepper_moving ? "true" : "false",
+             motion.stepper_homed ? "true" : "false",
+             motion.stepper_position,
+             motion.stepper_target,
+           motion.stepper_speed_us,
+           motion.stepper_home_offset_steps,
+           motion.motor_hall_active_level,
+           motion.motor_hall_raw_level,
+           motion.motor_hall_triggered ? "true" : "false",
+           static_cast<unsigned>(motion.motor_hall_edge_count),
+           static_cast<unsigned>(motion.motor_hall_active_edge_count),
+           static_cast<unsigned>(motion.motor_hall_level0_edge_count),
+           static_cast<unsigned>(motion.motor_hall_level1_edge_count),
+           motion.motor_hall_last_edge_level,
+           static_cast<long long>(motion.motor_hall_last_edge_seen_us));
+  JsonAppendEscaped(&b, motion.stepper_home_status.c_str());
+  JsonAppend(&b,
+             ",\"wifiRssi\":%d,\"wifiQuality\":%d,\"wifiIp\":",
+             net.wifi_rssi_dbm,
+             net.wifi_quality);
+  JsonAppendEscaped(&b, net.wifi_ip.c_str());
+  JsonAppend(&b, ",\"wifiStaIp\":");
+  JsonAppendEscaped(&b, net.wifi_ip_sta.c_str());
+  JsonAppend(&b, ",\"wifiApIp\":");
+  JsonAppendEscaped(&b, net.wifi_ip_ap.c_str());
+  JsonAppend(&b, ",\"ethIp\":");
+  JsonAppendEscaped(&b, net.eth_ip.c_str());
+  JsonAppend(&b,
+             ",\"ethLink\":%s,\"ethIpUp\":%s,"
+             "\"sdTotalBytes\":%llu,\"sdUsedBytes\":%llu,\"sdRootDataFiles\":%d,"
+             "\"sdToUploadFiles\":%d,\"sdUploadedFiles\":%d,"
+             "\"heapFreeBytes\":%u,\"heapMinFreeBytes\":%u,\"heapLargestFreeBlockBytes\":%u,"
+             "\"heapInternalFreeBytes\":%u,\"heapInternalLargestFreeBlockBytes\":%u,"
+             "\"heapPsramFreeBytes\":%u,\"heapPsramLargestFreeBlockBytes\":%u,"
+             "\"minioUploadAttempts\":%u,\"minioUploadSuccesses\":%u,\"minioUploadFailures\":%u,"
+             "\"minioArchiveFailures\":%u,"
+             "\"minioLastAttemptMs\":%llu,\"minioLastSuccessMs\":%llu,\"minioLastFailureMs\":%llu,"
+             "\"uptimeMs\":%llu,\"timestamp\":%llu",
+             net.eth_link_up ? "true" : "false",
+             net.eth_ip_up ? "true" : "false",
+             static_cast<unsigned long long>(storage.sd_total_bytes),
+             static_cast<unsigned long long>(storage.sd_used_bytes),
+             storage.sd_data_root_files,
+             storage.sd_to_upload_files,
+             storage.sd_uploaded_files,
+             static_cast<unsigned>(storage.heap_free_bytes),
+             static_cast<unsigned>(storage.heap_min_free_bytes),
+             static_cast<unsigned>(storage.heap_largest_free_block_bytes),
+             static_cast<unsigned>(storage.heap_internal_free_bytes),
+             static_cast<unsigned>(storage.heap_internal_largest_free_block_bytes),
+             static_cast<unsigned>(storage.heap_psram_free_bytes),
+             static_cast<unsigned>(storage.heap_psram_largest_free_block_bytes),
+             static_cast<unsigned>(storage.minio_upload_attempts),
+             static_cast<unsigned>(storage.minio_upload_successes),
+             static_cast<unsigned>(storage.minio_upload_failures),
+             static_cast<unsigned>(storage.minio_archive_failures),
+             static_cast<unsigned long long>(storage.minio_last_attempt_ms),
+             static_cast<unsigned long long>(storage.minio_last_success_ms),
+             static_cast<unsigned long long>(storage.minio_last_failure_ms),
+             static_cast<unsigned long long>(esp_timer_get_time() / 1000ULL),
+             static_cast<unsigned long long>(adc.last_update_ms));
+  if (!storage.usb_error.empty()) {
+    JsonAppend(&b, ",\"usbError\":");
+    JsonAppendEscaped(&b, storage.usb_error.c_str());
   }
   JsonAppend(&b,
              ",\"wifiApMode\":%s,\"wifiMode\":",
@@ -525,7 +570,28 @@ void BuildMqttState(char* out, size_t out_len) {
              static_cast<unsigned long long>(UtcTimeToUnixMs(now)));
   JsonAppendEscaped(&b, UtcTimeSourceName(now.source));
   {
-    const MeteoData& m = state.meteo;
+    // adevV[k] is the Allan deviation at tau0S * 2^k; levels without a term are left out.
+    static AdcStatsSnapshot stats;
+    stats = AdcStatsGet();
+    JsonAppend(&b, ",\"adcStats\":{\"sinceUs\":%lld,\"tau0S\":%.6f,\"channels\":[",
+               static_cast<long long>(stats.since_us), stats.tau0_s);
+    for (int i = 0; i < ADC_CHANNEL_COUNT; ++i) {
+      const AdcChannelStats& c = stats.ch[i];
+      JsonAppend(&b,
+                 "%s{\"osr\":%u,\"count\":%u,\"gaps\":%u,\"meanV\":%.7f,\"stddevV\":%.3e,"
+                 "\"minV\":%.7f,\"maxV\":%.7f,\"adevV\":[",
+                 i == 0 ? "" : ",", static_cast<unsigned>(stats.osr[i]),
+                 static_cast<unsigned>(c.count), static_cast<unsigned>(c.gaps), c.mean_v,
+                 c.stddev_v, c.min_v, c.max_v);
+      for (int k = 0; k < kAdcAllanLevels && c.allan_terms[k] > 0; ++k) {
+        JsonAppend(&b, "%s%.3e", k == 0 ? "" : ",", c.allan_dev_v[k]);
+      }
+      JsonAppend(&b, "]}");
+    }
+    JsonAppend(&b, "]}");
+  }
+  {
+    const MeteoData m = ReadMeteoState();
     JsonAppend(&b, ",\"meteoOnline\":%s", m.online ? "true" : "false");
     if (m.online) {
       // WN90LP uses 0xFFFF sentinel -> NaN; emit JSON null to keep payload valid.
@@ -548,6 +614,7 @@ void BuildMqttState(char* out, size_t out_len) {
     }
   }
   JsonAppend(&b, "}");
+  return !b.truncated;
 }
 
 void PublishCurrentState() {
@@ -557,8 +624,12 @@ void PublishCurrentState() {
   }
   {
       BuildMqttTopic(mqtt_state_topic_buf, sizeof(mqtt_state_topic_buf), "state");
-      BuildMqttState(mqtt_state_payload_buf, sizeof(mqtt_state_payload_buf));
-      MqttPublish(mqtt_state_topic_buf, mqtt_state_payload_buf, std::strlen(mqtt_state_payload_buf), 0, false);
+      if (BuildMqttState(mqtt_state_payload_buf, sizeof(mqtt_state_payload_buf))) {
+        MqttPublish(mqtt_state_topic_buf, mqtt_state_payload_buf, std::strlen(mqtt_state_payload_buf), 0, false);
+      } else {
+        ESP_LOGW(TAG_MQTT, "State payload exceeds %u bytes, not published",
+                 static_cast<unsigned>(sizeof(mqtt_state_payload_buf)));
+      }
   }
   if (mqtt_state_publish_mutex) {
     xSemaphoreGive(mqtt_state_publish_mutex);
@@ -566,9 +637,20 @@ void PublishCurrentState() {
 }
 
 void MqttStateTask(void*) {
+  StateSubscribe(xTaskGetCurrentTaskHandle(), kMqttStateEventGroups);
   while (true) {
     PublishCurrentState();
-    vTaskDelay(pdMS_TO_TICKS(10000));
+    const int64_t published_us = esp_timer_get_time();
+    uint32_t changed = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &changed, pdMS_TO_TICKS(kMqttStatePeriodMs));
+    if (changed) {
+      // Coalesce bursts (e.g. a stepper move updates position on every step).
+      const int64_t elapsed_ms = (esp_timer_get_time() - published_us) / 1000;
+      if (elapsed_ms < kMqttStateMinIntervalMs) {
+        vTaskDelay(pdMS_TO_TICKS(kMqttStateMinIntervalMs - elapsed_ms));
+      }
+      xTaskNotifyStateClear(nullptr);
+    }
   }
 }
 
@@ -748,6 +830,45 @@ void HandleMqttCommand(const std::string& topic, const std::string& payload) {
       req.file_interval_s = 0;
     }
     res = ActionMeteoConfigApply(req);
+  } else if (type == "adc_speed_apply") {
+    AdcSpeedApplyRequest req;
+    cJSON* osr_item = cJSON_GetObjectItem(root, "osr");
+    if (osr_item && cJSON_IsNumber(osr_item)) {
+      req.osr.fill(osr_item->valueint);
+    } else if (osr_item && cJSON_IsArray(osr_item)) {
+      const int len = std::min(cJSON_GetArraySize(osr_item), ADC_CHANNEL_COUNT);
+      for (int i = 0; i < len; ++i) {
+        cJSON* entry = cJSON_GetArrayItem(osr_item, i);
+        // Anything that is not a number is rejected by the action as an invalid OSR.
+        req.osr[i] = (entry && cJSON_IsNumber(entry)) ? entry->valueint : -1;
+      }
+    }
+    res = ActionAdcSpeedApply(req);
+  } else if (type == "brightness_cal_apply") {
+    BrightnessCalApplyRequest req;
+    cJSON* cals_item = cJSON_GetObjectItem(root, "calibrations");
+    if (cals_item && cJSON_IsArray(cals_item)) {
+      req.calibrations_set = true;
+      const int len = cJSON_GetArraySize(cals_item);
+      for (int i = 0; i < len; ++i) {
+        RadiometerCalibration cal;
+        if (!ParseBrightnessCalibration(cJSON_GetArrayItem(cals_item, i), &cal)) {
+          req.invalid_calibration = i;
+          break;
+        }
+        req.calibrations.push_back(cal);
+      }
+    }
+    cJSON* sensors_item = cJSON_GetObjectItem(root, "sensors");
+    if (sensors_item && cJSON_IsArray(sensors_item)) {
+      req.sensors_set = true;
+      const int len = std::min(cJSON_GetArraySize(sensors_item), ADC_CHANNEL_COUNT);
+      for (int ch = 0; ch < len; ++ch) {
+        cJSON* entry = cJSON_GetArrayItem(sensors_item, ch);
+        if (entry && cJSON_IsString(entry) && entry->valuestring) req.sensors[ch] = entry->valuestring;
+      }
+    }
+    res = ActionBrightnessCalApply(req);
   } else if (type == "config_sync_internal_flash") {
     res = ActionConfigSyncInternalFlash();
   } else if (type == "uploaded_clear" || type == "clear_uploaded") {
@@ -73,14 +73,17 @@ const char INDEX_HTML[] = R"rawliteral(
       <div class="adc-channel">
         <div class="channel-name">ADC Channel 1</div>
         <div class="voltage" id="voltage1">0.000000 V</div>
+        <div class="note" id="brightness1"></div>
       </div>
       <div class="adc-channel">
         <div class="channel-name">ADC Channel 2</div>
         <div class="voltage" id="voltage2">0.000000 V</div>
+        <div class="note" id="brightness2"></div>
       </div>
       <div class="adc-channel">
         <div class="channel-name">ADC Channel 3</div>
         <div class="voltage" id="voltage3">0.000000 V</div>
+        <div class="note" id="brightness3"></div>
       </div>
     </div>
 
@@ -963,6 +966,10 @@ Moving: <span id="stepperMoving">No</span>
       document.getElementById('voltage1').textContent = data.voltage1.toFixed(6) + ' V';
       document.getElementById('voltage2').textContent = data.voltage2.toFixed(6) + ' V';
       document.getElementById('voltage3').textContent = data.voltage3.toFixed(6) + ' V';
+      for (let ch = 1; ch <= 3; ch++) {
+        const tb = data['brightnessTemp' + ch];
+        setText('brightness' + ch, Number.isFinite(tb) ? `Tb ${tb.toFixed(2)} K` : '');
+      }
       document.getElementById('inaVoltage').textContent = data.inaBusVoltage.toFixed(3) + ' V';
       document.getElementById('inaCurrent').textContent = data.inaCurrent.toFixed(3);
       document.getElementById('inaPower').textContent = data.inaPower.toFixed(3);
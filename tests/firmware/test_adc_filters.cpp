@@ -0,0 +1,290 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "adc_filters.h"
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "FAIL: " << message << "\n";
+    failures++;
+  }
+}
+
+bool Near(float a, float b, float tol) { return std::fabs(a - b) <= tol; }
+
+// 24-bit-range codes with noise, like LTC2440 output after the 5-bit shift.
+std::vector<int32_t> NoisyCodes(size_t n, int32_t dc, int32_t noise) {
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<int32_t> dist(-noise, noise);
+  std::vector<int32_t> out(n);
+  for (auto& v : out) v = dc + dist(rng);
+  return out;
+}
+
+void TestCicDc() {
+  CicDecimator<3, 16> cic;
+  int outputs = 0;
+  bool all_dc = true;
+  for (int i = 0; i < 16 * 20; ++i) {
+    float y = 0.0f;
+    if (cic.Push(-4'000'000, &y)) {
+      ++outputs;
+      all_dc &= Near(y, -4'000'000.0f, 1.0f);
+    }
+  }
+  Check(outputs == 20 - 3, "CIC suppresses the order-3 start-up transient");
+  Check(all_dc, "CIC has unity DC gain");
+}
+
+void TestCicMatchesBlockMean() {
+  // A first-order CIC is a block mean.
+  const auto codes = NoisyCodes(64 * 10, 1'000'000, 50'000);
+  CicDecimator<1, 64> cic;
+  BoxcarDecimator box(64);
+  int compared = 0;
+  bool match = true;
+  float cic_y = 0.0f, box_y = 0.0f;
+  for (int32_t c : codes) {
+    const bool cic_out = cic.Push(c, &cic_y);
+    const bool box_out = box.Push(c, &box_y);
+    if (cic_out && box_out) {
+      ++compared;
+      match &= Near(cic_y, box_y, 0.5f);
+    }
+  }
+  Check(compared == 9, "CIC order 1 and boxcar decimator stay aligned after the transient");
+  Check(match, "CIC order 1 equals the block mean");
+}
+
+void TestBoxcarDecimatorRuntimeFactor() {
+  BoxcarDecimator box(4);
+  float y = 0.0f;
+  Check(!box.Push(1.0f, &y) && !box.Push(2.0f, &y) && !box.Push(3.0f, &y),
+        "boxcar waits for a full block");
+  Check(box.Push(6.0f, &y) && Near(y, 3.0f, 1e-6f), "boxcar block mean");
+  box.SetDecimation(1);
+  Check(box.Push(int32_t{7}, &y) && Near(y, 7.0f, 1e-6f), "boxcar factor 1 passes through");
+}
+
+void TestBoxcarDecimatorFloatCodes() {
+  // Codes arriving as float (after a median stage) average as exactly as the integer path.
+  const auto codes = NoisyCodes(4096, 8'000'000, 1'000);
+  BoxcarDecimator exact(4096), floats(4096);
+  float y_exact = 0.0f, y_float = 0.0f;
+  for (int32_t c : codes) {
+    exact.Push(c, &y_exact);
+    floats.Push(static_cast<float>(c), &y_float);
+  }
+  Check(Near(y_float, y_exact, 1.0f), "float-fed boxcar matches the integer block mean");
+}
+
+void TestMovingBoxcar() {
+  Boxcar<4> avg;
+  float y = 0.0f;
+  avg.Push(4.0f, &y);
+  Check(Near(y, 4.0f, 1e-6f), "moving boxcar averages what it has");
+  avg.Push(8.0f, &y);
+  avg.Push(0.0f, &y);
+  avg.Push(4.0f, &y);
+  Check(Near(y, 4.0f, 1e-6f), "moving boxcar full window");
+  avg.Push(12.0f, &y);
+  Check(Near(y, 6.0f, 1e-6f), "moving boxcar slides");
+}
+
+void TestFirImpulse() {
+  FirFilter<3> fir({0.25f, 0.5f, 0.25f});
+  float y = 0.0f;
+  std::vector<float> out;
+  for (float x : {1.0f, 0.0f, 0.0f, 0.0f}) {
+    fir.Push(x, &y);
+    out.push_back(y);
+  }
+  Check(Near(out[0], 0.25f, 1e-6f) && Near(out[1], 0.5f, 1e-6f) && Near(out[2], 0.25f, 1e-6f) &&
+            Near(out[3], 0.0f, 1e-6f),
+        "FIR impulse response equals the taps");
+
+  FirFilter<4, 2> dec;
+  int outputs = 0;
+  for (int i = 0; i < 10; ++i) outputs += dec.Push(1.0f, &y) ? 1 : 0;
+  Check(outputs == 5 && Near(y, 1.0f, 1e-6f), "decimating FIR outputs every 2nd sample");
+}
+
+void TestRunningMedianRemovesSpike() {
+  RunningMedian<5> med;
+  float y = 0.0f;
+  bool clean = true;
+  for (int i = 0; i < 20; ++i) {
+    const float x = (i == 10) ? 1e6f : 1.0f;
+    med.Push(x, &y);
+    if (i >= 4) clean &= Near(y, 1.0f, 1e-6f);
+  }
+  Check(clean, "running median removes a single-sample spike");
+  RunningMedian<3> small;
+  small.Push(3.0f, &y);
+  small.Push(1.0f, &y);
+  Check(Near(y, 2.0f, 1e-6f), "running median of a partial even window averages the middle pair");
+  small.Push(2.0f, &y);
+  small.Push(10.0f, &y);
+  Check(Near(y, 2.0f, 1e-6f), "running median slides");
+}
+
+void TestSigmaClip() {
+  SigmaClip<16> clip(3.0f);
+  std::mt19937 rng(7);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  float y = 0.0f;
+  for (int i = 0; i < 64; ++i) clip.Push(100.0f + noise(rng), &y);
+  const uint32_t before = clip.rejected();
+  Check(!clip.Push(150.0f, &y), "sigma clip rejects a 50-sigma glitch");
+  Check(clip.rejected() == before + 1, "sigma clip counts the rejection");
+
+  // A genuine step is followed after one window of rejections.
+  bool followed = false;
+  for (int i = 0; i < 40; ++i) {
+    if (clip.Push(200.0f + noise(rng), &y)) followed = true;
+  }
+  Check(followed, "sigma clip follows a sustained step");
+}
+
+void TestSigmaClipLargeOffset() {
+  // 20 uV of noise on a 2.1 V level: the spread is far below float resolution of 2.1^2.
+  SigmaClip<32> clip(3.0f);
+  std::mt19937 rng(8);
+  std::normal_distribution<float> noise(0.0f, 20e-6f);
+  float y = 0.0f;
+  for (int i = 0; i < 200; ++i) clip.Push(2.1f + noise(rng), &y);
+  Check(clip.rejected() <= 3, "sigma clip keeps clean data on a large DC offset");
+  Check(!clip.Push(2.1f + 400e-6f, &y), "sigma clip rejects a 20-sigma glitch on a large DC offset");
+}
+
+void TestChain() {
+  FilterChain<CicDecimator<2, 8>, RunningMedian<3>> chain;
+  const auto codes = NoisyCodes(8 * 100, 500'000, 1'000);
+  int outputs = 0;
+  float y = 0.0f;
+  bool near_dc = true;
+  for (int32_t c : codes) {
+    if (chain.Push(c, &y)) {
+      ++outputs;
+      near_dc &= Near(y, 500'000.0f, 1'000.0f);
+    }
+  }
+  Check(outputs == 100 - 2, "chain emits one output per decimation block");
+  Check(near_dc, "chain output tracks the DC level");
+}
+
+void TestHampelTemperatureSpikes() {
+  HampelFilter<9> hampel(3.5f, 0.05f);
+  std::mt19937 rng(21);
+  std::normal_distribution<float> noise(0.0f, 0.01f);
+  float y = 0.0f;
+  for (int i = 0; i < 4; ++i) Check(hampel.Push(35.0f + noise(rng), &y), "Hampel passes the warm-up");
+  bool clean = true;
+  for (int i = 0; i < 30; ++i) clean &= hampel.Push(35.0f + noise(rng), &y);
+  Check(clean, "Hampel keeps noisy steady readings");
+  Check(!hampel.Push(120.0f, &y) && Near(y, 35.0f, 0.05f), "Hampel replaces a spike with the median");
+  Check(!hampel.Push(-20.0f, &y), "Hampel rejects a dropout");
+  Check(hampel.rejected() == 2, "Hampel counts rejections");
+
+  // A real 2 degC step is followed once it holds half the window.
+  int rejected_step = 0;
+  for (int i = 0; i < 9; ++i) rejected_step += hampel.Push(37.0f + noise(rng), &y) ? 0 : 1;
+  Check(rejected_step <= 5 && Near(y, 37.0f, 0.05f), "Hampel follows a sustained step");
+
+  // Slow heating does not trip the filter.
+  HampelFilter<9> ramp(3.5f, 0.05f);
+  bool ramp_clean = true;
+  for (int i = 0; i < 60; ++i) ramp_clean &= ramp.Push(30.0f + 0.05f * static_cast<float>(i), &y);
+  Check(ramp_clean, "Hampel passes a 0.05 degC/s ramp");
+}
+
+template <typename Fn>
+void Bench(const char* name, size_t n, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  const float sink = fn();
+  const auto stop = std::chrono::steady_clock::now();
+  const double ns =
+      std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(n);
+  std::cout << "  " << name << ": " << ns << " ns/sample (sink " << sink << ")\n";
+}
+
+void BenchmarkStages() {
+  constexpr size_t kSamples = 4'000'000;
+  const auto codes = NoisyCodes(kSamples, 1'000'000, 100'000);
+  std::cout << "Filter throughput (host, " << kSamples << " samples):\n";
+  Bench("CicDecimator<3,64>", kSamples, [&] {
+    CicDecimator<3, 64> f;
+    float y = 0.0f, acc = 0.0f;
+    for (int32_t c : codes) acc += f.Push(c, &y) ? y : 0.0f;
+    return acc;
+  });
+  Bench("BoxcarDecimator(64)", kSamples, [&] {
+    BoxcarDecimator f(64);
+    float y = 0.0f, acc = 0.0f;
+    for (int32_t c : codes) acc += f.Push(c, &y) ? y : 0.0f;
+    return acc;
+  });
+  Bench("Boxcar<16>", kSamples, [&] {
+    Boxcar<16> f;
+    float y = 0.0f, acc = 0.0f;
+    for (int32_t c : codes) acc += f.Push(static_cast<float>(c), &y) ? y : 0.0f;
+    return acc;
+  });
+  Bench("FirFilter<16>", kSamples, [&] {
+    FirFilter<16> f;
+    float y = 0.0f, acc = 0.0f;
+    for (int32_t c : codes) acc += f.Push(static_cast<float>(c), &y) ? y : 0.0f;
+    return acc;
+  });
+  Bench("RunningMedian<5>", kSamples, [&] {
+    RunningMedian<5> f;
+    float y = 0.0f, acc = 0.0f;
+    for (int32_t c : codes) acc += f.Push(static_cast<float>(c), &y) ? y : 0.0f;
+    return acc;
+  });
+  Bench("SigmaClip<32>", kSamples, [&] {
+    SigmaClip<32> f;
+    float y = 0.0f, acc = 0.0f;
+    for (int32_t c : codes) acc += f.Push(static_cast<float>(c), &y) ? y : 0.0f;
+    return acc;
+  });
+  Bench("Chain<Cic<3,16>,Median<3>,Fir<8>>", kSamples, [&] {
+    FilterChain<CicDecimator<3, 16>, RunningMedian<3>, FirFilter<8>> f;
+    float y = 0.0f, acc = 0.0f;
+    for (int32_t c : codes) acc += f.Push(c, &y) ? y : 0.0f;
+    return acc;
+  });
+}
+
+}  // namespace
+
+int main() {
+  TestCicDc();
+  TestCicMatchesBlockMean();
+  TestBoxcarDecimatorRuntimeFactor();
+  TestBoxcarDecimatorFloatCodes();
+  TestMovingBoxcar();
+  TestFirImpulse();
+  TestRunningMedianRemovesSpike();
+  TestSigmaClip();
+  TestSigmaClipLargeOffset();
+  TestHampelTemperatureSpikes();
+  TestChain();
+
+  if (failures != 0) {
+    std::cerr << failures << " test(s) failed\n";
+    return 1;
+  }
+  BenchmarkStages();
+  std::cout << "OK: all ADC filter tests passed\n";
+  return 0;
+}
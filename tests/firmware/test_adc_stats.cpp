@@ -0,0 +1,376 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "adc_stats.h"
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "FAIL: " << message << "\n";
+    failures++;
+  }
+}
+
+bool NearRel(double a, double b, double rel) { return std::fabs(a - b) <= rel * std::fabs(b); }
+
+std::vector<int32_t> WhiteCodes(size_t n, int32_t dc, double sigma, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> noise(0.0, sigma);
+  std::vector<int32_t> out(n);
+  for (auto& v : out) v = dc + static_cast<int32_t>(std::lround(noise(rng)));
+  return out;
+}
+
+// Textbook overlapping Allan deviation from block means.
+double BruteForceAdev(const std::vector<int32_t>& y, size_t m) {
+  if (y.size() < 2 * m) return 0.0;
+  double sum = 0.0;
+  size_t terms = 0;
+  for (size_t i = 0; i + 2 * m <= y.size(); ++i) {
+    double a = 0.0, b = 0.0;
+    for (size_t k = 0; k < m; ++k) {
+      a += y[i + k];
+      b += y[i + m + k];
+    }
+    const double diff = (b - a) / static_cast<double>(m);
+    sum += diff * diff;
+    ++terms;
+  }
+  return std::sqrt(sum / (2.0 * static_cast<double>(terms)));
+}
+
+void TestWelfordMatchesTwoPass() {
+  const auto codes = WhiteCodes(20'000, 6'000'000, 300.0, 1);
+  RunningStats stats;
+  for (int32_t c : codes) stats.Push(c);
+  double mean = 0.0;
+  for (int32_t c : codes) mean += c;
+  mean /= static_cast<double>(codes.size());
+  double var = 0.0;
+  int32_t lo = codes[0], hi = codes[0];
+  for (int32_t c : codes) {
+    var += (c - mean) * (c - mean);
+    lo = std::min(lo, c);
+    hi = std::max(hi, c);
+  }
+  var /= static_cast<double>(codes.size() - 1);
+  Check(stats.count() == codes.size(), "Welford counts every sample");
+  Check(std::fabs(stats.mean() - mean) < 1e-6, "Welford mean matches two-pass mean");
+  Check(NearRel(stats.variance(), var, 1e-9), "Welford variance matches two-pass variance");
+  Check(stats.min() == lo && stats.max() == hi, "Welford tracks min/max");
+  stats.Reset();
+  Check(stats.count() == 0 && stats.variance() == 0.0, "Welford reset clears state");
+}
+
+void TestAllanMatchesBruteForce() {
+  constexpr int kLevels = 6;
+  std::vector<int64_t> storage(AllanAccumulator<kLevels>::kHistory);
+  AllanAccumulator<kLevels> allan;
+  Check(allan.Attach(storage.data()), "Allan attaches storage");
+  // Random walk on top of white noise, so levels differ in shape, not just by 1/sqrt(m).
+  auto codes = WhiteCodes(5'000, -2'000'000, 50.0, 2);
+  std::mt19937 rng(3);
+  std::normal_distribution<double> step(0.0, 5.0);
+  double walk = 0.0;
+  for (auto& c : codes) {
+    walk += step(rng);
+    c += static_cast<int32_t>(walk);
+  }
+  for (int32_t c : codes) allan.Push(c);
+  for (int k = 0; k < kLevels; ++k) {
+    const size_t m = size_t{1} << k;
+    const double expected = BruteForceAdev(codes, m);
+    Check(NearRel(allan.deviation(k), expected, 1e-4),
+          "Allan deviation matches brute force at m=" + std::to_string(m));
+    Check(allan.terms(k) == codes.size() - 2 * m + 1, "Allan term count at m=" + std::to_string(m));
+  }
+}
+
+void TestAllanWhiteNoiseSlope() {
+  constexpr int kLevels = 8;
+  std::vector<int64_t> storage(AllanAccumulator<kLevels>::kHistory);
+  AllanAccumulator<kLevels> allan;
+  allan.Attach(storage.data());
+  const auto codes = WhiteCodes(200'000, 1'000'000, 1000.0, 4);
+  for (int32_t c : codes) allan.Push(c);
+  for (int k = 0; k < kLevels; ++k) {
+    const double expected = 1000.0 / std::sqrt(static_cast<double>(1u << k));
+    Check(NearRel(allan.deviation(k), expected, 0.08),
+          "white noise Allan deviation falls as 1/sqrt(m) at level " + std::to_string(k));
+  }
+  allan.Reset();
+  Check(allan.samples() == 0 && allan.terms(0) == 0 && allan.deviation(0) == 0.0,
+        "Allan reset clears state");
+}
+
+void TestAllanWithoutStorage() {
+  AllanAccumulator<4> allan;
+  allan.Push(5);
+  Check(!allan.ready() && allan.samples() == 0, "Allan without storage ignores samples");
+}
+
+
+std::vector<float> GaussianVolts(size_t n, float dc, float sigma, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> noise(0.0f, sigma);
+  std::vector<float> out(n);
+  for (auto& v : out) v = dc + noise(rng);
+  return out;
+}
+
+void TestClippedMeanCleanData() {
+  ClippedMean<128> clip;
+  const auto volts = GaussianVolts(100, 1.25f, 20e-6f, 5);
+  for (float v : volts) clip.Push(v);
+  double mean = 0.0;
+  for (float v : volts) mean += v;
+  mean /= static_cast<double>(volts.size());
+  const ClipStats st = clip.Finish();
+  Check(st.accepted + st.rejected == volts.size(), "clipped mean counts every sample");
+  Check(st.rejected <= 1, "clipped mean keeps clean Gaussian data");
+  Check(std::fabs(st.mean - mean) < 3e-6, "clipped mean of clean data matches the plain mean");
+  Check(NearRel(st.stddev, 20e-6, 0.2), "clipped mean reports the sample deviation");
+  Check(st.quality == ClipQuality::kGood, "clean data is good quality");
+}
+
+void TestClippedMeanRejectsGlitches() {
+  ClippedMean<128> clip;
+  auto volts = GaussianVolts(100, -0.5f, 10e-6f, 6);
+  volts[17] = 2.5f;   // full-scale frame
+  volts[60] = 0.0f;   // zeroed frame
+  volts[61] = -0.49f;
+  for (float v : volts) clip.Push(v);
+  const ClipStats st = clip.Finish();
+  Check(st.rejected >= 3, "clipped mean rejects glitch frames");
+  Check(std::fabs(st.mean - (-0.5)) < 5e-6, "glitches do not bias the clipped mean");
+  Check(st.quality == ClipQuality::kGood, "three glitches in 100 keep good quality");
+}
+
+void TestClippedMeanCompaction() {
+  ClippedMean<16> clip;
+  const auto volts = GaussianVolts(1000, 0.8f, 50e-6f, 7);
+  for (float v : volts) clip.Push(v);
+  double mean = 0.0;
+  for (float v : volts) mean += v;
+  mean /= static_cast<double>(volts.size());
+  const ClipStats st = clip.Finish();
+  Check(st.rejected == 0 && st.accepted == volts.size(), "compacted clip keeps every clean sample");
+  Check(std::fabs(st.mean - mean) < 5e-6, "compaction preserves the mean");
+  Check(NearRel(st.stddev, 50e-6, 0.5), "compaction keeps the per-sample deviation scale");
+}
+
+void TestClippedMeanQuantized() {
+  // 1-Wire readings sitting on two adjacent LSBs must not be clipped.
+  ClippedMean<32> clip;
+  for (int i = 0; i < 30; ++i) clip.Push(i % 10 == 0 ? 21.0625f : 21.0f);
+  const ClipStats st = clip.Finish(0.0625f);
+  Check(st.rejected == 0, "resolution floor keeps one-LSB steps");
+  Check(std::fabs(st.mean - 21.00625) < 1e-4, "quantized mean");
+}
+
+void TestClippedMeanFewSamples() {
+  ClippedMean<8> clip;
+  ClipStats st = clip.Finish();
+  Check(st.quality == ClipQuality::kEmpty && st.accepted == 0, "empty window reports kEmpty");
+  clip.Push(3.0f);
+  clip.Push(5.0f);
+  st = clip.Finish();
+  Check(st.accepted == 2 && st.rejected == 0, "two samples are not clipped");
+  Check(std::fabs(st.mean - 4.0) < 1e-6, "two-sample mean");
+  Check(st.quality == ClipQuality::kPoor, "two samples are too few to judge");
+  clip.Reset();
+  Check(clip.samples() == 0 && clip.Finish().quality == ClipQuality::kEmpty, "reset clears window");
+}
+
+
+void TestSettleWindowExponential() {
+  // 1 mV step decaying with tau = 0.3 s, sampled at 7 Hz with 5 uV of noise.
+  constexpr float kRate = 7.0f, kTau = 0.3f, kStep = 1e-3f;
+  std::mt19937 rng(8);
+  std::normal_distribution<float> noise(0.0f, 5e-6f);
+  SettleWindow<8> win(0.2f);
+  float settled_at = -1.0f;
+  for (int i = 0; i < 40 && settled_at < 0.0f; ++i) {
+    const float t = static_cast<float>(i) / kRate;
+    win.Push(t, 0.7f + kStep * std::exp(-t / kTau) + noise(rng));
+    if (win.Settled(20e-6f, 20e-6f)) settled_at = t;
+  }
+  Check(settled_at > 0.0f, "decaying step eventually settles");
+  // Residual step at the decision time must be below the noise-sized thresholds.
+  Check(kStep * std::exp(-settled_at / kTau) < 30e-6f, "settle waits for the transient to decay");
+}
+
+void TestSettleWindowNoiseAndRamp() {
+  std::mt19937 rng(9);
+  std::normal_distribution<float> noise(0.0f, 5e-6f);
+  SettleWindow<8> flat(0.2f);
+  SettleWindow<8> ramp(0.2f);
+  bool flat_settled = false, ramp_settled = false;
+  for (int i = 0; i < 20; ++i) {
+    const float t = 0.15f * static_cast<float>(i);
+    flat.Push(t, -1.2f + noise(rng));
+    ramp.Push(t, -1.2f + 200e-6f * t + noise(rng));
+    if (i == 2) Check(!flat.Settled(20e-6f, 20e-6f), "settle needs a full window");
+    flat_settled |= flat.Settled(20e-6f, 20e-6f);
+    ramp_settled |= ramp.Settled(20e-6f, 20e-6f);
+  }
+  Check(flat_settled, "flat noisy signal settles");
+  Check(!ramp_settled, "a 200 uV/s drift never settles");
+  float slope = 0.0f, res = 0.0f;
+  Check(ramp.Fit(&slope, &res) && NearRel(slope, 200e-6, 0.3), "settle fit recovers the drift");
+}
+
+void TestSettleWindowFastOsr() {
+  // OSR 64: ~3.5 kHz with ~23 uV of noise per conversion, above the 20 uV threshold. The
+  // time-sized window averages it down, and the same transient is still waited out.
+  constexpr float kRate = 3500.0f, kTau = 0.3f, kStep = 1e-3f;
+  std::mt19937 rng(10);
+  std::normal_distribution<float> noise(0.0f, 23e-6f);
+  SettleWindow<8> flat(0.2f);
+  SettleWindow<8> step(0.2f);
+  float flat_at = -1.0f, step_at = -1.0f;
+  for (int i = 0; i < 7000; ++i) {
+    const float t = static_cast<float>(i) / kRate;
+    flat.Push(t, 0.4f + noise(rng));
+    step.Push(t, 0.4f + kStep * std::exp(-t / kTau) + noise(rng));
+    if (flat_at < 0.0f && flat.Settled(20e-6f, 20e-6f)) flat_at = t;
+    if (step_at < 0.0f && step.Settled(20e-6f, 20e-6f)) step_at = t;
+  }
+  Check(flat_at > 0.0f && flat_at < 0.3f, "noisy fast-OSR signal settles after about one span");
+  Check(step_at > 0.0f && kStep * std::exp(-step_at / kTau) < 30e-6f,
+        "fast-OSR settle waits for the transient to decay");
+}
+
+void TestIntegerStatsMatchesDouble() {
+  // Several blocks, a large offset and a drift across block boundaries.
+  auto codes = WhiteCodes(3 * IntegerStats::kBlock + 123, 8'000'000, 40.0, 10);
+  for (size_t i = 0; i < codes.size(); ++i) codes[i] += static_cast<int32_t>(i / 7);
+  IntegerStats fixed;
+  RunningStats reference;
+  for (int32_t c : codes) {
+    fixed.Push(c);
+    reference.Push(c);
+  }
+  Check(fixed.count() == reference.count(), "integer stats count");
+  Check(std::fabs(fixed.mean() - reference.mean()) < 1e-6, "integer stats mean matches double Welford");
+  Check(NearRel(fixed.variance(), reference.variance(), 1e-9), "integer stats variance matches double Welford");
+  Check(fixed.min() == reference.min() && fixed.max() == reference.max(), "integer stats extrema");
+  IntegerStats one;
+  one.Push(-5);
+  Check(one.count() == 1 && one.mean() == -5.0 && one.variance() == 0.0, "integer stats single sample");
+  fixed.Reset();
+  Check(fixed.count() == 0 && fixed.mean() == 0.0, "integer stats reset");
+}
+
+void TestCompensatedSumPrecision() {
+  // One hour of readings at 100 Hz: a plain float sum rounds every term to the sum's ulp.
+  const auto volts = GaussianVolts(360'000, 0.7312345f, 20e-6f, 11);
+  double reference = 0.0;
+  float naive = 0.0f;
+  CompensatedSum compensated;
+  for (float v : volts) {
+    reference += v;
+    naive += v;
+    compensated.Add(v);
+  }
+  const double n = static_cast<double>(volts.size());
+  const double err_naive = std::fabs(naive / n - reference / n);
+  const double err_comp = std::fabs(compensated.value() / n - reference / n);
+  Check(err_comp < 0.3e-6, "compensated float mean is within 0.3 uV of the double mean");
+  Check(err_naive > 100e-6, "a plain float sum drifts by over 100 uV");
+}
+
+void TestClippedMeanLongWindowPrecision() {
+  ClippedMean<128> clip;
+  const auto volts = GaussianVolts(200'000, -2.1f, 30e-6f, 12);
+  double reference = 0.0;
+  for (float v : volts) {
+    clip.Push(v);
+    reference += v;
+  }
+  reference /= static_cast<double>(volts.size());
+  const ClipStats st = clip.Finish();
+  Check(st.rejected == 0 && st.accepted == volts.size(), "long clipped window keeps every clean sample");
+  Check(std::fabs(st.mean - reference) < 0.5e-6, "long clipped window stays within 0.5 uV of double");
+}
+
+template <typename Fn>
+void Bench(const char* name, size_t n, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  const double sink = fn();
+  const auto stop = std::chrono::steady_clock::now();
+  const double ns =
+      std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(n);
+  std::cout << "  " << name << ": " << ns << " ns/sample (sink " << sink << ")\n";
+}
+
+// On the host double is native, so this bounds the integer/float paths against the double
+// ones; on the ESP32-S3 every double op in the latter is additionally a library call.
+void BenchmarkAccumulators() {
+  constexpr size_t kSamples = 4'000'000;
+  const auto codes = WhiteCodes(kSamples, 6'000'000, 300.0, 13);
+  std::vector<float> volts(codes.size());
+  for (size_t i = 0; i < codes.size(); ++i) volts[i] = static_cast<float>(codes[i]) * 1e-7f;
+  std::cout << "Accumulator throughput (host, " << kSamples << " samples):\n";
+  Bench("RunningStats (double Welford)", kSamples, [&] {
+    RunningStats st;
+    for (int32_t c : codes) st.Push(c);
+    return st.variance();
+  });
+  Bench("IntegerStats", kSamples, [&] {
+    IntegerStats st;
+    for (int32_t c : codes) st.Push(c);
+    return st.variance();
+  });
+  Bench("double sum", kSamples, [&] {
+    double sum = 0.0;
+    for (float v : volts) sum += v;
+    return sum;
+  });
+  Bench("CompensatedSum", kSamples, [&] {
+    CompensatedSum sum;
+    for (float v : volts) sum.Add(v);
+    return static_cast<double>(sum.value());
+  });
+  Bench("ClippedMean<128> push+finish", kSamples, [&] {
+    ClippedMean<128> clip;
+    for (float v : volts) clip.Push(v);
+    return static_cast<double>(clip.Finish().mean);
+  });
+}
+
+}  // namespace
+
+int main() {
+  TestWelfordMatchesTwoPass();
+  TestAllanMatchesBruteForce();
+  TestAllanWhiteNoiseSlope();
+  TestAllanWithoutStorage();
+  TestClippedMeanCleanData();
+  TestClippedMeanRejectsGlitches();
+  TestClippedMeanCompaction();
+  TestClippedMeanQuantized();
+  TestClippedMeanFewSamples();
+  TestSettleWindowExponential();
+  TestSettleWindowNoiseAndRamp();
+  TestSettleWindowFastOsr();
+  TestIntegerStatsMatchesDouble();
+  TestCompensatedSumPrecision();
+  TestClippedMeanLongWindowPrecision();
+
+  if (failures != 0) {
+    std::cerr << failures << " test(s) failed\n";
+    return 1;
+  }
+  BenchmarkAccumulators();
+  std::cout << "OK: all ADC statistics tests passed\n";
+  return 0;
+}
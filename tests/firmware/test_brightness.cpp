@@ -0,0 +1,153 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "brightness.h"
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "FAIL: " << message << "\n";
+    failures++;
+  }
+}
+
+bool Near(float a, float b, float tol) { return std::fabs(a - b) <= tol; }
+
+using Cal = BrightnessCalibration<3>;
+using Table = BrightnessTable<3>;
+
+Cal MakeCal(uint64_t created_ms, float t_adc, float slope, float intercept) {
+  Cal cal;
+  cal.created_ms = created_ms;
+  cal.t_adc.fill(t_adc);
+  cal.slope.fill(slope);
+  cal.intercept.fill(intercept);
+  return cal;
+}
+
+void TestLinearKernel() {
+  Table table;
+  Check(std::isnan(table.Brightness(0, 1.0f, 30.0f)), "no calibration gives NAN");
+  Check(table.Insert(MakeCal(1000, 30.0f, 250.0f, -20.0f)), "usable calibration is stored");
+  Check(Near(table.Brightness(0, 1.2f, 30.0f), 280.0f, 1e-3f), "T_b = slope * U + intercept");
+  Check(std::isnan(table.Brightness(0, NAN, 30.0f)), "a failed channel stays NAN");
+}
+
+void TestTemperatureMatching() {
+  // Same rules as services/brightness.py: closest t_adc wins, the newer entry on ties, the
+  // newest usable one without a radiometer temperature.
+  Table table;
+  table.Insert(MakeCal(1000, 20.0f, 100.0f, 0.0f));
+  table.Insert(MakeCal(2000, 40.0f, 200.0f, 0.0f));
+  table.Insert(MakeCal(3000, 25.0f, 300.0f, 0.0f));
+  Check(table.Select(0, 39.0f) == 1, "closest radiometer temperature is selected");
+  Check(table.Select(0, 21.0f) == 0, "closest radiometer temperature, older entry");
+  Check(table.Select(0, NAN) == 2, "unknown temperature falls back to the newest");
+
+  table.Insert(MakeCal(4000, 20.0f, 400.0f, 0.0f));
+  Check(table.Select(0, 20.0f) == 3, "a tie goes to the newer calibration");
+
+  Cal partial = MakeCal(5000, 39.5f, 500.0f, 0.0f);
+  partial.slope[1] = NAN;
+  partial.t_adc[2] = NAN;
+  table.Insert(partial);
+  Check(table.Select(0, 39.0f) == 4, "channel 1 uses the partial calibration");
+  Check(table.Select(1, 39.0f) == 1, "channel 2 skips missing coefficients");
+  Check(table.Select(2, 39.0f) == 1, "channel 3 skips an unknown t_adc when matching");
+  Check(table.Select(2, NAN) == 4, "an unknown t_adc still counts as the newest fallback");
+}
+
+void TestInsertOrder() {
+  Table table;
+  Check(!table.Insert(Cal{}), "a calibration without coefficients is rejected");
+  table.Insert(MakeCal(3000, 30.0f, 3.0f, 0.0f));
+  table.Insert(MakeCal(1000, 10.0f, 1.0f, 0.0f));
+  table.Insert(MakeCal(2000, 20.0f, 2.0f, 0.0f));
+  Check(table.size() == 3 && table.at(0).created_ms == 1000 && table.at(2).created_ms == 3000,
+        "entries are kept oldest first");
+  table.Insert(MakeCal(2000, 20.0f, 7.0f, 0.0f));
+  Check(table.size() == 3 && table.at(1).slope[0] == 7.0f, "equal created_ms replaces the entry");
+
+  for (uint64_t t = 4000; t < 4000 + kBrightnessMaxCalibrations; ++t) table.Insert(MakeCal(t, 0.0f, 1.0f, 0.0f));
+  Check(table.size() == kBrightnessMaxCalibrations && table.at(0).created_ms == 4000,
+        "a full table drops its oldest entries");
+  table.Insert(MakeCal(500, 0.0f, 1.0f, 0.0f));
+  Check(table.at(0).created_ms == 4000, "a full table ignores a calibration older than all entries");
+}
+
+// Same value, or both unknown. Compared bitwise so a lossy float format shows up.
+bool SameValue(float a, float b) {
+  if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+  return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+bool SameCalibration(const Cal& a, const Cal& b) {
+  if (a.created_ms != b.created_ms) return false;
+  for (int ch = 0; ch < 3; ++ch) {
+    if (!SameValue(a.t_adc[ch], b.t_adc[ch]) || !SameValue(a.slope[ch], b.slope[ch]) ||
+        !SameValue(a.intercept[ch], b.intercept[ch])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TestConfigLineRoundTrip() {
+  // BuildConfigText writes each table entry with FormatBrightnessCalibrationLine and
+  // ParseConfigText reads it back with ParseBrightnessCalibrationLine.
+  Table table;
+  Cal full = MakeCal(1700000000123ULL, 31.25f, 251.123457f, -20.0000019f);
+  full.intercept[2] = 1.17549435e-38f;
+  table.Insert(full);
+  Cal partial = MakeCal(1700000000456ULL, 30.0f, 250.0f, -20.0f);
+  partial.slope[1] = NAN;      // channel 2 has no calibration
+  partial.t_adc[2] = NAN;      // channel 3 was calibrated without a radiometer temperature
+  partial.intercept[0] = -NAN;
+  partial.slope[0] = NAN;
+  table.Insert(partial);
+
+  Table loaded;
+  for (int i = 0; i < table.size(); ++i) {
+    const std::string line = FormatBrightnessCalibrationLine(table.at(i));
+    Cal cal;
+    Check(ParseBrightnessCalibrationLine(line, &cal), "formatted line parses: " + line);
+    Check(SameCalibration(cal, table.at(i)), "line round-trips exactly: " + line);
+    loaded.Insert(cal);
+  }
+  Check(loaded.size() == table.size(), "every entry survives the round trip");
+  Check(loaded.Select(0, 30.0f) == 0 && loaded.Select(1, 30.0f) == 0 && loaded.Select(2, NAN) == 1,
+        "reloaded table selects as before");
+
+  Cal cal;
+  Check(ParseBrightnessCalibrationLine("5, , 1, 2, nan, 3, 4, 30, 5, 6\r", &cal) && std::isnan(cal.t_adc[0]) &&
+            std::isnan(cal.t_adc[1]) && cal.slope[1] == 3.0f && cal.intercept[2] == 6.0f,
+        "empty and nan fields read as unknown");
+  Check(!ParseBrightnessCalibrationLine("5, 30, 1, 2, 30, 3, 4, 30, 5", &cal), "missing field is rejected");
+  Check(!ParseBrightnessCalibrationLine("5, 30, 1, 2, 30, 3, 4, 30, 5, 6, 7", &cal), "extra field is rejected");
+  Check(!ParseBrightnessCalibrationLine("5, 30, 1x, 2, 30, 3, 4, 30, 5, 6", &cal), "garbage field is rejected");
+  Check(!ParseBrightnessCalibrationLine(", 30, 1, 2, 30, 3, 4, 30, 5, 6", &cal), "missing created_ms is rejected");
+  Check(!ParseBrightnessCalibrationLine("5, 30, nan, 2, 30, , 4, 30, nan, nan", &cal),
+        "no usable channel is rejected");
+}
+
+}  // namespace
+
+int main() {
+  TestLinearKernel();
+  TestTemperatureMatching();
+  TestInsertOrder();
+  TestConfigLineRoundTrip();
+
+  if (failures != 0) {
+    std::cerr << failures << " test(s) failed\n";
+    return 1;
+  }
+  std::cout << "OK: all brightness tests passed\n";
+  return 0;
+}